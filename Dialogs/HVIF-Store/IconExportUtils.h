@@ -22,8 +22,6 @@ private:
 	static BString	_GenerateRDef(const uint8* data, size_t size, int32 id, const char* name);
 	static BString	_GenerateCPP(const uint8* data, size_t size, const char* name);
 	static BString	_SanitizeName(const char* name);
-	static BString	_EncodeBase64(const BString& input);
-	static void		_AppendHexByte(BString& result, uint8 byte, bool uppercase);
 };
 
 #endif
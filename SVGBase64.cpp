@@ -0,0 +1,299 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <string.h>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+#include "SVGBase64.h"
+
+namespace {
+
+const char kBase64Alphabet[]
+	= "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Both output characters for every 12-bit half of a 3-byte group.
+struct PairTable {
+	char pairs[4096][2];
+
+	PairTable()
+	{
+		for (int i = 0; i < 4096; i++) {
+			pairs[i][0] = kBase64Alphabet[i >> 6];
+			pairs[i][1] = kBase64Alphabet[i & 0x3f];
+		}
+	}
+};
+
+const PairTable kPairTable;
+
+inline char*
+EncodeGroup(const uint8* in, char* out)
+{
+	uint32 group = ((uint32)in[0] << 16) | ((uint32)in[1] << 8) | in[2];
+	const char* high = kPairTable.pairs[group >> 12];
+	const char* low = kPairTable.pairs[group & 0xfff];
+	out[0] = high[0];
+	out[1] = high[1];
+	out[2] = low[0];
+	out[3] = low[1];
+	return out + 4;
+}
+
+inline char*
+EncodeTail(const uint8* in, size_t count, char* out)
+{
+	uint32 group = (uint32)in[0] << 16;
+	if (count > 1)
+		group |= (uint32)in[1] << 8;
+
+	out[0] = kBase64Alphabet[group >> 18];
+	out[1] = kBase64Alphabet[(group >> 12) & 0x3f];
+	out[2] = count > 1 ? kBase64Alphabet[(group >> 6) & 0x3f] : '=';
+	out[3] = '=';
+	return out + 4;
+}
+
+#if defined(__SSSE3__)
+
+// Twelve input bytes become sixteen 6-bit values, one per byte, which are
+// then mapped onto the alphabet by adding a per-range offset.
+inline __m128i
+ReshuffleBlock(__m128i in)
+{
+	in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+		4, 5, 3, 4, 1, 2, 0, 1));
+
+	const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+	const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+	const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+	const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+
+	return _mm_or_si128(t1, t3);
+}
+
+inline __m128i
+TranslateBlock(__m128i in)
+{
+	const __m128i offsets = _mm_setr_epi8('A', 'a' - 26, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '+' - 62, '/' - 63, 0, 0);
+
+	__m128i indices = _mm_subs_epu8(in, _mm_set1_epi8(51));
+	__m128i upper = _mm_cmpgt_epi8(in, _mm_set1_epi8(25));
+	indices = _mm_sub_epi8(indices, upper);
+
+	return _mm_add_epi8(in, _mm_shuffle_epi8(offsets, indices));
+}
+
+// Encodes 12-byte blocks while a full 16-byte load stays inside the input.
+// Returns the number of input bytes consumed, always a multiple of three.
+size_t
+EncodeBlocks(const uint8* in, size_t size, char* out)
+{
+	size_t done = 0;
+	while (size - done >= 16) {
+		__m128i block = _mm_loadu_si128((const __m128i*)(in + done));
+		block = TranslateBlock(ReshuffleBlock(block));
+		_mm_storeu_si128((__m128i*)out, block);
+		out += 16;
+		done += 12;
+	}
+	return done;
+}
+
+#else
+
+inline size_t
+EncodeBlocks(const uint8*, size_t, char*)
+{
+	return 0;
+}
+
+#endif
+
+} // namespace
+
+
+size_t
+SVGBase64::EncodedLength(size_t size)
+{
+	return (size + 2) / 3 * 4;
+}
+
+size_t
+SVGBase64::Encode(const void* data, size_t size, char* output)
+{
+	if (data == NULL || size == 0 || output == NULL)
+		return 0;
+
+	const uint8* in = (const uint8*)data;
+	char* out = output;
+
+	size_t done = EncodeBlocks(in, size, out);
+	out += done / 3 * 4;
+
+	for (; size - done >= 3; done += 3)
+		out = EncodeGroup(in + done, out);
+
+	if (done < size)
+		out = EncodeTail(in + done, size - done, out);
+
+	return out - output;
+}
+
+BString
+SVGBase64::Encode(const void* data, size_t size)
+{
+	BString result;
+	if (data == NULL || size == 0)
+		return result;
+
+	size_t length = EncodedLength(size);
+	char* buffer = result.LockBuffer(length + 1);
+	if (buffer == NULL)
+		return result;
+
+	Encode(data, size, buffer);
+	buffer[length] = '\0';
+	result.UnlockBuffer(length);
+
+	return result;
+}
+
+BString
+SVGBase64::Encode(const BString& input)
+{
+	return Encode(input.String(), input.Length());
+}
+
+BString
+SVGBase64::DataURI(const char* mimeType, const void* data, size_t size)
+{
+	static const char kPrefix[] = "data:";
+	static const char kSuffix[] = ";base64,";
+
+	BString result;
+	if (mimeType == NULL || data == NULL || size == 0)
+		return result;
+
+	size_t mimeLength = strlen(mimeType);
+	size_t length = sizeof(kPrefix) - 1 + mimeLength + sizeof(kSuffix) - 1
+		+ EncodedLength(size);
+
+	char* buffer = result.LockBuffer(length + 1);
+	if (buffer == NULL)
+		return result;
+
+	char* out = buffer;
+	memcpy(out, kPrefix, sizeof(kPrefix) - 1);
+	out += sizeof(kPrefix) - 1;
+	memcpy(out, mimeType, mimeLength);
+	out += mimeLength;
+	memcpy(out, kSuffix, sizeof(kSuffix) - 1);
+	out += sizeof(kSuffix) - 1;
+	out += Encode(data, size, out);
+
+	*out = '\0';
+	result.UnlockBuffer(length);
+
+	return result;
+}
+
+BString
+SVGBase64::ImgTag(const char* mimeType, const void* data, size_t size)
+{
+	static const char kPrefix[] = "<img src=\"";
+	static const char kSuffix[] = "\" />";
+
+	BString uri = DataURI(mimeType, data, size);
+	if (uri.IsEmpty())
+		return uri;
+
+	size_t uriLength = uri.Length();
+	size_t length = sizeof(kPrefix) - 1 + uriLength + sizeof(kSuffix) - 1;
+
+	BString result;
+	char* buffer = result.LockBuffer(length + 1);
+	if (buffer == NULL)
+		return result;
+
+	char* out = buffer;
+	memcpy(out, kPrefix, sizeof(kPrefix) - 1);
+	out += sizeof(kPrefix) - 1;
+	memcpy(out, uri.String(), uriLength);
+	out += uriLength;
+	memcpy(out, kSuffix, sizeof(kSuffix) - 1);
+	out += sizeof(kSuffix) - 1;
+
+	*out = '\0';
+	result.UnlockBuffer(length);
+
+	return result;
+}
+
+
+SVGBase64Encoder::SVGBase64Encoder()
+	: fPendingCount(0)
+{
+	fPending[0] = fPending[1] = 0;
+}
+
+size_t
+SVGBase64Encoder::MaxOutputLength(size_t size)
+{
+	return (size + 2) / 3 * 4 + 4;
+}
+
+size_t
+SVGBase64Encoder::Update(const void* data, size_t size, char* output)
+{
+	if (data == NULL || size == 0)
+		return 0;
+
+	const uint8* in = (const uint8*)data;
+	char* out = output;
+
+	// complete the group left open by the previous call first
+	if (fPendingCount > 0) {
+		uint8 group[3] = { fPending[0], fPending[1], 0 };
+		int32 count = fPendingCount;
+		while (count < 3 && size > 0) {
+			group[count++] = *in++;
+			size--;
+		}
+
+		if (count < 3) {
+			fPending[0] = group[0];
+			fPending[1] = group[1];
+			fPendingCount = count;
+			return 0;
+		}
+
+		out = EncodeGroup(group, out);
+		fPendingCount = 0;
+	}
+
+	size_t whole = size - size % 3;
+	out += SVGBase64::Encode(in, whole, out);
+
+	for (size_t i = whole; i < size; i++)
+		fPending[fPendingCount++] = in[i];
+
+	return out - output;
+}
+
+size_t
+SVGBase64Encoder::Finish(char* output)
+{
+	if (fPendingCount == 0)
+		return 0;
+
+	char* end = EncodeTail(fPending, fPendingCount, output);
+	fPendingCount = 0;
+	return end - output;
+}
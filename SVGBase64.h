@@ -0,0 +1,47 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_BASE64_H
+#define SVG_BASE64_H
+
+#include <String.h>
+#include <SupportDefs.h>
+
+// Standard padded Base64 (RFC 4648). Input is encoded three bytes at a time
+// through a 12-bit pair table, or sixteen bytes at a time with SSSE3 when the
+// compiler targets it. Output always goes into memory the caller sized with
+// EncodedLength(), so a whole encode is a single allocation at most.
+class SVGBase64 {
+public:
+	static size_t EncodedLength(size_t size);
+
+	// Writes exactly EncodedLength(size) characters, without terminator.
+	static size_t Encode(const void* data, size_t size, char* output);
+	static BString Encode(const void* data, size_t size);
+	static BString Encode(const BString& input);
+
+	// "data:<mime>;base64,<data>" and the same wrapped in an <img> tag.
+	static BString DataURI(const char* mimeType, const void* data, size_t size);
+	static BString ImgTag(const char* mimeType, const void* data, size_t size);
+};
+
+// Incremental encoder for input that arrives in pieces. Up to two bytes
+// are carried over between Update() calls; Finish() adds the padding.
+class SVGBase64Encoder {
+public:
+	SVGBase64Encoder();
+
+	// output must hold MaxOutputLength(size) characters.
+	static size_t MaxOutputLength(size_t size);
+
+	size_t Update(const void* data, size_t size, char* output);
+	size_t Finish(char* output);
+
+private:
+	uint8	fPending[2];
+	int32	fPendingCount;
+};
+
+#endif
@@ -1,111 +1,561 @@
 /*
- * Copyright 2025, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Copyright 2025-2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
  * Distributed under the terms of the MIT License.
  */
 
+#include <DataIO.h>
+
+#include <string.h>
+
 #include "SVGCodeGenerator.h"
 
-BString
-SVGCodeGenerator::GenerateRDef(const unsigned char* data, size_t size)
+namespace {
+
+const char kRDefPrefix[] = "resource(";
+const char kRDefSuffix[] = ") #'VICN' array {\n";
+const char kCPPPrefix[] = "const unsigned char ";
+const char kCPPArrayOpen[] = "[] = {\n";
+const char kCPPArrayClose[] = "\n};\n";
+const char kCPPSizePrefix[] = "\nconst size_t ";
+const char kCPPSizeSuffix[] = "Size";
+const char kDefaultCPPName[] = "kIconData";
+
+const size_t kRDefBytesPerLine = 32;
+const size_t kCPPBytesPerLine = 16;
+
+// Two output characters for every byte value, so encoding a byte is a
+// single two-character copy instead of two nibble lookups.
+struct HexTable {
+	char upper[256][2];
+	char lower[256][2];
+
+	HexTable()
+	{
+		static const char kUpper[] = "0123456789ABCDEF";
+		static const char kLower[] = "0123456789abcdef";
+		for (int i = 0; i < 256; i++) {
+			upper[i][0] = kUpper[i >> 4];
+			upper[i][1] = kUpper[i & 0xf];
+			lower[i][0] = kLower[i >> 4];
+			lower[i][1] = kLower[i & 0xf];
+		}
+	}
+};
+
+const HexTable kHexTable;
+
+inline char*
+EncodeHex(char* out, unsigned char byte, const char (*table)[2])
 {
-	BString result;
-	
-	if (!_IsValidData(data, size)) {
-		return result;
+	out[0] = table[byte][0];
+	out[1] = table[byte][1];
+	return out + 2;
+}
+
+size_t
+FormatDecimal(char* buffer, int64 value)
+{
+	char digits[24];
+	size_t count = 0;
+	uint64 magnitude = value < 0 ? (uint64)(-(value + 1)) + 1 : (uint64)value;
+
+	do {
+		digits[count++] = '0' + (char)(magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude > 0);
+
+	size_t length = 0;
+	if (value < 0)
+		buffer[length++] = '-';
+	while (count > 0)
+		buffer[length++] = digits[--count];
+
+	return length;
+}
+
+size_t
+DecimalLength(int64 value)
+{
+	char buffer[24];
+	return FormatDecimal(buffer, value);
+}
+
+inline size_t
+LineCount(size_t size, size_t bytesPerLine)
+{
+	return (size + bytesPerLine - 1) / bytesPerLine;
+}
+
+// Collects output in a fixed stack buffer and hands it to the sink in
+// kChunkSize pieces. After the first sink error everything is dropped.
+class ChunkWriter {
+public:
+	ChunkWriter(SVGCodeSink& sink)
+		: fSink(sink),
+		fUsed(0),
+		fStatus(B_OK)
+	{
 	}
 
-	result << "resource(1) #'VICN' array {\n";
+	// Returns room for at least length bytes, flushing first if needed.
+	// length must not exceed kChunkSize.
+	char* Reserve(size_t length)
+	{
+		if (fUsed + length > sizeof(fBuffer))
+			_Flush();
+		return fBuffer + fUsed;
+	}
 
-	for (size_t i = 0; i < size; i += 32) {
-		result << "\t$\"";
+	void Commit(char* end)
+	{
+		fUsed = end - fBuffer;
+	}
 
-		for (size_t j = i; j < i + 32 && j < size; j++) {
-			_AppendHexByte(result, data[j], true);
-		}
+	void Append(const char* text, size_t length)
+	{
+		while (length > 0 && fStatus == B_OK) {
+			if (fUsed == sizeof(fBuffer))
+				_Flush();
 
-		result << "\"";
-		if (i + 32 < size) {
-			result << ",";
+			size_t count = sizeof(fBuffer) - fUsed;
+			if (count > length)
+				count = length;
+
+			memcpy(fBuffer + fUsed, text, count);
+			fUsed += count;
+			text += count;
+			length -= count;
 		}
-		result << "\n";
 	}
 
-	result << "};";
-	return result;
+	void Append(const char* text)
+	{
+		Append(text, strlen(text));
+	}
+
+	void AppendDecimal(int64 value)
+	{
+		char buffer[24];
+		Append(buffer, FormatDecimal(buffer, value));
+	}
+
+	status_t Finish()
+	{
+		_Flush();
+		return fStatus;
+	}
+
+private:
+	void _Flush()
+	{
+		if (fUsed > 0 && fStatus == B_OK)
+			fStatus = fSink.Write(fBuffer, fUsed);
+		fUsed = 0;
+	}
+
+private:
+	SVGCodeSink&	fSink;
+	char			fBuffer[SVGCodeGenerator::kChunkSize];
+	size_t			fUsed;
+	status_t		fStatus;
+};
+
+bool
+HasName(const char* name)
+{
+	return name != NULL && name[0] != '\0';
 }
 
+// Runs one of the Write*() functions into a BString of the precomputed
+// length, so the result is allocated exactly once.
+template<typename Writer>
 BString
-SVGCodeGenerator::GenerateCPP(const unsigned char* data, size_t size)
+GenerateString(size_t length, Writer writer)
 {
 	BString result;
-	
-	if (!_IsValidData(data, size)) {
+
+	char* buffer = result.LockBuffer(length + 1);
+	if (buffer == NULL)
 		return result;
+
+	SVGMemorySink sink(buffer, length);
+	if (writer(sink) != B_OK || sink.Length() != length) {
+		result.UnlockBuffer(0);
+		return BString();
 	}
 
-	result << "const unsigned char kIconData[] = {\n";
+	buffer[length] = '\0';
+	result.UnlockBuffer(length);
+	return result;
+}
 
-	for (size_t i = 0; i < size; i++) {
-		if (i % 16 == 0)
-			result << "\t";
-
-		result << "0x";
-		_AppendHexByte(result, data[i], false);
-
-		if (i < size - 1) {
-			result << ",";
-			if ((i + 1) % 16 == 0)
-				result << "\n";
-			else
-				result << " ";
-		}
-	}
+} // namespace
 
-	result << "\n};\n";
-	result << "\nconst size_t kIconDataSize = ";
-	
-	BString sizeStr;
-	sizeStr.SetToFormat("%u", (unsigned int)size);
-	result << sizeStr << ";";
 
-	return result;
+SVGMemorySink::SVGMemorySink(char* buffer, size_t capacity)
+	: fBuffer(buffer),
+	fCapacity(capacity),
+	fLength(0)
+{
+}
+
+status_t
+SVGMemorySink::Write(const char* buffer, size_t length)
+{
+	if (length > fCapacity - fLength)
+		return B_BUFFER_OVERFLOW;
+
+	memcpy(fBuffer + fLength, buffer, length);
+	fLength += length;
+	return B_OK;
+}
+
+SVGDataIOSink::SVGDataIOSink(BDataIO* target)
+	: fTarget(target)
+{
+}
+
+status_t
+SVGDataIOSink::Write(const char* buffer, size_t length)
+{
+	if (fTarget == NULL)
+		return B_NO_INIT;
+
+	ssize_t written = fTarget->Write(buffer, length);
+	if (written < 0)
+		return (status_t)written;
+
+	return (size_t)written == length ? B_OK : B_IO_ERROR;
+}
+
+BString
+SVGCodeGenerator::GenerateRDef(const unsigned char* data, size_t size, int32 id,
+	const char* name)
+{
+	if (!_IsValidData(data, size))
+		return BString();
+
+	struct Writer {
+		const unsigned char* data; size_t size; int32 id; const char* name;
+		status_t operator()(SVGCodeSink& sink) const
+			{ return WriteRDef(sink, data, size, id, name); }
+	} writer = { data, size, id, name };
+
+	return GenerateString(RDefLength(size, id, name), writer);
+}
+
+BString
+SVGCodeGenerator::GenerateCPP(const unsigned char* data, size_t size, const char* name,
+	const char* sizeName)
+{
+	if (!_IsValidData(data, size))
+		return BString();
+
+	struct Writer {
+		const unsigned char* data; size_t size; const char* name; const char* sizeName;
+		status_t operator()(SVGCodeSink& sink) const
+			{ return WriteCPP(sink, data, size, name, sizeName); }
+	} writer = { data, size, name, sizeName };
+
+	return GenerateString(CPPLength(size, name, sizeName), writer);
 }
 
 BString
 SVGCodeGenerator::GenerateHex(const unsigned char* data, size_t size, int32 bytesPerLine)
 {
-	BString result;
-	
-	if (!_IsValidData(data, size) || bytesPerLine <= 0) {
-		return result;
+	if (!_IsValidData(data, size) || bytesPerLine <= 0)
+		return BString();
+
+	struct Writer {
+		const unsigned char* data; size_t size; int32 bytesPerLine;
+		status_t operator()(SVGCodeSink& sink) const
+			{ return WriteHex(sink, data, size, bytesPerLine); }
+	} writer = { data, size, bytesPerLine };
+
+	return GenerateString(HexLength(size, bytesPerLine), writer);
+}
+
+status_t
+SVGCodeGenerator::WriteRDef(SVGCodeSink& sink, const unsigned char* data, size_t size,
+	int32 id, const char* name)
+{
+	if (!_IsValidData(data, size))
+		return B_BAD_VALUE;
+
+	ChunkWriter writer(sink);
+
+	writer.Append(kRDefPrefix, sizeof(kRDefPrefix) - 1);
+	writer.AppendDecimal(id);
+	if (name != NULL) {
+		writer.Append(", \"", 3);
+		writer.Append(name);
+		writer.Append("\"", 1);
+	}
+	writer.Append(kRDefSuffix, sizeof(kRDefSuffix) - 1);
+
+	for (size_t i = 0; i < size; i += kRDefBytesPerLine) {
+		size_t end = i + kRDefBytesPerLine < size ? i + kRDefBytesPerLine : size;
+
+		char* out = writer.Reserve(kRDefBytesPerLine * 2 + 6);
+		*out++ = '\t';
+		*out++ = '$';
+		*out++ = '"';
+		for (size_t j = i; j < end; j++)
+			out = EncodeHex(out, data[j], kHexTable.upper);
+		*out++ = '"';
+		if (end < size)
+			*out++ = ',';
+		*out++ = '\n';
+		writer.Commit(out);
 	}
 
+	writer.Append("};", 2);
+	return writer.Finish();
+}
+
+status_t
+SVGCodeGenerator::WriteCPP(SVGCodeSink& sink, const unsigned char* data, size_t size,
+	const char* name, const char* sizeName)
+{
+	if (!_IsValidData(data, size))
+		return B_BAD_VALUE;
+
+	if (!HasName(name))
+		name = kDefaultCPPName;
+
+	ChunkWriter writer(sink);
+
+	writer.Append(kCPPPrefix, sizeof(kCPPPrefix) - 1);
+	writer.Append(name);
+	writer.Append(kCPPArrayOpen, sizeof(kCPPArrayOpen) - 1);
+
+	for (size_t i = 0; i < size; i += kCPPBytesPerLine) {
+		size_t end = i + kCPPBytesPerLine < size ? i + kCPPBytesPerLine : size;
+
+		char* out = writer.Reserve(kCPPBytesPerLine * 6 + 1);
+		*out++ = '\t';
+		for (size_t j = i; j < end; j++) {
+			*out++ = '0';
+			*out++ = 'x';
+			out = EncodeHex(out, data[j], kHexTable.lower);
+			if (j < size - 1) {
+				*out++ = ',';
+				*out++ = j + 1 == end ? '\n' : ' ';
+			}
+		}
+		writer.Commit(out);
+	}
+
+	writer.Append(kCPPArrayClose, sizeof(kCPPArrayClose) - 1);
+	writer.Append(kCPPSizePrefix, sizeof(kCPPSizePrefix) - 1);
+	if (HasName(sizeName)) {
+		writer.Append(sizeName);
+	} else {
+		writer.Append(name);
+		writer.Append(kCPPSizeSuffix, sizeof(kCPPSizeSuffix) - 1);
+	}
+	writer.Append(" = ", 3);
+	writer.AppendDecimal(size);
+	writer.Append(";", 1);
+
+	return writer.Finish();
+}
+
+status_t
+SVGCodeGenerator::WriteHex(SVGCodeSink& sink, const unsigned char* data, size_t size,
+	int32 bytesPerLine)
+{
+	if (!_IsValidData(data, size) || bytesPerLine <= 0)
+		return B_BAD_VALUE;
+
+	ChunkWriter writer(sink);
+
 	for (size_t i = 0; i < size; i++) {
-		if (i % bytesPerLine == 0 && i > 0)
-			result << "\n";
-		
-		if (i % bytesPerLine == 0)
-			result << "\t";
-		
-		_AppendHexByte(result, data[i], true);
-		
+		char* out = writer.Reserve(5);
+
+		if (i % bytesPerLine == 0) {
+			if (i > 0)
+				*out++ = '\n';
+			*out++ = '\t';
+		}
+
+		out = EncodeHex(out, data[i], kHexTable.upper);
+
 		if (i < size - 1 && (i + 1) % bytesPerLine != 0)
-			result << " ";
+			*out++ = ' ';
+
+		writer.Commit(out);
 	}
 
-	return result;
+	return writer.Finish();
+}
+
+size_t
+SVGCodeGenerator::RDefLength(size_t size, int32 id, const char* name)
+{
+	if (size == 0)
+		return 0;
+
+	size_t lines = LineCount(size, kRDefBytesPerLine);
+
+	size_t length = sizeof(kRDefPrefix) - 1 + DecimalLength(id) + sizeof(kRDefSuffix) - 1;
+	if (name != NULL)
+		length += strlen(name) + 4;
+
+	// \t$" ... "\n per line, a comma after all but the last, closing "};"
+	length += lines * 5 + (lines - 1) + size * 2;
+	length += 2;
+
+	return length;
+}
+
+size_t
+SVGCodeGenerator::CPPLength(size_t size, const char* name, const char* sizeName)
+{
+	if (size == 0)
+		return 0;
+
+	if (!HasName(name))
+		name = kDefaultCPPName;
+
+	size_t lines = LineCount(size, kCPPBytesPerLine);
+
+	size_t length = sizeof(kCPPPrefix) - 1 + strlen(name) + sizeof(kCPPArrayOpen) - 1;
+
+	// "0xhh" per byte, a tab per line, ", " or ",\n" between bytes
+	length += size * 4 + lines + (size - 1) * 2;
+
+	length += sizeof(kCPPArrayClose) - 1 + sizeof(kCPPSizePrefix) - 1;
+	if (HasName(sizeName))
+		length += strlen(sizeName);
+	else
+		length += strlen(name) + sizeof(kCPPSizeSuffix) - 1;
+	length += 3 + DecimalLength(size) + 1;
+
+	return length;
+}
+
+size_t
+SVGCodeGenerator::HexLength(size_t size, int32 bytesPerLine)
+{
+	if (size == 0 || bytesPerLine <= 0)
+		return 0;
+
+	size_t lines = LineCount(size, bytesPerLine);
+
+	// two digits per byte, a tab per line, newlines between lines and
+	// spaces between the bytes of one line
+	return size * 2 + lines + (lines - 1) + (size - lines);
 }
 
 void
-SVGCodeGenerator::_AppendHexByte(BString& result, unsigned char byte, bool uppercase)
+SVGCodeGenerator::GetRDefHighlights(size_t size, int32 id, const char* name,
+	std::vector<HighlightRange>& ranges)
 {
-	BString hex;
-	if (uppercase) {
-		hex.SetToFormat("%02X", byte);
-	} else {
-		hex.SetToFormat("%02x", byte);
+	ranges.clear();
+	if (size == 0)
+		return;
+
+	size_t lines = LineCount(size, kRDefBytesPerLine);
+	ranges.reserve(lines * 2 + 12);
+
+	// resource(<id>[, "<name>"]) #'VICN' array {
+	int32 pos = 0;
+	ranges.push_back(HighlightRange(pos, pos + 8, HIGHLIGHT_KEYWORD));
+	pos += 8;
+	ranges.push_back(HighlightRange(pos, pos + 1, HIGHLIGHT_OPERATOR));
+	pos += 1;
+
+	int32 idLength = DecimalLength(id);
+	int32 digitsStart = id < 0 ? pos + 1 : pos;
+	ranges.push_back(HighlightRange(digitsStart, pos + idLength, HIGHLIGHT_NUMBER));
+	pos += idLength;
+
+	if (name != NULL) {
+		int32 nameLength = strlen(name);
+		ranges.push_back(HighlightRange(pos, pos + 1, HIGHLIGHT_OPERATOR));
+		pos += 2;
+		ranges.push_back(HighlightRange(pos, pos + nameLength + 2, HIGHLIGHT_STRING));
+		pos += nameLength + 2;
+	}
+
+	ranges.push_back(HighlightRange(pos, pos + 1, HIGHLIGHT_OPERATOR));
+	pos += 2;
+	ranges.push_back(HighlightRange(pos, pos + 7, HIGHLIGHT_PREPROCESSOR));
+	pos += 8;
+	ranges.push_back(HighlightRange(pos, pos + 5, HIGHLIGHT_KEYWORD));
+	pos += 6;
+	ranges.push_back(HighlightRange(pos, pos + 1, HIGHLIGHT_OPERATOR));
+	pos += 2;
+
+	// \t$"<hex>", per line
+	for (size_t i = 0; i < size; i += kRDefBytesPerLine) {
+		size_t count = size - i < kRDefBytesPerLine ? size - i : kRDefBytesPerLine;
+		int32 stringLength = count * 2 + 3;
+
+		pos += 1;
+		ranges.push_back(HighlightRange(pos, pos + stringLength, HIGHLIGHT_STRING));
+		pos += stringLength;
+
+		if (i + count < size) {
+			ranges.push_back(HighlightRange(pos, pos + 1, HIGHLIGHT_OPERATOR));
+			pos += 1;
+		}
+		pos += 1;
 	}
-	result << hex;
+
+	ranges.push_back(HighlightRange(pos, pos + 1, HIGHLIGHT_OPERATOR));
+	ranges.push_back(HighlightRange(pos + 1, pos + 2, HIGHLIGHT_OPERATOR));
+}
+
+void
+SVGCodeGenerator::GetCPPHighlights(size_t size, const char* name, const char* sizeName,
+	std::vector<HighlightRange>& ranges)
+{
+	ranges.clear();
+	if (size == 0)
+		return;
+
+	if (!HasName(name))
+		name = kDefaultCPPName;
+
+	int32 sizeNameLength = HasName(sizeName) ? strlen(sizeName)
+		: strlen(name) + sizeof(kCPPSizeSuffix) - 1;
+
+	ranges.reserve(16);
+
+	// const unsigned char <name>[] = {
+	int32 pos = 0;
+	ranges.push_back(HighlightRange(pos, pos + 5, HIGHLIGHT_KEYWORD));
+	pos += 6;
+	ranges.push_back(HighlightRange(pos, pos + 8, HIGHLIGHT_KEYWORD));
+	pos += 9;
+	ranges.push_back(HighlightRange(pos, pos + 4, HIGHLIGHT_KEYWORD));
+	pos += 5 + strlen(name);
+	ranges.push_back(HighlightRange(pos, pos + 1, HIGHLIGHT_OPERATOR));
+	ranges.push_back(HighlightRange(pos + 1, pos + 2, HIGHLIGHT_OPERATOR));
+	pos += 3;
+	ranges.push_back(HighlightRange(pos, pos + 1, HIGHLIGHT_OPERATOR));
+	pos += 2;
+
+	// the whole array body, up to the closing brace, counts as one number
+	size_t lines = LineCount(size, kCPPBytesPerLine);
+	int32 bodyLength = 1 + size * 4 + lines + (size - 1) * 2 + 1;
+	ranges.push_back(HighlightRange(pos, pos + 1, HIGHLIGHT_OPERATOR));
+	ranges.push_back(HighlightRange(pos + 1, pos + 1 + bodyLength, HIGHLIGHT_NUMBER));
+	pos += 1 + bodyLength;
+	ranges.push_back(HighlightRange(pos, pos + 1, HIGHLIGHT_OPERATOR));
+	ranges.push_back(HighlightRange(pos + 1, pos + 2, HIGHLIGHT_OPERATOR));
+	pos += 4;
+
+	// const size_t <name>Size = <size>;
+	ranges.push_back(HighlightRange(pos, pos + 5, HIGHLIGHT_KEYWORD));
+	pos += 6;
+	ranges.push_back(HighlightRange(pos, pos + 6, HIGHLIGHT_KEYWORD));
+	pos += 7 + sizeNameLength + 1;
+	ranges.push_back(HighlightRange(pos, pos + 1, HIGHLIGHT_OPERATOR));
+	pos += 2 + DecimalLength(size);
+	ranges.push_back(HighlightRange(pos, pos + 1, HIGHLIGHT_OPERATOR));
 }
 
 bool
@@ -1,5 +1,5 @@
 /*
- * Copyright 2025, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Copyright 2025-2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
  * Distributed under the terms of the MIT License.
  */
 
@@ -9,15 +9,84 @@
 #include <String.h>
 #include <SupportDefs.h>
 
+#include <vector>
+
+#include "SVGHighlightRange.h"
+
+class BDataIO;
+
+// Destination of generated code. The generator hands over output in chunks
+// of up to kChunkSize bytes and stops at the first error returned.
+class SVGCodeSink {
+public:
+	virtual ~SVGCodeSink() {}
+	virtual status_t Write(const char* buffer, size_t length) = 0;
+};
+
+// Writes into caller-provided memory, failing instead of overflowing it.
+class SVGMemorySink : public SVGCodeSink {
+public:
+	SVGMemorySink(char* buffer, size_t capacity);
+
+	virtual status_t Write(const char* buffer, size_t length);
+	size_t Length() const { return fLength; }
+
+private:
+	char*	fBuffer;
+	size_t	fCapacity;
+	size_t	fLength;
+};
+
+// Streams straight into a file or any other BDataIO.
+class SVGDataIOSink : public SVGCodeSink {
+public:
+	SVGDataIOSink(BDataIO* target);
+
+	virtual status_t Write(const char* buffer, size_t length);
+
+private:
+	BDataIO*	fTarget;
+};
+
+// Formats binary icon data as RDef, C++ or plain hex text. Every format has
+// an exact size function, so the BString variants allocate once and the
+// sink variants never allocate at all. A NULL name gives "resource(id)" for
+// RDef, an empty one still "resource(id, \"\")". C++ falls back to
+// "kIconData" for both; the size constant is called <name>Size unless
+// sizeName is given.
 class SVGCodeGenerator {
 public:
-	static BString GenerateRDef(const unsigned char* data, size_t size);
-	static BString GenerateCPP(const unsigned char* data, size_t size);
-	static BString GenerateHex(const unsigned char* data, size_t size, 
+	static BString GenerateRDef(const unsigned char* data, size_t size,
+					int32 id = 1, const char* name = NULL);
+	static BString GenerateCPP(const unsigned char* data, size_t size,
+					const char* name = NULL, const char* sizeName = NULL);
+	static BString GenerateHex(const unsigned char* data, size_t size,
 					int32 bytesPerLine = 16);
 
+	static status_t WriteRDef(SVGCodeSink& sink, const unsigned char* data, size_t size,
+					int32 id = 1, const char* name = NULL);
+	static status_t WriteCPP(SVGCodeSink& sink, const unsigned char* data, size_t size,
+					const char* name = NULL, const char* sizeName = NULL);
+	static status_t WriteHex(SVGCodeSink& sink, const unsigned char* data, size_t size,
+					int32 bytesPerLine = 16);
+
+	static size_t RDefLength(size_t size, int32 id = 1, const char* name = NULL);
+	static size_t CPPLength(size_t size, const char* name = NULL,
+					const char* sizeName = NULL);
+	static size_t HexLength(size_t size, int32 bytesPerLine = 16);
+
+	// Syntax highlighting for the output of GenerateRDef()/GenerateCPP()
+	// called with the same arguments, identical to what the editor's RDef
+	// and C++ highlighters find in it. Only the layout is needed, so the
+	// ranges are built without scanning the text.
+	static void GetRDefHighlights(size_t size, int32 id, const char* name,
+					std::vector<HighlightRange>& ranges);
+	static void GetCPPHighlights(size_t size, const char* name, const char* sizeName,
+					std::vector<HighlightRange>& ranges);
+
+	static const size_t kChunkSize = 4096;
+
 private:
-	static void _AppendHexByte(BString& result, unsigned char byte, bool uppercase = false);
 	static bool _IsValidData(const unsigned char* data, size_t size);
 };
 
@@ -60,6 +60,10 @@ const uint32 MSG_EDIT_WORD_WRAP = 'wrap';
 const uint32 MSG_SEARCH_NEXT = 'srnx';
 const uint32 MSG_SEARCH_PREV = 'srpv';
 const uint32 MSG_SEARCH_ENTER = 'sren';
+const uint32 MSG_SEARCH_MODIFIED = 'srmd';
+const uint32 MSG_SEARCH_MATCH_CASE = 'srmc';
+const uint32 MSG_SEARCH_WHOLE_WORD = 'srww';
+const uint32 MSG_SEARCH_REGEX = 'srrx';
 const uint32 MSG_DROP_HVIF = '_RRC';
 const uint32 MSG_TOGGLE_STAT = 'tgst';
 const uint32 MSG_DELETE_FILE = 'delf';
@@ -87,9 +91,10 @@ const uint32 MSG_WINDOW_ACTIVATED = 'AWIN';
 const uint32 MSG_WINDOW_CLOSED = 'CWIN';
 const uint32 MSG_EASTER_EGG = 'EEGG';
 const uint32 MSG_SVG_STATUS_UPDATE = 'svsu';
+const uint32 MSG_TILE_RENDERED = 'tlrd';
+const uint32 MSG_RENDER_IDLE = 'rnid';
 
 // State monitoring messages
-const uint32 MSG_STATE_UPDATE = 'stup';
 const uint32 MSG_TEXT_MODIFIED = 'txmd';
 const uint32 MSG_SELECTION_CHANGED = 'slch';
 
@@ -115,6 +120,19 @@ const uint32 MSG_VECTORIZATION_PROGRESS = 'vcpg';
 const uint32 MSG_VECTORIZATION_START = 'vcst';
 const uint32 MSG_VECTORIZATION_RESET_PROGRESS = 'vcrp';
 
+// HVIF conversion
+const uint32 MSG_HVIF_CONVERSION_REQUEST = 'hvrq';
+const uint32 MSG_HVIF_CONVERSION_RESULT = 'hvrs';
+
+// Background search and replace
+const uint32 MSG_TEXT_SEARCH_REQUEST = 'tsrq';
+const uint32 MSG_TEXT_SEARCH_RESULT = 'tsrs';
+const uint32 MSG_TEXT_REPLACE_RESULT = 'trrs';
+const uint32 MSG_SEARCH_PROGRESS = 'srpg';
+const uint32 MSG_REPLACE_ALL = 'rpal';
+const uint32 MSG_REPLACE_ALL_DO = 'rpdo';
+const uint32 MSG_REPLACE_DONE = 'rpdn';
+
 // UI Constants
 const int32 TOOLBAR_ICON_SIZE = 24;
 const float SOURCE_VIEW_WEIGHT = 0.3f;
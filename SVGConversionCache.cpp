@@ -0,0 +1,245 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <Autolock.h>
+#include <SHA256.h>
+
+#include <string.h>
+
+#include "SVGConversionCache.h"
+
+static const size_t kEntryOverhead = sizeof(ConversionKey) * 2 + 64;
+static const uint64 kHashPrime = 0x9e3779b97f4a7c15ULL;
+
+static inline uint64
+_Mix(uint64 value)
+{
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdULL;
+	value ^= value >> 33;
+	value *= 0xc4ceb9fe1a85ec53ULL;
+	value ^= value >> 33;
+	return value;
+}
+
+bool
+SourceDigest::operator==(const SourceDigest& other) const
+{
+	return memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+}
+
+bool
+ConversionKey::operator==(const ConversionKey& other) const
+{
+	return sourceDigest == other.sourceDigest
+		&& sourceLength == other.sourceLength
+		&& output == other.output
+		&& format == other.format
+		&& svgWidth == other.svgWidth
+		&& svgHeight == other.svgHeight
+		&& pngWidth == other.pngWidth
+		&& pngHeight == other.pngHeight
+		&& pngScaleBits == other.pngScaleBits
+		&& preserveNames == other.preserveNames;
+}
+
+size_t
+ConversionKeyHash::operator()(const ConversionKey& key) const
+{
+	uint64 hash;
+	memcpy(&hash, key.sourceDigest.bytes, sizeof(hash));
+	hash = _Mix(hash ^ key.sourceLength);
+	hash = _Mix(hash ^ (((uint64)key.output << 32) | key.format));
+	hash = _Mix(hash ^ (((uint64)(uint32)key.svgWidth << 32) | (uint32)key.svgHeight));
+	hash = _Mix(hash ^ (((uint64)(uint32)key.pngWidth << 32) | (uint32)key.pngHeight));
+	hash = _Mix(hash ^ (((uint64)key.pngScaleBits << 1) | (key.preserveNames ? 1 : 0)));
+	return (size_t)hash;
+}
+
+SVGConversionCache::SVGConversionCache(size_t budget)
+	: fLock("svg_conversion_cache"),
+	fBudget(budget),
+	fSize(0),
+	fHits(0),
+	fMisses(0),
+	fEvictions(0)
+{
+}
+
+SVGConversionCache::~SVGConversionCache()
+{
+}
+
+SVGConversionCache*
+SVGConversionCache::Default()
+{
+	static SVGConversionCache sDefaultCache;
+	return &sDefaultCache;
+}
+
+uint64
+SVGConversionCache::HashSource(const char* data, size_t length)
+{
+	// Word-at-a-time multiply/rotate hash; good enough to tell sources apart
+	// together with the length, and several times faster than byte-wise FNV.
+	uint64 hash = kHashPrime ^ length;
+	const char* end = data + (length & ~(size_t)7);
+
+	for (; data < end; data += 8) {
+		uint64 word;
+		memcpy(&word, data, sizeof(word));
+		hash ^= word * kHashPrime;
+		hash = (hash << 31) | (hash >> 33);
+		hash *= 0xff51afd7ed558ccdULL;
+	}
+
+	uint64 tail = 0;
+	memcpy(&tail, data, length & 7);
+	hash ^= tail * kHashPrime;
+
+	return _Mix(hash);
+}
+
+SourceDigest
+SVGConversionCache::DigestSource(const char* data, size_t length)
+{
+	SHA256 sha;
+	sha.Update(data, length);
+
+	SourceDigest digest;
+	memcpy(digest.bytes, sha.Digest(), sizeof(digest.bytes));
+	return digest;
+}
+
+ConversionKey
+SVGConversionCache::MakeKey(const SourceDigest& sourceDigest, size_t sourceLength,
+	conversion_output output, haiku::IconFormat format,
+	const haiku::ConvertOptions& options)
+{
+	ConversionKey key;
+	memset(&key, 0, sizeof(key));
+
+	key.sourceDigest = sourceDigest;
+	key.sourceLength = sourceLength;
+	key.output = output;
+	key.format = (uint32)format;
+	key.svgWidth = options.svgWidth;
+	key.svgHeight = options.svgHeight;
+	key.pngWidth = options.pngWidth;
+	key.pngHeight = options.pngHeight;
+	key.preserveNames = options.preserveNames;
+
+	float scale = options.pngScale;
+	memcpy(&key.pngScaleBits, &scale, sizeof(key.pngScaleBits));
+
+	return key;
+}
+
+bool
+SVGConversionCache::Lookup(const ConversionKey& key, std::vector<uint8_t>& data)
+{
+	BAutolock lock(fLock);
+
+	const Entry* entry = _Find(key);
+	if (entry == NULL)
+		return false;
+
+	data = entry->data;
+	return true;
+}
+
+bool
+SVGConversionCache::Lookup(const ConversionKey& key, BString& text)
+{
+	BAutolock lock(fLock);
+
+	const Entry* entry = _Find(key);
+	if (entry == NULL)
+		return false;
+
+	text.SetTo((const char*)entry->data.data(), entry->data.size());
+	return true;
+}
+
+void
+SVGConversionCache::Store(const ConversionKey& key, const std::vector<uint8_t>& data)
+{
+	BAutolock lock(fLock);
+	_Store(key, data.data(), data.size());
+}
+
+void
+SVGConversionCache::Store(const ConversionKey& key, const BString& text)
+{
+	BAutolock lock(fLock);
+	_Store(key, (const uint8_t*)text.String(), text.Length());
+}
+
+void
+SVGConversionCache::SetBudget(size_t budget)
+{
+	BAutolock lock(fLock);
+	fBudget = budget;
+	_EvictLocked();
+}
+
+void
+SVGConversionCache::Clear()
+{
+	BAutolock lock(fLock);
+	fEntries.clear();
+	fOrder.clear();
+	fSize = 0;
+}
+
+const SVGConversionCache::Entry*
+SVGConversionCache::_Find(const ConversionKey& key)
+{
+	EntryMap::iterator it = fEntries.find(key);
+	if (it == fEntries.end()) {
+		fMisses++;
+		return NULL;
+	}
+
+	fHits++;
+	fOrder.splice(fOrder.begin(), fOrder, it->second.position);
+	return &it->second;
+}
+
+void
+SVGConversionCache::_Store(const ConversionKey& key, const uint8_t* data, size_t size)
+{
+	if (size + kEntryOverhead > fBudget)
+		return;
+
+	EntryMap::iterator it = fEntries.find(key);
+	if (it != fEntries.end()) {
+		fSize -= it->second.data.size() + kEntryOverhead;
+		it->second.data.assign(data, data + size);
+		fOrder.splice(fOrder.begin(), fOrder, it->second.position);
+	} else {
+		fOrder.push_front(key);
+		Entry& entry = fEntries[key];
+		entry.data.assign(data, data + size);
+		entry.position = fOrder.begin();
+	}
+
+	fSize += size + kEntryOverhead;
+	_EvictLocked();
+}
+
+void
+SVGConversionCache::_EvictLocked()
+{
+	while (fSize > fBudget && !fOrder.empty()) {
+		EntryMap::iterator it = fEntries.find(fOrder.back());
+		if (it != fEntries.end()) {
+			fSize -= it->second.data.size() + kEntryOverhead;
+			fEntries.erase(it);
+		}
+		fOrder.pop_back();
+		fEvictions++;
+	}
+}
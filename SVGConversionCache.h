@@ -0,0 +1,107 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_CONVERSION_CACHE_H
+#define SVG_CONVERSION_CACHE_H
+
+#include <Locker.h>
+#include <String.h>
+#include <SupportDefs.h>
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "IconConverter.h"
+
+enum conversion_output {
+	OUTPUT_ICON = 0,
+	OUTPUT_RDEF,
+	OUTPUT_CPP
+};
+
+// SHA-256 of an SVG source. Unlike a fast hash it is safe to trust on its
+// own, so a cache hit never has to compare the source itself.
+struct SourceDigest {
+	uint8				bytes[32];
+
+	bool operator==(const SourceDigest& other) const;
+};
+
+struct ConversionKey {
+	SourceDigest		sourceDigest;
+	uint64				sourceLength;
+	uint32				output;
+	uint32				format;
+	int32				svgWidth;
+	int32				svgHeight;
+	int32				pngWidth;
+	int32				pngHeight;
+	uint32				pngScaleBits;
+	bool				preserveNames;
+
+	bool operator==(const ConversionKey& other) const;
+};
+
+struct ConversionKeyHash {
+	size_t operator()(const ConversionKey& key) const;
+};
+
+// In-memory cache of conversion results, keyed by a digest of the SVG
+// source and the conversion options. Entries are evicted in LRU order once the
+// total size exceeds the budget. All methods are thread safe.
+class SVGConversionCache {
+public:
+	SVGConversionCache(size_t budget = 16 * 1024 * 1024);
+	~SVGConversionCache();
+
+	static SVGConversionCache* Default();
+
+	// Fast, but only fit to notice changes, not to identify a source.
+	static uint64 HashSource(const char* data, size_t length);
+	static SourceDigest DigestSource(const char* data, size_t length);
+	static ConversionKey MakeKey(const SourceDigest& sourceDigest, size_t sourceLength,
+						conversion_output output,
+						haiku::IconFormat format = haiku::FORMAT_HVIF,
+						const haiku::ConvertOptions& options = haiku::ConvertOptions());
+
+	bool Lookup(const ConversionKey& key, std::vector<uint8_t>& data);
+	bool Lookup(const ConversionKey& key, BString& text);
+	void Store(const ConversionKey& key, const std::vector<uint8_t>& data);
+	void Store(const ConversionKey& key, const BString& text);
+
+	void SetBudget(size_t budget);
+	size_t Budget() const { return fBudget; }
+	void Clear();
+
+	size_t Size() const { return fSize; }
+	uint64 Hits() const { return fHits; }
+	uint64 Misses() const { return fMisses; }
+	uint64 Evictions() const { return fEvictions; }
+
+private:
+	struct Entry {
+		std::vector<uint8_t>				data;
+		std::list<ConversionKey>::iterator	position;
+	};
+
+	typedef std::unordered_map<ConversionKey, Entry, ConversionKeyHash> EntryMap;
+
+	const Entry* _Find(const ConversionKey& key);
+	void _Store(const ConversionKey& key, const uint8_t* data, size_t size);
+	void _EvictLocked();
+
+private:
+	BLocker							fLock;
+	EntryMap						fEntries;
+	std::list<ConversionKey>		fOrder;
+	size_t							fBudget;
+	size_t							fSize;
+	uint64							fHits;
+	uint64							fMisses;
+	uint64							fEvictions;
+};
+
+#endif
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <Message.h>
+#include <MessageQueue.h>
+
+#include <string.h>
+#include <vector>
+
+#include "SVGCodeGenerator.h"
+#include "SVGConversionCache.h"
+#include "SVGConstants.h"
+#include "SVGConversionWorker.h"
+#include "SVGDocument.h"
+
+SVGConversionResult::SVGConversionResult()
+	: generation(0),
+	hvifData(NULL),
+	hvifSize(0)
+{
+}
+
+SVGConversionResult::~SVGConversionResult()
+{
+	delete[] hvifData;
+}
+
+SVGConversionWorker::SVGConversionWorker(BHandler* target)
+	: BLooper("hvif_conversion_worker", B_LOW_PRIORITY),
+	fTarget(target),
+	fGeneration(0),
+	fShutdown(false)
+{
+	Run();
+}
+
+SVGConversionWorker::~SVGConversionWorker()
+{
+	BMessage* request;
+	while ((request = MessageQueue()->NextMessage()) != NULL) {
+		_ReleaseRequest(request);
+		delete request;
+	}
+}
+
+void
+SVGConversionWorker::Shutdown()
+{
+	fShutdown = true;
+	atomic_add(&fGeneration, 1);
+
+	if (Lock())
+		Quit();
+}
+
+int32
+SVGConversionWorker::RequestConversion(SVGDocument* document, bool generateCode)
+{
+	int32 generation = atomic_add(&fGeneration, 1) + 1;
+
+	if (fShutdown || document == NULL)
+		return generation;
+
+	document->AcquireReference();
+
+	BMessage request(MSG_HVIF_CONVERSION_REQUEST);
+	request.AddPointer("document", document);
+	request.AddInt32("generation", generation);
+	request.AddBool("generate_code", generateCode);
+
+	if (PostMessage(&request) != B_OK)
+		document->ReleaseReference();
+
+	return generation;
+}
+
+void
+SVGConversionWorker::CancelConversion()
+{
+	atomic_add(&fGeneration, 1);
+}
+
+bool
+SVGConversionWorker::IsCurrent(int32 generation) const
+{
+	return generation == atomic_get(const_cast<vint32*>(&fGeneration));
+}
+
+void
+SVGConversionWorker::MessageReceived(BMessage* message)
+{
+	switch (message->what) {
+		case MSG_HVIF_CONVERSION_REQUEST:
+		{
+			SVGDocument* document = NULL;
+			int32 generation = message->GetInt32("generation", 0);
+
+			if (message->FindPointer("document", (void**)&document) == B_OK
+				&& document != NULL) {
+				if (!fShutdown && IsCurrent(generation))
+					_Convert(document, generation, message->GetBool("generate_code", true));
+				document->ReleaseReference();
+			}
+			break;
+		}
+
+		default:
+			BLooper::MessageReceived(message);
+			break;
+	}
+}
+
+void
+SVGConversionWorker::_Convert(SVGDocument* document, int32 generation, bool generateCode)
+{
+	SVGConversionResult* result = new SVGConversionResult();
+	result->generation = generation;
+
+	std::vector<uint8_t> hvifData;
+	if (document->GetHVIFData(hvifData)) {
+		if (!IsCurrent(generation)) {
+			delete result;
+			return;
+		}
+
+		result->hvifSize = hvifData.size();
+		result->hvifData = new unsigned char[result->hvifSize];
+		memcpy(result->hvifData, hvifData.data(), result->hvifSize);
+	}
+
+	if (generateCode && result->hvifData != NULL) {
+		SVGConversionCache* cache = SVGConversionCache::Default();
+		const SourceDigest& digest = document->Digest();
+		size_t length = document->Source().Length();
+		size_t hvifSize = result->hvifSize;
+		const unsigned char* hvif = result->hvifData;
+
+		ConversionKey rdefKey = SVGConversionCache::MakeKey(digest, length, OUTPUT_RDEF);
+		if (!cache->Lookup(rdefKey, result->rdef)) {
+			result->rdef = SVGCodeGenerator::GenerateRDef(hvif, hvifSize);
+			cache->Store(rdefKey, result->rdef);
+		}
+
+		ConversionKey cppKey = SVGConversionCache::MakeKey(digest, length, OUTPUT_CPP);
+		if (!cache->Lookup(cppKey, result->cpp)) {
+			result->cpp = SVGCodeGenerator::GenerateCPP(hvif, hvifSize);
+			cache->Store(cppKey, result->cpp);
+		}
+	}
+
+	if (fShutdown || !IsCurrent(generation)) {
+		delete result;
+		return;
+	}
+
+	BMessage reply(MSG_HVIF_CONVERSION_RESULT);
+	reply.AddPointer("result", result);
+	reply.AddInt32("generation", generation);
+
+	if (fTarget.SendMessage(&reply) != B_OK)
+		delete result;
+}
+
+void
+SVGConversionWorker::_ReleaseRequest(BMessage* request)
+{
+	if (request->what != MSG_HVIF_CONVERSION_REQUEST)
+		return;
+
+	SVGDocument* document = NULL;
+	if (request->FindPointer("document", (void**)&document) == B_OK && document != NULL)
+		document->ReleaseReference();
+}
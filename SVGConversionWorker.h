@@ -0,0 +1,56 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_CONVERSION_WORKER_H
+#define SVG_CONVERSION_WORKER_H
+
+#include <Looper.h>
+#include <Messenger.h>
+#include <String.h>
+#include <SupportDefs.h>
+
+class SVGDocument;
+
+// Everything the window needs after a conversion. Ownership of the result is
+// handed over with the MSG_HVIF_CONVERSION_RESULT message ("result" pointer),
+// the receiver must delete it.
+struct SVGConversionResult {
+	SVGConversionResult();
+	~SVGConversionResult();
+
+	int32			generation;
+	unsigned char*	hvifData;
+	size_t			hvifSize;
+	BString			rdef;
+	BString			cpp;
+};
+
+// Converts documents to HVIF and, if asked to, generates the RDef/C++
+// listings off the window thread. Every request gets a new generation
+// number; only the latest one is converted, older requests are dropped as
+// soon as they are noticed.
+class SVGConversionWorker : public BLooper {
+public:
+	SVGConversionWorker(BHandler* target);
+	virtual ~SVGConversionWorker();
+
+	virtual void MessageReceived(BMessage* message);
+
+	int32 RequestConversion(SVGDocument* document, bool generateCode = true);
+	void CancelConversion();
+	bool IsCurrent(int32 generation) const;
+	void Shutdown();
+
+private:
+	void _Convert(SVGDocument* document, int32 generation, bool generateCode);
+	void _ReleaseRequest(BMessage* request);
+
+private:
+	BMessenger		fTarget;
+	vint32			fGeneration;
+	volatile bool	fShutdown;
+};
+
+#endif
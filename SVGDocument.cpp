@@ -0,0 +1,150 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <Autolock.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "nanosvg.h"
+
+#include "SVGConversionCache.h"
+#include "SVGDocument.h"
+#include "SVGIconConverter.h"
+
+SVGDocument::SVGDocument(const BString& source, const char* units, float dpi)
+	: fSource(source),
+	fSourceDigest(SVGConversionCache::DigestSource(source.String(), source.Length())),
+	fImage(NULL),
+	fIndexLock("svg_document_index"),
+	fShapeIndex(NULL),
+	fIconLock("svg_document_icon"),
+	fIconParsed(false),
+	fIconValid(false),
+	fHVIFGenerated(false)
+{
+	if (fSource.IsEmpty())
+		return;
+
+	char* sourceCopy = strdup(fSource.String());
+	if (sourceCopy == NULL)
+		return;
+
+	fImage = nsvgParse(sourceCopy, units, dpi);
+	free(sourceCopy);
+}
+
+SVGDocument::~SVGDocument()
+{
+	delete fShapeIndex;
+	if (fImage)
+		nsvgDelete(fImage);
+}
+
+status_t
+SVGDocument::InitCheck() const
+{
+	return fImage != NULL ? B_OK : B_ERROR;
+}
+
+// Only the views look shapes up, so batch conversion never builds an index.
+const SVGShapeIndex*
+SVGDocument::ShapeIndex() const
+{
+	BAutolock lock(fIndexLock);
+
+	if (fShapeIndex == NULL && fImage != NULL)
+		fShapeIndex = new SVGShapeIndex(fImage);
+
+	return fShapeIndex;
+}
+
+float
+SVGDocument::Width() const
+{
+	return fImage ? fImage->width : 0.0f;
+}
+
+float
+SVGDocument::Height() const
+{
+	return fImage ? fImage->height : 0.0f;
+}
+
+bool
+SVGDocument::GetIcon(haiku::Icon& icon)
+{
+	BAutolock lock(fIconLock);
+
+	if (!_ParseIconLocked())
+		return false;
+
+	icon = fIcon;
+	return true;
+}
+
+bool
+SVGDocument::GetHVIFData(std::vector<uint8_t>& data)
+{
+	BAutolock lock(fIconLock);
+
+	if (!fHVIFGenerated) {
+		fHVIFGenerated = true;
+
+		SVGConversionCache* cache = SVGConversionCache::Default();
+		ConversionKey key = SVGConversionCache::MakeKey(fSourceDigest, fSource.Length(),
+			OUTPUT_ICON, haiku::FORMAT_HVIF);
+
+		if (!cache->Lookup(key, fHVIFData) && _ParseIconLocked()) {
+			IconConversionContext context;
+			if (context.SaveToBuffer(fIcon, fHVIFData, haiku::FORMAT_HVIF))
+				cache->Store(key, fHVIFData);
+			else
+				fHVIFData.clear();
+		}
+	}
+
+	data = fHVIFData;
+	return !data.empty();
+}
+
+bool
+SVGDocument::ConvertTo(haiku::IconFormat format, const haiku::ConvertOptions& options,
+	std::vector<uint8_t>& data)
+{
+	SVGConversionCache* cache = SVGConversionCache::Default();
+	ConversionKey key = SVGConversionCache::MakeKey(fSourceDigest, fSource.Length(),
+		OUTPUT_ICON, format, options);
+
+	if (cache->Lookup(key, data))
+		return !data.empty();
+
+	BAutolock lock(fIconLock);
+
+	if (!_ParseIconLocked())
+		return false;
+
+	IconConversionContext context;
+	if (!context.SaveToBuffer(fIcon, data, format, options) || data.empty())
+		return false;
+
+	cache->Store(key, data);
+	return true;
+}
+
+bool
+SVGDocument::_ParseIconLocked()
+{
+	if (fIconParsed)
+		return fIconValid;
+
+	fIconParsed = true;
+
+	IconConversionContext context;
+	fIconValid = context.LoadFromBuffer(fSource.String(), fSource.Length(),
+		haiku::FORMAT_SVG, fIcon);
+
+	return fIconValid;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_DOCUMENT_H
+#define SVG_DOCUMENT_H
+
+#include <Locker.h>
+#include <Referenceable.h>
+#include <String.h>
+#include <SupportDefs.h>
+
+#include <vector>
+
+#include "IconConverter.h"
+#include "SVGConversionCache.h"
+#include "SVGShapeIndex.h"
+
+struct NSVGimage;
+
+// Result of parsing one SVG source. The nanosvg image is built once in the
+// constructor and shared by the preview, statistics and structure views;
+// the shape index, the hvif-tools icon and its HVIF encoding are created
+// on first use, and conversion results are looked up in
+// SVGConversionCache before that. The parsed data is never modified after
+// construction, and the lazy parts are built under a lock, so a document
+// can be handed to other threads as long as they hold a reference.
+class SVGDocument : public BReferenceable {
+public:
+	SVGDocument(const BString& source, const char* units = "px", float dpi = 96.0f);
+	virtual ~SVGDocument();
+
+	status_t InitCheck() const;
+
+	const BString& Source() const { return fSource; }
+	const SourceDigest& Digest() const { return fSourceDigest; }
+	NSVGimage* Image() const { return fImage; }
+	const SVGShapeIndex* ShapeIndex() const;
+	float Width() const;
+	float Height() const;
+
+	bool GetIcon(haiku::Icon& icon);
+	bool GetHVIFData(std::vector<uint8_t>& data);
+	bool ConvertTo(haiku::IconFormat format, const haiku::ConvertOptions& options,
+				std::vector<uint8_t>& data);
+
+private:
+	bool _ParseIconLocked();
+
+private:
+	BString				fSource;
+	SourceDigest		fSourceDigest;
+	NSVGimage*			fImage;
+
+	mutable BLocker		fIndexLock;
+	mutable SVGShapeIndex* fShapeIndex;
+
+	BLocker				fIconLock;
+	haiku::Icon			fIcon;
+	bool				fIconParsed;
+	bool				fIconValid;
+
+	std::vector<uint8_t> fHVIFData;
+	bool				fHVIFGenerated;
+};
+
+#endif
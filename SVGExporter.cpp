@@ -0,0 +1,230 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <File.h>
+#include <NodeInfo.h>
+
+#include <vector>
+
+#include "SVGCodeGenerator.h"
+#include "SVGConstants.h"
+#include "SVGDocument.h"
+#include "SVGExporter.h"
+
+#define MIME_IOM_SIGNATURE "application/x-vnd.haiku-icon"
+#define MIME_PNG_SIGNATURE "image/png"
+
+status_t
+SVGExporter::ReadSource(const char* filePath, BString& source)
+{
+	BFile file(filePath, B_READ_ONLY);
+	if (file.InitCheck() != B_OK)
+		return file.InitCheck();
+
+	off_t size;
+	if (file.GetSize(&size) != B_OK)
+		return B_ERROR;
+
+	char* buffer = source.LockBuffer(size + 1);
+	if (buffer == NULL)
+		return B_NO_MEMORY;
+
+	ssize_t bytesRead = file.Read(buffer, size);
+	if (bytesRead != size) {
+		source.UnlockBuffer(0);
+		return B_ERROR;
+	}
+
+	buffer[size] = '\0';
+	source.UnlockBuffer(size);
+
+	return B_OK;
+}
+
+status_t
+SVGExporter::SaveData(const char* filePath, const void* data, size_t size, const char* mime)
+{
+	if (!filePath || !data || size == 0)
+		return B_BAD_VALUE;
+
+	BFile file(filePath, B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	status_t initResult = file.InitCheck();
+	if (initResult != B_OK)
+		return initResult;
+
+	ssize_t bytesWritten = file.Write(data, size);
+	if (bytesWritten != (ssize_t)size)
+		return B_ERROR;
+
+	_SetMimeType(file, mime);
+	return B_OK;
+}
+
+status_t
+SVGExporter::ExportHVIF(const char* filePath, const unsigned char* data, size_t size)
+{
+	if (!data || size == 0)
+		return B_BAD_VALUE;
+
+	BString fullPath = filePath;
+	if (!fullPath.EndsWith(".hvif"))
+		fullPath << ".hvif";
+
+	return SaveData(fullPath.String(), data, size, MIME_HVIF_SIGNATURE);
+}
+
+status_t
+SVGExporter::ExportRDef(const char* filePath, const unsigned char* data, size_t size)
+{
+	if (!data || size == 0)
+		return B_BAD_VALUE;
+
+	BString fullPath = _RDefPath(filePath);
+	BFile file(fullPath.String(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	if (file.InitCheck() != B_OK)
+		return file.InitCheck();
+
+	SVGDataIOSink sink(&file);
+	status_t status = SVGCodeGenerator::WriteRDef(sink, data, size);
+	if (status != B_OK)
+		return status;
+
+	_SetMimeType(file, MIME_TXT_SIGNATURE);
+	return B_OK;
+}
+
+status_t
+SVGExporter::ExportRDef(const char* filePath, const BString& content)
+{
+	if (content.IsEmpty())
+		return B_BAD_VALUE;
+
+	return SaveData(_RDefPath(filePath).String(), content.String(), content.Length(),
+		MIME_TXT_SIGNATURE);
+}
+
+status_t
+SVGExporter::ExportCPP(const char* filePath, const unsigned char* data, size_t size)
+{
+	if (!data || size == 0)
+		return B_BAD_VALUE;
+
+	BString fullPath = _CPPPath(filePath);
+	BFile file(fullPath.String(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	if (file.InitCheck() != B_OK)
+		return file.InitCheck();
+
+	SVGDataIOSink sink(&file);
+	status_t status = SVGCodeGenerator::WriteCPP(sink, data, size);
+	if (status != B_OK)
+		return status;
+
+	_SetMimeType(file, MIME_CPP_SIGNATURE);
+	return B_OK;
+}
+
+status_t
+SVGExporter::ExportCPP(const char* filePath, const BString& content)
+{
+	if (content.IsEmpty())
+		return B_BAD_VALUE;
+
+	return SaveData(_CPPPath(filePath).String(), content.String(), content.Length(),
+		MIME_CPP_SIGNATURE);
+}
+
+status_t
+SVGExporter::ExportIOM(const char* filePath, SVGDocument* document)
+{
+	if (document == NULL || document->Source().IsEmpty())
+		return B_BAD_VALUE;
+
+	BString fullPath = filePath;
+	if (!fullPath.EndsWith(".iom"))
+		fullPath << ".iom";
+
+	std::vector<uint8_t> iomData;
+	haiku::ConvertOptions opts;
+	if (!document->ConvertTo(haiku::FORMAT_IOM, opts, iomData))
+		return B_ERROR;
+
+	return SaveData(fullPath.String(), iomData.data(), iomData.size(), MIME_IOM_SIGNATURE);
+}
+
+status_t
+SVGExporter::ExportPNG(const char* filePath, SVGDocument* document, int32 size)
+{
+	if (document == NULL || document->Source().IsEmpty())
+		return B_BAD_VALUE;
+
+	BString fullPath = filePath;
+	if (!fullPath.EndsWith(".png"))
+		fullPath << ".png";
+
+	float svgW = document->Width();
+	float svgH = document->Height();
+
+	if (svgW <= 0 || svgH <= 0)
+		return B_ERROR;
+
+	int32 targetW, targetH;
+	GetRasterSize(svgW, svgH, size, targetW, targetH);
+
+	haiku::ConvertOptions opts;
+	opts.pngWidth = targetW;
+	opts.pngHeight = targetH;
+	opts.pngScale = 1.0f;
+
+	std::vector<uint8_t> pngData;
+	if (!document->ConvertTo(haiku::FORMAT_PNG, opts, pngData))
+		return B_ERROR;
+
+	return SaveData(fullPath.String(), pngData.data(), pngData.size(), MIME_PNG_SIGNATURE);
+}
+
+void
+SVGExporter::GetRasterSize(float width, float height, int32 size,
+	int32& targetWidth, int32& targetHeight)
+{
+	if (size == -1) {
+		targetWidth = (int32)width;
+		targetHeight = (int32)height;
+	} else if (width > height) {
+		targetWidth = size;
+		targetHeight = (int32)((height / width) * size);
+	} else {
+		targetHeight = size;
+		targetWidth = (int32)((width / height) * size);
+	}
+
+	if (targetWidth < 1) targetWidth = 1;
+	if (targetHeight < 1) targetHeight = 1;
+}
+
+BString
+SVGExporter::_RDefPath(const char* filePath)
+{
+	BString fullPath = filePath;
+	if (!fullPath.EndsWith(".rdef"))
+		fullPath << ".rdef";
+	return fullPath;
+}
+
+BString
+SVGExporter::_CPPPath(const char* filePath)
+{
+	BString fullPath = filePath;
+	if (!fullPath.EndsWith(".h") && !fullPath.EndsWith(".hpp") && !fullPath.EndsWith(".cpp"))
+		fullPath << ".h";
+	return fullPath;
+}
+
+void
+SVGExporter::_SetMimeType(BFile& file, const char* mime)
+{
+	BNodeInfo nodeInfo(&file);
+	if (nodeInfo.InitCheck() == B_OK)
+		nodeInfo.SetType(mime);
+}
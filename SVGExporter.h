@@ -0,0 +1,41 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_EXPORTER_H
+#define SVG_EXPORTER_H
+
+#include <String.h>
+#include <SupportDefs.h>
+
+class BFile;
+class SVGDocument;
+
+// File export without any user interface, shared by the export panels in
+// SVGFileManager and the svgear-cli batch converter. Missing extensions are
+// appended to the given path the same way the export panels always did.
+class SVGExporter {
+public:
+	static status_t ReadSource(const char* filePath, BString& source);
+	static status_t SaveData(const char* filePath, const void* data, size_t size,
+					const char* mime);
+
+	static status_t ExportHVIF(const char* filePath, const unsigned char* data, size_t size);
+	static status_t ExportRDef(const char* filePath, const unsigned char* data, size_t size);
+	static status_t ExportRDef(const char* filePath, const BString& content);
+	static status_t ExportCPP(const char* filePath, const unsigned char* data, size_t size);
+	static status_t ExportCPP(const char* filePath, const BString& content);
+	static status_t ExportIOM(const char* filePath, SVGDocument* document);
+	static status_t ExportPNG(const char* filePath, SVGDocument* document, int32 size);
+
+	static void GetRasterSize(float width, float height, int32 size,
+					int32& targetWidth, int32& targetHeight);
+
+private:
+	static BString _RDefPath(const char* filePath);
+	static BString _CPPPath(const char* filePath);
+	static void _SetMimeType(BFile& file, const char* mime);
+};
+
+#endif
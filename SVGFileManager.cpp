@@ -12,14 +12,13 @@
 
 #include "SVGConstants.h"
 #include "SVGFileManager.h"
-#include "SVGView.h"
 #include "SVGHVIFView.h"
 #include "SVGSettings.h"
-#include "SVGCodeGenerator.h"
+#include "SVGExporter.h"
 #include "SVGVectorizationWorker.h"
 #include "SVGVectorizationDialog.h"
 
-#include "IconConverter.h"
+#include "SVGIconConverter.h"
 
 #undef B_TRANSLATION_CONTEXT
 #define B_TRANSLATION_CONTEXT "SVGFileManager"
@@ -42,13 +41,34 @@ SVGFileManager::~SVGFileManager()
 }
 
 bool
-SVGFileManager::LoadFile(const char* filePath, SVGView* svgView, HVIFView* iconView, BString& source)
+SVGFileManager::LoadFile(const char* filePath, HVIFView* iconView, BString& source,
+	BReference<SVGDocument>& document)
 {
 	if (!filePath) {
 		_ShowError(ERROR_FILE_NOT_SPECIFIED);
 		return false;
 	}
 
+	BString loadedSource;
+	if (!_LoadSource(filePath, iconView, loadedSource))
+		return false;
+
+	BReference<SVGDocument> loadedDocument(new SVGDocument(loadedSource), true);
+	if (loadedDocument->InitCheck() != B_OK) {
+		BString error;
+		error.SetToFormat(B_TRANSLATE("Error loading SVG file: %s"), filePath);
+		_ShowError(error.String());
+		return false;
+	}
+
+	source = loadedSource;
+	document = loadedDocument;
+	return true;
+}
+
+bool
+SVGFileManager::_LoadSource(const char* filePath, HVIFView* iconView, BString& source)
+{
 	fLastFileType = FILE_TYPE_UNKNOWN;
 
 	haiku::IconFormat format = haiku::IconConverter::DetectFormatBySignature(filePath);
@@ -64,7 +84,7 @@ SVGFileManager::LoadFile(const char* filePath, SVGView* svgView, HVIFView* iconV
 
 		case haiku::FORMAT_SVG:
 			fLastFileType = FILE_TYPE_SVG;
-			return _LoadSVGFile(filePath, svgView, iconView, source);
+			return _LoadSVGFile(filePath, source);
 
 		case haiku::FORMAT_PNG:
 			fLastFileType = FILE_TYPE_RASTER;
@@ -95,13 +115,14 @@ SVGFileManager::LoadFile(const char* filePath, SVGView* svgView, HVIFView* iconV
 bool
 SVGFileManager::_LoadVectorIconFile(const char* filePath, haiku::IconFormat format,	HVIFView* iconView, BString& source)
 {
-	haiku::Icon icon = haiku::IconConverter::Load(filePath, format);
+	IconConversionContext context;
+	haiku::Icon icon;
 
-	std::string errorMsg = haiku::IconConverter::GetLastError();
-	if (!errorMsg.empty()) {
+	if (!context.Load(filePath, format, icon)) {
 		BString error;
 		const char* formatName = (format == haiku::FORMAT_HVIF) ? "HVIF" : "IOM";
-		error.SetToFormat(B_TRANSLATE("Error loading %s file: %s"), formatName, errorMsg.c_str());
+		error.SetToFormat(B_TRANSLATE("Error loading %s file: %s"), formatName,
+			context.LastError().String());
 		_ShowError(error.String());
 		return false;
 	}
@@ -119,8 +140,7 @@ SVGFileManager::_LoadVectorIconFile(const char* filePath, haiku::IconFormat form
 				}
 			}
 		} else {
-			haiku::ConvertOptions opts;
-			haiku::IconConverter::SaveToBuffer(icon, hvifData, haiku::FORMAT_HVIF, opts);
+			context.SaveToBuffer(icon, hvifData, haiku::FORMAT_HVIF);
 		}
 
 		if (!hvifData.empty()) {
@@ -134,7 +154,7 @@ SVGFileManager::_LoadVectorIconFile(const char* filePath, haiku::IconFormat form
 	opts.preserveNames = false; //TODO: fix hvif-tools naming
 
 	std::vector<uint8_t> svgBuffer;
-	if (!haiku::IconConverter::SaveToBuffer(icon, svgBuffer, haiku::FORMAT_SVG, opts)) {
+	if (!context.SaveToBuffer(icon, svgBuffer, haiku::FORMAT_SVG, opts)) {
 		const char* formatName = (format == haiku::FORMAT_HVIF) ? "HVIF" : "IOM";
 		BString error;
 		error.SetToFormat(B_TRANSLATE("Error converting %s to SVG"), formatName);
@@ -147,36 +167,13 @@ SVGFileManager::_LoadVectorIconFile(const char* filePath, haiku::IconFormat form
 }
 
 bool
-SVGFileManager::_LoadSVGFile(const char* filePath, SVGView* svgView, HVIFView* iconView, BString& source)
+SVGFileManager::_LoadSVGFile(const char* filePath, BString& source)
 {
 	if (LoadSourceFromFile(filePath, source) != B_OK) {
 		_ShowError(ERROR_READING_SVG);
 		return false;
 	}
 
-	if (svgView) {
-		status_t result = svgView->LoadFromFile(filePath);
-		if (result != B_OK) {
-			BString error;
-			error.SetToFormat(B_TRANSLATE("Error loading SVG file: %s"), filePath);
-			_ShowError(error.String());
-			return false;
-		}
-	}
-
-	if (iconView) {
-		std::vector<uint8_t> svgData(source.String(), source.String() + source.Length());
-		haiku::Icon icon = haiku::IconConverter::LoadFromBuffer(svgData, haiku::FORMAT_SVG);
-
-		if (haiku::IconConverter::GetLastError().empty()) {
-			std::vector<uint8_t> hvifData;
-			haiku::ConvertOptions opts;
-			if (haiku::IconConverter::SaveToBuffer(icon, hvifData, haiku::FORMAT_HVIF, opts)) {
-				iconView->SetIcon(hvifData.data(), hvifData.size());
-			}
-		}
-	}
-
 	return true;
 }
 
@@ -206,10 +203,10 @@ SVGFileManager::_LoadFromFileAttributes(const char* filePath, HVIFView* iconView
 		return false;
 	}
 
-	haiku::Icon icon = haiku::IconConverter::LoadFromBuffer(data, haiku::FORMAT_HVIF);
+	IconConversionContext context;
+	haiku::Icon icon;
 
-	std::string errorMsg = haiku::IconConverter::GetLastError();
-	if (!errorMsg.empty()) {
+	if (!context.LoadFromBuffer(data, haiku::FORMAT_HVIF, icon)) {
 		return false;
 	}
 
@@ -223,7 +220,7 @@ SVGFileManager::_LoadFromFileAttributes(const char* filePath, HVIFView* iconView
 	opts.preserveNames = false;
 
 	std::vector<uint8_t> svgBuffer;
-	if (!haiku::IconConverter::SaveToBuffer(icon, svgBuffer, haiku::FORMAT_SVG, opts)) {
+	if (!context.SaveToBuffer(icon, svgBuffer, haiku::FORMAT_SVG, opts)) {
 		return false;
 	}
 
@@ -234,26 +231,7 @@ SVGFileManager::_LoadFromFileAttributes(const char* filePath, HVIFView* iconView
 status_t
 SVGFileManager::LoadSourceFromFile(const char* filePath, BString& source)
 {
-	BFile file(filePath, B_READ_ONLY);
-	if (file.InitCheck() != B_OK)
-		return file.InitCheck();
-
-	off_t size;
-	if (file.GetSize(&size) != B_OK)
-		return B_ERROR;
-
-	char* buffer = new char[size + 1];
-	ssize_t bytesRead = file.Read(buffer, size);
-	if (bytesRead != size) {
-		delete[] buffer;
-		return B_ERROR;
-	}
-
-	buffer[size] = '\0';
-	source.SetTo(buffer);
-	delete[] buffer;
-
-	return B_OK;
+	return SVGExporter::ReadSource(filePath, source);
 }
 
 status_t
@@ -397,129 +375,24 @@ SVGFileManager::ShowExportPNGPanel(BHandler* target, int32 size)
 status_t
 SVGFileManager::ExportHVIF(const char* filePath, const unsigned char* data, size_t size)
 {
-	if (!data || size == 0)
-		return B_BAD_VALUE;
-
-	BString fullPath = filePath;
-	if (!fullPath.EndsWith(".hvif"))
-		fullPath << ".hvif";
-
-	return _SaveBinaryData(fullPath.String(), data, size, MIME_HVIF_SIGNATURE);
+	return SVGExporter::ExportHVIF(filePath, data, size);
 }
 
 status_t
 SVGFileManager::ExportRDef(const char* filePath, const unsigned char* data, size_t size)
 {
-	if (!data || size == 0)
-		return B_BAD_VALUE;
-
-	BString fullPath = filePath;
-	if (!fullPath.EndsWith(".rdef"))
-		fullPath << ".rdef";
-
-	BString rdefContent = SVGCodeGenerator::GenerateRDef(data, size);
-	return SaveFile(fullPath.String(), rdefContent, MIME_TXT_SIGNATURE);
+	return SVGExporter::ExportRDef(filePath, data, size);
 }
 
 status_t
 SVGFileManager::ExportCPP(const char* filePath, const unsigned char* data, size_t size)
 {
-	if (!data || size == 0)
-		return B_BAD_VALUE;
-
-	BString fullPath = filePath;
-	if (!fullPath.EndsWith(".h") && !fullPath.EndsWith(".hpp") && !fullPath.EndsWith(".cpp")) {
-		fullPath << ".h";
-	}
-
-	BString cppContent = SVGCodeGenerator::GenerateCPP(data, size);
-	return SaveFile(fullPath.String(), cppContent, MIME_CPP_SIGNATURE);
-}
-
-status_t
-SVGFileManager::_ExportIOM(const char* filePath, const BString& svgSource)
-{
-	if (svgSource.IsEmpty())
-		return B_BAD_VALUE;
-
-	BString fullPath = filePath;
-	if (!fullPath.EndsWith(".iom"))
-		fullPath << ".iom";
-
-	std::vector<uint8_t> svgData(svgSource.String(), svgSource.String() + svgSource.Length());
-	haiku::Icon icon = haiku::IconConverter::LoadFromBuffer(svgData, haiku::FORMAT_SVG);
-
-	if (!haiku::IconConverter::GetLastError().empty())
-		return B_ERROR;
-
-	std::vector<uint8_t> iomData;
-	if (!haiku::IconConverter::SaveToBuffer(icon, iomData, haiku::FORMAT_IOM))
-		return B_ERROR;
-
-	return _SaveBinaryData(fullPath.String(), iomData.data(), iomData.size(), "application/x-vnd.haiku-icon");
-}
-
-status_t
-SVGFileManager::_ExportPNG(const char* filePath, const BString& svgSource, int32 size)
-{
-	if (svgSource.IsEmpty())
-		return B_BAD_VALUE;
-
-	BString fullPath = filePath;
-	if (!fullPath.EndsWith(".png"))
-		fullPath << ".png";
-
-	char* sourceCopy = strdup(svgSource.String());
-	NSVGimage* image = nsvgParse(sourceCopy, "px", 96.0f);
-
-	float svgW = 0, svgH = 0;
-	if (image) {
-		svgW = image->width;
-		svgH = image->height;
-		nsvgDelete(image);
-	}
-	free(sourceCopy);
-
-	if (svgW <= 0 || svgH <= 0)
-		return B_ERROR;
-
-	int32 targetW, targetH;
-
-	if (size == -1) {
-		targetW = (int32)svgW;
-		targetH = (int32)svgH;
-	} else {
-		if (svgW > svgH) {
-			targetW = size;
-			targetH = (int32)((svgH / svgW) * size);
-		} else {
-			targetH = size;
-			targetW = (int32)((svgW / svgH) * size);
-		}
-		if (targetW < 1) targetW = 1;
-		if (targetH < 1) targetH = 1;
-	}
-
-	std::vector<uint8_t> svgData(svgSource.String(), svgSource.String() + svgSource.Length());
-	haiku::Icon icon = haiku::IconConverter::LoadFromBuffer(svgData, haiku::FORMAT_SVG);
-
-	if (!haiku::IconConverter::GetLastError().empty())
-		return B_ERROR;
-
-	haiku::ConvertOptions opts;
-	opts.pngWidth = targetW;
-	opts.pngHeight = targetH;
-	opts.pngScale = 1.0f;
-
-	std::vector<uint8_t> pngData;
-	if (!haiku::IconConverter::SaveToBuffer(icon, pngData, haiku::FORMAT_PNG, opts))
-		return B_ERROR;
-
-	return _SaveBinaryData(fullPath.String(), pngData.data(), pngData.size(), "image/png");
+	return SVGExporter::ExportCPP(filePath, data, size);
 }
 
 bool
-SVGFileManager::HandleExportSavePanel(BMessage* message, const BString& svgSource, const unsigned char* hvifData, size_t hvifSize)
+SVGFileManager::HandleExportSavePanel(BMessage* message, SVGDocument* document, const unsigned char* hvifData, size_t hvifSize,
+	const BString& rdefText, const BString& cppText)
 {
 	entry_ref dirRef;
 	BString fileName;
@@ -547,19 +420,25 @@ SVGFileManager::HandleExportSavePanel(BMessage* message, const BString& svgSourc
 			break;
 
 		case MSG_EXPORT_RDEF:
-			result = ExportRDef(fullPath.String(), hvifData, hvifSize);
+			if (!rdefText.IsEmpty())
+				result = SVGExporter::ExportRDef(fullPath.String(), rdefText);
+			else
+				result = ExportRDef(fullPath.String(), hvifData, hvifSize);
 			break;
 
 		case MSG_EXPORT_CPP:
-			result = ExportCPP(fullPath.String(), hvifData, hvifSize);
+			if (!cppText.IsEmpty())
+				result = SVGExporter::ExportCPP(fullPath.String(), cppText);
+			else
+				result = ExportCPP(fullPath.String(), hvifData, hvifSize);
 			break;
 
 		case MSG_EXPORT_IOM:
-			result = _ExportIOM(fullPath.String(), svgSource);
+			result = SVGExporter::ExportIOM(fullPath.String(), document);
 			break;
 
 		case MSG_EXPORT_PNG:
-			result = _ExportPNG(fullPath.String(), svgSource, fCurrentExportSize);
+			result = SVGExporter::ExportPNG(fullPath.String(), document, fCurrentExportSize);
 			break;
 	}
 
@@ -597,32 +476,6 @@ SVGFileManager::_ShowExportPanel(const char* defaultName, const char* extension,
 	fExportPanel->Show();
 }
 
-status_t
-SVGFileManager::_SaveBinaryData(const char* filePath, const unsigned char* data, size_t size, const char* mime)
-{
-	if (!filePath || !data || size == 0) {
-		return B_BAD_VALUE;
-	}
-
-	BFile file(filePath, B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
-	status_t initResult = file.InitCheck();
-	if (initResult != B_OK) {
-		return initResult;
-	}
-
-	ssize_t bytesWritten = file.Write(data, size);
-	if (bytesWritten != (ssize_t)size) {
-		return B_ERROR;
-	}
-
-	BNodeInfo nodeInfo(&file);
-	if (nodeInfo.InitCheck() == B_OK) {
-		nodeInfo.SetType(mime);
-	}
-
-	return B_OK;
-}
-
 bool
 SVGFileManager::_IsSVGFile(const char* filePath) const
 {
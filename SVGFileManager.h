@@ -12,13 +12,14 @@
 #include <File.h>
 #include <Entry.h>
 #include <Node.h>
+#include <Referenceable.h>
 #include <fs_attr.h>
 #include <vector>
 
 #include "SVGConstants.h"
+#include "SVGDocument.h"
 #include "IconConverter.h"
 
-class SVGView;
 class HVIFView;
 class BHandler;
 class VectorizationWorker;
@@ -38,7 +39,8 @@ public:
 	SVGFileManager();
 	~SVGFileManager();
 
-	bool LoadFile(const char* filePath, SVGView* svgView, HVIFView* iconView, BString& source);
+	bool LoadFile(const char* filePath, HVIFView* iconView, BString& source,
+		BReference<SVGDocument>& document);
 	status_t LoadSourceFromFile(const char* filePath, BString& source);
 
 	status_t SaveFile(const char* filePath, const BString& source, const char* mime);
@@ -60,7 +62,9 @@ public:
 	status_t ExportRDef(const char* filePath, const unsigned char* data, size_t size);
 	status_t ExportCPP(const char* filePath, const unsigned char* data, size_t size);
 
-	bool HandleExportSavePanel(BMessage* message, const BString& svgSource, const unsigned char* hvifData, size_t hvifSize);
+	bool HandleExportSavePanel(BMessage* message, SVGDocument* document, const unsigned char* hvifData, size_t hvifSize,
+		const BString& rdefText = BString(), const BString& cppText = BString());
+	uint32 CurrentExportType() const { return fCurrentExportType; }
 
 	BFilePanel* GetOpenPanel() { return fOpenPanel; }
 	BFilePanel* GetSavePanel() { return fSavePanel; }
@@ -77,18 +81,15 @@ private:
 	uint32 fCurrentExportType;
 	int32 fCurrentExportSize;
 
+	bool _LoadSource(const char* filePath, HVIFView* iconView, BString& source);
 	bool _LoadVectorIconFile(const char* filePath, haiku::IconFormat format, HVIFView* iconView, BString& source);
-	bool _LoadSVGFile(const char* filePath, SVGView* svgView, HVIFView* iconView, BString& source);
+	bool _LoadSVGFile(const char* filePath, BString& source);
 	bool _LoadFromFileAttributes(const char* filePath, HVIFView* iconView, BString& source);
 	void _ShowError(const char* message);
 	bool _IsSVGFile(const char* filePath) const;
 	bool _EnsureSVGExtension(BString& filePath) const;
 
-	status_t _ExportIOM(const char* filePath, const BString& svgSource);
-	status_t _ExportPNG(const char* filePath, const BString& svgSource, int32 size);
-
 	void _ShowExportPanel(const char* defaultName, const char* extension, uint32 exportType, BHandler* target);
-	status_t _SaveBinaryData(const char* filePath, const unsigned char* data, size_t size, const char* mime);
 };
 
 #endif
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2025-2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_HIGHLIGHT_RANGE_H
+#define SVG_HIGHLIGHT_RANGE_H
+
+#include <SupportDefs.h>
+
+enum highlight_type {
+	HIGHLIGHT_TEXT,
+	HIGHLIGHT_KEYWORD,
+	HIGHLIGHT_STRING,
+	HIGHLIGHT_COMMENT,
+	HIGHLIGHT_NUMBER,
+	HIGHLIGHT_OPERATOR,
+	HIGHLIGHT_TAG,
+	HIGHLIGHT_ATTRIBUTE,
+	HIGHLIGHT_PREPROCESSOR
+};
+
+struct HighlightRange {
+	int32 start;
+	int32 end;
+	highlight_type type;
+
+	HighlightRange(int32 s, int32 e, highlight_type t)
+		: start(s), end(e), type(t) {}
+};
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <Autolock.h>
+#include <Locker.h>
+
+#include <exception>
+
+#include "SVGIconConverter.h"
+
+// hvif-tools is not thread-safe in one respect: it keeps the last error in a
+// single process wide string, and loading reports failure only through it.
+// Loading and the read of that string hold this lock. Writing an icon reports
+// through its return value and runs unlocked, on the assumption that it does
+// not touch the error string.
+static BLocker sConverterLock("icon_converter");
+
+IconConversionContext::IconConversionContext()
+{
+}
+
+bool
+IconConversionContext::Load(const char* path, haiku::IconFormat format, haiku::Icon& icon)
+{
+	ClearError();
+
+	if (path == NULL) {
+		fLastError = "No file specified";
+		return false;
+	}
+
+	BAutolock lock(sConverterLock);
+
+	try {
+		icon = haiku::IconConverter::Load(path, format);
+		fLastError = haiku::IconConverter::GetLastError().c_str();
+	} catch (const std::exception& e) {
+		fLastError = e.what();
+	} catch (...) {
+		fLastError = "Unknown conversion error";
+	}
+
+	return !HasError();
+}
+
+bool
+IconConversionContext::LoadFromBuffer(const std::vector<uint8_t>& data,
+	haiku::IconFormat format, haiku::Icon& icon)
+{
+	ClearError();
+
+	BAutolock lock(sConverterLock);
+
+	try {
+		icon = haiku::IconConverter::LoadFromBuffer(data, format);
+		fLastError = haiku::IconConverter::GetLastError().c_str();
+	} catch (const std::exception& e) {
+		fLastError = e.what();
+	} catch (...) {
+		fLastError = "Unknown conversion error";
+	}
+
+	return !HasError();
+}
+
+bool
+IconConversionContext::LoadFromBuffer(const void* data, size_t size,
+	haiku::IconFormat format, haiku::Icon& icon)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	fScratch.assign(bytes, bytes + size);
+
+	bool result = LoadFromBuffer(fScratch, format, icon);
+	fScratch.clear();
+	return result;
+}
+
+bool
+IconConversionContext::SaveToBuffer(const haiku::Icon& icon, std::vector<uint8_t>& data,
+	haiku::IconFormat format, const haiku::ConvertOptions& options)
+{
+	ClearError();
+
+	bool result = false;
+
+	try {
+		result = haiku::IconConverter::SaveToBuffer(icon, data, format, options);
+	} catch (const std::exception& e) {
+		fLastError = e.what();
+		return false;
+	} catch (...) {
+		fLastError = "Unknown conversion error";
+		return false;
+	}
+
+	if (!result)
+		fLastError = "Failed to write icon";
+
+	return result;
+}
+
+// Loads and writes separately rather than through IconConverter::ConvertBuffer(),
+// so only the load is serialized.
+bool
+IconConversionContext::ConvertBuffer(const std::vector<uint8_t>& input,
+	haiku::IconFormat inputFormat, std::vector<uint8_t>& output,
+	haiku::IconFormat outputFormat, const haiku::ConvertOptions& options)
+{
+	haiku::Icon icon;
+	if (!LoadFromBuffer(input, inputFormat, icon))
+		return false;
+
+	return SaveToBuffer(icon, output, outputFormat, options);
+}
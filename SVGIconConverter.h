@@ -0,0 +1,45 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_ICON_CONVERTER_H
+#define SVG_ICON_CONVERTER_H
+
+#include <String.h>
+#include <SupportDefs.h>
+
+#include <vector>
+
+#include "IconConverter.h"
+
+// Conversion context wrapping haiku::IconConverter. Every call reports its
+// own success and keeps the error text in the context, so callers never poll
+// the library's global IconConverter::GetLastError(). A context is owned by
+// one thread; any number of contexts can be used at the same time.
+class IconConversionContext {
+public:
+	IconConversionContext();
+
+	bool Load(const char* path, haiku::IconFormat format, haiku::Icon& icon);
+	bool LoadFromBuffer(const std::vector<uint8_t>& data, haiku::IconFormat format,
+				haiku::Icon& icon);
+	bool LoadFromBuffer(const void* data, size_t size, haiku::IconFormat format,
+				haiku::Icon& icon);
+	bool SaveToBuffer(const haiku::Icon& icon, std::vector<uint8_t>& data,
+				haiku::IconFormat format,
+				const haiku::ConvertOptions& options = haiku::ConvertOptions());
+	bool ConvertBuffer(const std::vector<uint8_t>& input, haiku::IconFormat inputFormat,
+				std::vector<uint8_t>& output, haiku::IconFormat outputFormat,
+				const haiku::ConvertOptions& options = haiku::ConvertOptions());
+
+	bool HasError() const { return !fLastError.IsEmpty(); }
+	const BString& LastError() const { return fLastError; }
+	void ClearError() { fLastError.Truncate(0); }
+
+private:
+	BString					fLastError;
+	std::vector<uint8_t>	fScratch;
+};
+
+#endif
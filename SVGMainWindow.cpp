@@ -8,6 +8,7 @@
 #include <Alert.h>
 #include <AppFileInfo.h>
 #include <Resources.h>
+#include <MessageQueue.h>
 #include <MessageRunner.h>
 #include <File.h>
 #include <Clipboard.h>
@@ -29,15 +30,19 @@
 #include "SVGHVIFView.h"
 #include "SVGTextEdit.h"
 #include "SVGToolBar.h"
+#include "SVGTabView.h"
 #include "SVGApplication.h"
 #include "SVGSettings.h"
+#include "SVGBase64.h"
 #include "SVGCodeGenerator.h"
+#include "SVGConversionWorker.h"
 #include "SVGVectorizationWorker.h"
 #include "SVGVectorizationDialog.h"
+#include "SVGInputWindow.h"
 #include "IconSelectionDialog.h"
 #include "HvifStoreDefs.h"
 
-#include "IconConverter.h"
+#include "SVGIconConverter.h"
 
 #undef B_TRANSLATION_CONTEXT
 #define B_TRANSLATION_CONTEXT "SVGMainWindow"
@@ -64,6 +69,9 @@ SVGMainWindow::SVGMainWindow(const char* filePath)
 	fSplitView(NULL),
 	fToolBar(NULL),
 	fEditToolBar(NULL),
+	fSearchControl(NULL),
+	fSearchCountView(NULL),
+	fSearchFlags(0),
 	fDocumentModified(false),
 	fShowStatView(false),
 	fStructureView(NULL),
@@ -72,12 +80,19 @@ SVGMainWindow::SVGMainWindow(const char* filePath)
 	fShowBoundingBox(false),
 	fBoundingBoxStyle(1),
 	fCurrentUIState(0),
-	fStateUpdateRunner(NULL),
 	fClipboardHasData(false),
 	fTextHasSelection(false),
+	fSourceRevision(0),
+	fCheckedRevision(0),
+	fCheckedSourceRevision(0),
+	fHasUnappliedChanges(false),
 	fOriginalSourceText(),
 	fCurrentHVIFData(NULL),
 	fCurrentHVIFSize(0),
+	fRDefTabValid(false),
+	fCPPTabValid(false),
+	fHVIFPending(false),
+	fConversionWorker(NULL),
 	fVectorizationWorker(NULL),
 	fVectorizationDialog(NULL),
 	fBackupDocumentModified(false)
@@ -87,6 +102,7 @@ SVGMainWindow::SVGMainWindow(const char* filePath)
 	fMenuManager = new SVGMenuManager();
 	fFileManager = new SVGFileManager();
 	fVectorizationWorker = new SVGVectorizationWorker(this);
+	fConversionWorker = new SVGConversionWorker(this);
 
 	_BuildInterface();
 
@@ -117,6 +133,11 @@ SVGMainWindow::~SVGMainWindow()
 	delete fMenuManager;
 	delete fFileManager;
 	delete fVectorizationWorker;
+	if (fConversionWorker)
+		fConversionWorker->Shutdown();
+	if (fSVGView)
+		fSVGView->StopRendering();
+	_DrainWorkerResults();
 	delete[] fCurrentHVIFData;
 	_ClearBackupState();
 
@@ -160,6 +181,10 @@ SVGMainWindow::MessageReceived(BMessage* message)
 			_HandleIconDataReady(message);
 			break;
 
+		case MSG_HVIF_CONVERSION_RESULT:
+			_HandleConversionResult(message);
+			break;
+
 		case MSG_EXPORT_HVIF:
 		case MSG_EXPORT_RDEF:
 		case MSG_EXPORT_CPP:
@@ -213,9 +238,20 @@ SVGMainWindow::MessageReceived(BMessage* message)
 		case MSG_SEARCH_NEXT:
 		case MSG_SEARCH_PREV:
 		case MSG_SEARCH_ENTER:
+		case MSG_SEARCH_MODIFIED:
+		case MSG_SEARCH_MATCH_CASE:
+		case MSG_SEARCH_WHOLE_WORD:
+		case MSG_SEARCH_REGEX:
+		case MSG_SEARCH_PROGRESS:
 			_HandleSearchMessages(message);
 			break;
 
+		case MSG_REPLACE_ALL:
+		case MSG_REPLACE_ALL_DO:
+		case MSG_REPLACE_DONE:
+			_HandleReplaceMessages(message);
+			break;
+
 		case MSG_COPY_SVG_SOURCE:
 		case MSG_COPY_SVG_BASE64:
 		case MSG_COPY_HVIF_CPP:
@@ -233,9 +269,8 @@ SVGMainWindow::MessageReceived(BMessage* message)
 			_HandleVectorizationMessages(message);
 			break;
 
-		case MSG_STATE_UPDATE:
+		case B_CLIPBOARD_CHANGED:
 			_CheckClipboardState();
-			_CheckTextSelectionState();
 			_UpdateUIState();
 			break;
 
@@ -271,7 +306,10 @@ SVGMainWindow::LoadFile(const char* filePath)
 	if (!fFileManager || !fSVGView)
 		return;
 
-	if (fFileManager->LoadFile(filePath, fSVGView, fIconView, fCurrentSource)) {
+	BReference<SVGDocument> document;
+	// LoadFile() fills in fCurrentSource
+	fSourceRevision++;
+	if (fFileManager->LoadFile(filePath, fIconView, fCurrentSource, document)) {
 		BPath path(filePath);
 		BString title("SVGear - ");
 		title << path.Leaf();
@@ -281,6 +319,7 @@ SVGMainWindow::LoadFile(const char* filePath)
 		path.GetParent(&dirPath);
 		gSettings->SetString(kLastOpenPath, dirPath.Path());
 
+		_SetDocument(document.Get());
 		fSVGView->ResetView();
 		fCurrentFilePath = filePath;
 		fDocumentModified = fFileManager->GetLastLoadedFileType() != FILE_TYPE_SVG;
@@ -290,7 +329,6 @@ SVGMainWindow::LoadFile(const char* filePath)
 
 		_UpdateStatus();
 		_UpdateAllTabs();
-		_ReloadFromSource();
 		fSVGTextView->ClearUndoHistory();
 		_UpdateUIState();
 		_UpdateStatView();
@@ -378,9 +416,17 @@ SVGMainWindow::_BuildToolBars()
 	fSearchControl->SetExplicitMinSize(BSize(150, B_SIZE_UNSET));
 	fSearchControl->SetExplicitMaxSize(BSize(200, B_SIZE_UNSET));
 	fSearchControl->TextView()->SetExplicitMinSize(BSize(150, B_SIZE_UNSET));
+	fSearchControl->SetModificationMessage(new BMessage(MSG_SEARCH_MODIFIED));
 	fEditToolBar->AddView(fSearchControl);
+	fSearchCountView = new BStringView("search_count", "");
+	fSearchCountView->SetExplicitMinSize(BSize(be_plain_font->StringWidth("00000 of 00000"), B_SIZE_UNSET));
+	fSearchCountView->SetAlignment(B_ALIGN_CENTER);
+	fEditToolBar->AddView(fSearchCountView);
 	fEditToolBar->AddAction(MSG_SEARCH_PREV, this, SVGApplication::GetIcon("go-up", TOOLBAR_ICON_SIZE), B_TRANSLATE("Find previous"));
 	fEditToolBar->AddAction(MSG_SEARCH_NEXT, this, SVGApplication::GetIcon("go-down", TOOLBAR_ICON_SIZE), B_TRANSLATE("Find next"));
+	fEditToolBar->AddAction(MSG_SEARCH_MATCH_CASE, this, NULL, B_TRANSLATE("Match case"), "Aa", true);
+	fEditToolBar->AddAction(MSG_SEARCH_WHOLE_WORD, this, NULL, B_TRANSLATE("Whole words"), "W", true);
+	fEditToolBar->AddAction(MSG_SEARCH_REGEX, this, NULL, B_TRANSLATE("Regular expression"), ".*", true);
 }
 
 void
@@ -417,7 +463,7 @@ SVGMainWindow::_BuildMainView()
 void
 SVGMainWindow::_BuildTabView()
 {
-	fTabView = new BTabView("tab_view", B_WIDTH_FROM_WIDEST);
+	fTabView = new SVGTabView("tab_view", B_WIDTH_FROM_WIDEST);
 
 	BGroupView* svgTabGroup = new BGroupView(B_VERTICAL, 0);
 	svgTabGroup->GroupLayout()->AddView(fEditToolBar);
@@ -508,7 +554,18 @@ SVGMainWindow::_HandleFileMessages(BMessage* message)
 			if (fFileManager && fFileManager->GetExportPanel() &&
 				fFileManager->GetExportPanel()->Window() &&
 				fFileManager->GetExportPanel()->Window()->IsActive()) {
-				if (fFileManager->HandleExportSavePanel(message, fCurrentSource, fCurrentHVIFData, fCurrentHVIFSize)) {
+				uint32 exportType = fFileManager->CurrentExportType();
+				if ((exportType == MSG_EXPORT_HVIF || exportType == MSG_EXPORT_RDEF
+						|| exportType == MSG_EXPORT_CPP) && !_HasHVIFData()) {
+					_ShowError(B_TRANSLATE("No HVIF data generated"));
+					break;
+				}
+
+				BString rdefText = exportType == MSG_EXPORT_RDEF ? _RDefText() : BString();
+				BString cppText = exportType == MSG_EXPORT_CPP ? _CPPText() : BString();
+
+				if (fFileManager->HandleExportSavePanel(message, fDocument.Get(),
+						fCurrentHVIFData, fCurrentHVIFSize, rdefText, cppText)) {
 					_ShowSuccess(MSG_FILE_EXPORTED);
 				} else {
 					_ShowError(ERROR_EXPORT_FAILED);
@@ -723,6 +780,7 @@ SVGMainWindow::_HandleSelectionMessages(BMessage *message)
 		case MSG_SELECTION_CHANGED:
 		{
 			_CheckTextSelectionState();
+			_UpdateSearchMatches();
 			_UpdateUIState();
 
 			const void* source = message->GetPointer("source");
@@ -746,30 +804,55 @@ SVGMainWindow::_HandleSearchMessages(BMessage* message)
 	if (!fSVGTextView || !fSearchControl)
 		return;
 
-	SVGTextEdit* targetEditor = fSVGTextView;
-	if (fTabView && !fSplitView->IsItemCollapsed(1)) {
-		int32 selection = fTabView->Selection();
-		if (selection == TAB_RDEF) targetEditor = fRDefTextView;
-		else if (selection == TAB_CPP) targetEditor = fCPPTextView;
-	}
+	switch (message->what) {
+		case MSG_SEARCH_MATCH_CASE:
+			fSearchFlags ^= SEARCH_IGNORE_CASE;
+			break;
 
-	const char* searchText = fSearchControl->Text();
-	if (strlen(searchText) == 0) {
-		fSearchControl->MakeFocus(true);
-		return;
+		case MSG_SEARCH_WHOLE_WORD:
+			fSearchFlags ^= SEARCH_WHOLE_WORD;
+			break;
+
+		case MSG_SEARCH_REGEX:
+			fSearchFlags ^= SEARCH_REGEX;
+			break;
+
+		case MSG_SEARCH_PROGRESS:
+			if (message->GetBool("replace", false)) {
+				if (fSearchCountView) {
+					BString label;
+					label.SetToFormat(B_TRANSLATE("Replacing: %ld"),
+						(long)message->GetInt32("count", 0));
+					fSearchCountView->SetText(label.String());
+				}
+				return;
+			}
+			if (message->GetPointer("source") != _SearchTargetEditor())
+				return;
+			break;
 	}
 
+	_UpdateSearchMatches();
+
+	SVGTextEdit* targetEditor = _SearchTargetEditor();
+	const char* searchText = fSearchControl->Text();
 	bool found = false;
 
 	switch (message->what) {
 		case MSG_SEARCH_NEXT:
 		case MSG_SEARCH_ENTER:
-			found = targetEditor->Find(searchText, true);
+			if (strlen(searchText) > 0)
+				found = targetEditor->Find(searchText, true, true, fSearchFlags);
 			break;
 
 		case MSG_SEARCH_PREV:
-			found = targetEditor->Find(searchText, false);
+			if (strlen(searchText) > 0)
+				found = targetEditor->Find(searchText, false, true, fSearchFlags);
 			break;
+
+		default:
+			// the matches are marked, nothing is selected yet
+			return;
 	}
 
 	if (found) {
@@ -779,6 +862,127 @@ SVGMainWindow::_HandleSearchMessages(BMessage* message)
 	}
 }
 
+SVGTextEdit*
+SVGMainWindow::_SearchTargetEditor() const
+{
+	SVGTextEdit* targetEditor = fSVGTextView;
+	if (fTabView && !fSplitView->IsItemCollapsed(1)) {
+		int32 selection = fTabView->Selection();
+		if (selection == TAB_RDEF) targetEditor = fRDefTextView;
+		else if (selection == TAB_CPP) targetEditor = fCPPTextView;
+	}
+	return targetEditor;
+}
+
+// Marks the matches of the search text in the editor it applies to and
+// shows their count. FindAll() only searches again when the text to find
+// or the options change; edits keep the marked matches up to date.
+void
+SVGMainWindow::_UpdateSearchMatches()
+{
+	if (!fSVGTextView || !fSearchControl || !fSearchCountView)
+		return;
+
+	SVGTextEdit* targetEditor = _SearchTargetEditor();
+	SVGTextEdit* editors[] = { fSVGTextView, fRDefTextView, fCPPTextView };
+	for (size_t i = 0; i < sizeof(editors) / sizeof(editors[0]); i++) {
+		if (editors[i] && editors[i] != targetEditor)
+			editors[i]->ClearSearchMatches();
+	}
+
+	const char* searchText = fSearchControl->Text();
+	int32 count = targetEditor->FindAll(searchText, fSearchFlags);
+
+	BString label;
+	if (strlen(searchText) > 0) {
+		int32 index = targetEditor->SelectedSearchMatch();
+		if (targetEditor->SearchError() != NULL)
+			label = B_TRANSLATE("Invalid pattern");
+		else if (targetEditor->IsSearching()) {
+			if (count > 0)
+				label.SetToFormat(B_TRANSLATE("%ld matches" B_UTF8_ELLIPSIS), (long)count);
+			else
+				label = B_TRANSLATE("Searching" B_UTF8_ELLIPSIS);
+		} else if (count == 0)
+			label = B_TRANSLATE("No matches");
+		else if (index >= 0)
+			label.SetToFormat(B_TRANSLATE("%ld of %ld"), (long)(index + 1), (long)count);
+		else
+			label.SetToFormat(B_TRANSLATE("%ld matches"), (long)count);
+	}
+
+	if (label != fSearchCountView->Text())
+		fSearchCountView->SetText(label.String());
+
+	fSearchControl->SetToolTip(targetEditor->SearchError());
+}
+
+// Replace-all asks for the text to find and its replacement, then leaves
+// the work to the search worker of the editor; the result arrives as
+// MSG_REPLACE_DONE once the editor has applied it as a single edit.
+void
+SVGMainWindow::_HandleReplaceMessages(BMessage* message)
+{
+	if (!fSVGTextView || !fSearchControl)
+		return;
+
+	switch (message->what) {
+		case MSG_REPLACE_ALL:
+		{
+			SVGInputWindow* input = new SVGInputWindow(B_TRANSLATE("Replace all"),
+				this, MSG_REPLACE_ALL_DO, BUTTON_OK | BUTTON_CANCEL);
+			input->AddTextField("find", B_TRANSLATE("Find:"), fSearchControl->Text());
+			input->AddTextField("replace", B_TRANSLATE("Replace with:"), "");
+			input->AddCheckBoxField("regex", B_TRANSLATE("Regular expression"),
+				(fSearchFlags & SEARCH_REGEX) != 0);
+			input->AddCheckBoxField("match_case", B_TRANSLATE("Match case"),
+				(fSearchFlags & SEARCH_IGNORE_CASE) == 0);
+			input->AddCheckBoxField("whole_word", B_TRANSLATE("Whole words"),
+				(fSearchFlags & SEARCH_WHOLE_WORD) != 0);
+			input->Show();
+			break;
+		}
+
+		case MSG_REPLACE_ALL_DO:
+		{
+			const char* findText = message->GetString("find", "");
+			if (strlen(findText) == 0)
+				break;
+
+			uint32 flags = 0;
+			if (message->GetBool("regex", false))
+				flags |= SEARCH_REGEX;
+			if (!message->GetBool("match_case", true))
+				flags |= SEARCH_IGNORE_CASE;
+			if (message->GetBool("whole_word", false))
+				flags |= SEARCH_WHOLE_WORD;
+
+			_SearchTargetEditor()->ReplaceAll(findText,
+				message->GetString("replace", ""), flags);
+			break;
+		}
+
+		case MSG_REPLACE_DONE:
+		{
+			if (!fSearchCountView)
+				break;
+
+			BString label;
+			const char* error = NULL;
+			if (message->FindString("error", &error) == B_OK)
+				label = B_TRANSLATE("Invalid pattern");
+			else if (message->GetInt32("status", B_OK) == B_CANCELED)
+				label = B_TRANSLATE("Text changed, nothing replaced");
+			else {
+				label.SetToFormat(B_TRANSLATE("Replaced %ld"),
+					(long)message->GetInt32("count", 0));
+			}
+			fSearchCountView->SetText(label.String());
+			break;
+		}
+	}
+}
+
 void
 SVGMainWindow::_HandleClipboardCopyMessages(BMessage* message)
 {
@@ -797,9 +1001,8 @@ SVGMainWindow::_HandleClipboardCopyMessages(BMessage* message)
 		{
 			BString source = _GetCurrentSource();
 			if (source.Length() > 0) {
-				BString base64 = _EncodeBase64(source);
-				BString htmlTag;
-				htmlTag.SetToFormat("<img src=\"data:image/svg+xml;base64,%s\" />", base64.String());				
+				BString htmlTag = SVGBase64::ImgTag("image/svg+xml", source.String(),
+					source.Length());
 				_CopyToClipboard(htmlTag.String());
 				_ShowSuccess(B_TRANSLATE("HTML img tag with Base64 SVG copied"));
 			}
@@ -808,9 +1011,8 @@ SVGMainWindow::_HandleClipboardCopyMessages(BMessage* message)
 
 		case MSG_COPY_HVIF_CPP:
 		{
-			if (fCurrentHVIFData && fCurrentHVIFSize > 0) {
-				BString content = SVGCodeGenerator::GenerateCPP(fCurrentHVIFData, fCurrentHVIFSize);
-				_CopyToClipboard(content.String());
+			if (_HasHVIFData()) {
+				_CopyToClipboard(_CPPText().String());
 				_ShowSuccess(B_TRANSLATE("C++ code copied to clipboard"));
 			}
 			break;
@@ -818,9 +1020,8 @@ SVGMainWindow::_HandleClipboardCopyMessages(BMessage* message)
 
 		case MSG_COPY_HVIF_RDEF:
 		{
-			if (fCurrentHVIFData && fCurrentHVIFSize > 0) {
-				BString content = SVGCodeGenerator::GenerateRDef(fCurrentHVIFData, fCurrentHVIFSize);
-				_CopyToClipboard(content.String());
+			if (_HasHVIFData()) {
+				_CopyToClipboard(_RDefText().String());
 				_ShowSuccess(B_TRANSLATE("RDef code copied to clipboard"));
 			}
 			break;
@@ -860,13 +1061,15 @@ SVGMainWindow::_HandleClipboardCopyMessages(BMessage* message)
 			int32 size = message->GetInt32("size", 64);
 			BString source = _GetCurrentSource();
 
-			if (source.Length() > 0 && fSVGView && fSVGView->SVGImage()) {
-				std::vector<uint8_t> svgData(source.String(), source.String() + source.Length());
-				haiku::Icon icon = haiku::IconConverter::LoadFromBuffer(svgData, haiku::FORMAT_SVG);
+			BReference<SVGDocument> document = fDocument;
+			if (source.Length() > 0 && (document.Get() == NULL || document->Source() != source))
+				document.SetTo(new SVGDocument(source), true);
+
+			if (source.Length() > 0 && document->InitCheck() == B_OK) {
+				float svgW = document->Width();
+				float svgH = document->Height();
 
-				if (haiku::IconConverter::GetLastError().empty()) {
-					float svgW = fSVGView->SVGWidth();
-					float svgH = fSVGView->SVGHeight();
+				if (svgW > 0 && svgH > 0) {
 					int32 targetW, targetH;
 
 					if (size == -1) {
@@ -893,7 +1096,7 @@ SVGMainWindow::_HandleClipboardCopyMessages(BMessage* message)
 					opts.pngScale = 1.0f;
 
 					std::vector<uint8_t> pngData;
-					if (haiku::IconConverter::SaveToBuffer(icon, pngData, haiku::FORMAT_PNG, opts)) {
+					if (document->ConvertTo(haiku::FORMAT_PNG, opts, pngData)) {
 						BMemoryIO io(pngData.data(), pngData.size());
 						BBitmap* pngBmp = BTranslationUtils::GetBitmap(&io);
 						if (pngBmp) {
@@ -940,13 +1143,20 @@ SVGMainWindow::_HandleIconDataReady(BMessage* message)
 			}
 		}
 		fCurrentSource = svgContent;
+		fSourceRevision++;
 	}
 
 	if (message->FindData("hvif_data", B_RAW_TYPE, &data, &size) == B_OK && size > 0) {
+		if (fConversionWorker)
+			fConversionWorker->CancelConversion();
+
 		delete[] fCurrentHVIFData;
 		fCurrentHVIFSize = size;
 		fCurrentHVIFData = new unsigned char[fCurrentHVIFSize];
 		memcpy(fCurrentHVIFData, data, fCurrentHVIFSize);
+		fHVIFPending = false;
+		fCurrentRDefText.Truncate(0);
+		fCurrentCPPText.Truncate(0);
 	}
 
 	BString titleStr = message->GetString("title", "Downloaded Icon");
@@ -957,10 +1167,9 @@ SVGMainWindow::_HandleIconDataReady(BMessage* message)
 	fOriginalSourceText = fCurrentSource;
 	fDocumentModified = true;
 
-	if (fSVGView) {
-		fSVGView->LoadFromMemory(fCurrentSource.String());
+	_SetDocumentSource(fCurrentSource);
+	if (fSVGView)
 		fSVGView->ResetView();
-	}
 
 	if (fIconView && fCurrentHVIFData)
 		fIconView->SetIcon(fCurrentHVIFData, fCurrentHVIFSize);
@@ -995,7 +1204,8 @@ SVGMainWindow::_HandleDropMessages(BMessage* message)
 		convertOpts.svgHeight = 64;
 		convertOpts.preserveNames = true;
 
-		bool status = haiku::IconConverter::ConvertBuffer(
+		IconConversionContext context;
+		bool status = context.ConvertBuffer(
 			hvifData, haiku::FORMAT_HVIF,
 			svgData, haiku::FORMAT_SVG,
 			convertOpts);
@@ -1007,8 +1217,12 @@ SVGMainWindow::_HandleDropMessages(BMessage* message)
 		fCurrentHVIFSize = hvifData.size();
 		fCurrentHVIFData = new unsigned char[fCurrentHVIFSize];
 		memcpy(fCurrentHVIFData, hvifData.data(), fCurrentHVIFSize);
+		fHVIFPending = false;
+		fCurrentRDefText.Truncate(0);
+		fCurrentCPPText.Truncate(0);
 
 		fCurrentSource.SetTo(reinterpret_cast<const char*>(svgData.data()), svgData.size());
+		fSourceRevision++;
 		fOriginalSourceText = fCurrentSource;
 		fDocumentModified = true;
 
@@ -1035,7 +1249,7 @@ SVGMainWindow::_HandleExportMessages(BMessage* message)
 
 	switch (message->what) {
 		case MSG_EXPORT_HVIF:
-			if (!fCurrentHVIFData || fCurrentHVIFSize == 0) {
+			if (!_HasHVIFData()) {
 				_ShowError(B_TRANSLATE("No HVIF data generated"));
 				return;
 			}
@@ -1043,7 +1257,7 @@ SVGMainWindow::_HandleExportMessages(BMessage* message)
 			break;
 
 		case MSG_EXPORT_RDEF:
-			if (!fCurrentHVIFData || fCurrentHVIFSize == 0) {
+			if (!_HasHVIFData()) {
 				_ShowError(B_TRANSLATE("No HVIF data generated"));
 				return;
 			}
@@ -1051,7 +1265,7 @@ SVGMainWindow::_HandleExportMessages(BMessage* message)
 			break;
 
 		case MSG_EXPORT_CPP:
-			if (!fCurrentHVIFData || fCurrentHVIFSize == 0) {
+			if (!_HasHVIFData()) {
 				_ShowError(B_TRANSLATE("No HVIF data generated"));
 				return;
 			}
@@ -1107,8 +1321,8 @@ SVGMainWindow::_HandleVectorizationMessages(BMessage* message)
 				message->FindString("image_path", &imagePath) == B_OK) {
 
 				fCurrentSource = svgData;
-				if (fSVGView)
-					fSVGView->LoadFromMemory(svgData.String());
+				fSourceRevision++;
+				_SetDocumentSource(fCurrentSource);
 
 				_GenerateHVIFFromSVG();
 				_UpdateAllTabs();
@@ -1247,6 +1461,7 @@ SVGMainWindow::_HandleSavePanel(BMessage* message)
 		fCurrentFilePath = fullPath;
 		fOriginalSourceText = currentSource;
 		fCurrentSource = currentSource;
+		fSourceRevision++;
 		if (fFileManager) {
 			fFileManager->SetLastLoadedFileType(FILE_TYPE_SVG);
 		}
@@ -1264,6 +1479,7 @@ SVGMainWindow::_HandleSavePanel(BMessage* message)
 void
 SVGMainWindow::_HandleTabSelection()
 {
+	_UpdateCodeTabs();
 }
 
 void
@@ -1306,34 +1522,6 @@ SVGMainWindow::_CopyBitmapToClipboard(BBitmap* bitmap)
 	}
 }
 
-static const char kBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
-BString
-SVGMainWindow::_EncodeBase64(const BString& input)
-{
-	BString output;
-	int32 length = input.Length();
-	const unsigned char* data = (const unsigned char*)input.String();
-	int val = 0, valb = -6;
-
-	for (int32 i = 0; i < length; i++) {
-		val = (val << 8) + data[i];
-		valb += 8;
-		while (valb >= 0) {
-			output += kBase64Alphabet[(val >> valb) & 0x3F];
-			valb -= 6;
-		}
-	}
-
-	if (valb > -6)
-		output += kBase64Alphabet[((val << 8) >> (valb + 8)) & 0x3F];
-
-	while (output.Length() % 4)
-		output += '=';
-
-	return output;
-}
-
 void
 SVGMainWindow::_StartRasterImageVectorization(const char* filePath)
 {
@@ -1365,6 +1553,8 @@ SVGMainWindow::_LoadNewFile()
 	delete[] fCurrentHVIFData;
 	fCurrentHVIFData = NULL;
 	fCurrentHVIFSize = 0;
+	fCurrentRDefText.Truncate(0);
+	fCurrentCPPText.Truncate(0);
 
 	fCurrentFilePath = "";
 	fOriginalSourceText = fCurrentSource;
@@ -1397,12 +1587,12 @@ SVGMainWindow::_LoadTemplateFile(const char* resourceName, const char* title)
 
 	data[size] = 0;
 	fCurrentSource.SetTo(data);
+	fSourceRevision++;
 	fOriginalSourceText = fCurrentSource;
 
-	if (fSVGView) {
-		fSVGView->LoadFromMemory(fCurrentSource.String());
+	_SetDocumentSource(fCurrentSource);
+	if (fSVGView)
 		fSVGView->ResetView();
-	}
 
 	_GenerateHVIFFromSVG();
 	_UpdateStatus();
@@ -1438,9 +1628,11 @@ SVGMainWindow::_SaveFile()
 				BString editorText = fSVGTextView->Text();
 				if (editorText == currentSource) {
 					fCurrentSource = currentSource;
+					fSourceRevision++;
 				}
 			} else {
 				fCurrentSource = currentSource;
+				fSourceRevision++;
 			}
 			fDocumentModified = false;
 			_ShowSuccess(MSG_FILE_SAVED);
@@ -1486,43 +1678,102 @@ SVGMainWindow::_UpdateTitleAfterSave(const char* filePath)
 void
 SVGMainWindow::_GenerateHVIFFromSVG()
 {
-	if (fCurrentSource.IsEmpty())
+	if (fCurrentSource.IsEmpty() || !fConversionWorker)
 		return;
 
-	delete[] fCurrentHVIFData;
-	fCurrentHVIFData = NULL;
-	fCurrentHVIFSize = 0;
+	BReference<SVGDocument> document = fDocument;
+	if (document.Get() == NULL || document->Source() != fCurrentSource)
+		document.SetTo(new SVGDocument(fCurrentSource), true);
 
-	try {
-		std::vector<uint8_t> svgData(fCurrentSource.String(),
-									 fCurrentSource.String() + fCurrentSource.Length());
+	fConversionWorker->RequestConversion(document.Get(), _IsCodeTabVisible());
 
-		haiku::Icon icon = haiku::IconConverter::LoadFromBuffer(svgData, haiku::FORMAT_SVG);
+	// Exporting and copying wait for the result of this source.
+	fHVIFPending = true;
+	_UpdateUIState();
+}
 
-		std::string errorMsg = haiku::IconConverter::GetLastError();
-		if (!errorMsg.empty()) {
-			if (fIconView)
-				fIconView->RemoveIcon();
-			return;
+// The conversion worker and the tile render threads have quit, but what
+// they sent before is still waiting in the queue or in the port, and each
+// conversion result and rendered tile owns its data.
+void
+SVGMainWindow::_DrainWorkerResults()
+{
+	BMessage* message;
+	while ((message = MessageQueue()->NextMessage()) != NULL
+		|| (message = MessageFromPort(0)) != NULL) {
+		SVGConversionResult* result = NULL;
+		BBitmap* tile = NULL;
+		if (message->what == MSG_HVIF_CONVERSION_RESULT
+			&& message->FindPointer("result", (void**)&result) == B_OK) {
+			delete result;
+		} else if (message->what == MSG_TILE_RENDERED
+			&& message->FindPointer("tile", (void**)&tile) == B_OK) {
+			delete tile;
 		}
+		delete message;
+	}
+}
 
-		std::vector<uint8_t> hvifData;
-		haiku::ConvertOptions opts;
+void
+SVGMainWindow::_HandleConversionResult(BMessage* message)
+{
+	SVGConversionResult* result = NULL;
+	if (message->FindPointer("result", (void**)&result) != B_OK || result == NULL)
+		return;
 
-		if (haiku::IconConverter::SaveToBuffer(icon, hvifData, haiku::FORMAT_HVIF, opts) && !hvifData.empty()) {
-			fCurrentHVIFSize = hvifData.size();
-			fCurrentHVIFData = new unsigned char[fCurrentHVIFSize];
-			memcpy(fCurrentHVIFData, hvifData.data(), fCurrentHVIFSize);
-		}
-	} catch (...) {
+	if (!fConversionWorker || !fConversionWorker->IsCurrent(result->generation)) {
+		delete result;
+		return;
 	}
 
+	fHVIFPending = false;
+	delete[] fCurrentHVIFData;
+	fCurrentHVIFData = result->hvifData;
+	fCurrentHVIFSize = result->hvifSize;
+	result->hvifData = NULL;
+	result->hvifSize = 0;
+
+	fCurrentRDefText.Adopt(result->rdef);
+	fCurrentCPPText.Adopt(result->cpp);
+	delete result;
+
 	if (fIconView) {
 		if (fCurrentHVIFData && fCurrentHVIFSize > 0)
 			fIconView->SetIcon(fCurrentHVIFData, fCurrentHVIFSize);
 		else
 			fIconView->RemoveIcon();
 	}
+
+	_InvalidateCodeTabs();
+
+	if (fStatView)
+		fStatView->SetIntValue("hvif-size", fCurrentHVIFSize);
+
+	_UpdateUIState();
+}
+
+bool
+SVGMainWindow::_SetDocumentSource(const BString& source)
+{
+	BReference<SVGDocument> document(new SVGDocument(source), true);
+	if (document->InitCheck() != B_OK)
+		return false;
+
+	_SetDocument(document.Get());
+	return true;
+}
+
+void
+SVGMainWindow::_SetDocument(SVGDocument* document)
+{
+	fDocument.SetTo(document);
+
+	if (fSVGView)
+		fSVGView->SetDocument(document);
+	if (fStatView)
+		fStatView->SetDocument(document);
+	if (fStructureView)
+		fStructureView->SetDocument(document);
 }
 
 void
@@ -1533,8 +1784,7 @@ SVGMainWindow::_UpdateAllTabs()
 		fOriginalSourceText = fCurrentSource;
 	}
 
-	_UpdateRDefTab();
-	_UpdateCPPTab();
+	_InvalidateCodeTabs();
 
 	_UpdateUIState();
 }
@@ -1551,8 +1801,9 @@ SVGMainWindow::_UpdateRDefTab()
 		return;
 	}
 
-	BString rdefContent = SVGCodeGenerator::GenerateRDef(fCurrentHVIFData, fCurrentHVIFSize);
-	fRDefTextView->SetText(rdefContent.String());
+	std::vector<HighlightRange> ranges;
+	SVGCodeGenerator::GetRDefHighlights(fCurrentHVIFSize, 1, NULL, ranges);
+	fRDefTextView->SetHighlightedText(_RDefText().String(), ranges);
 }
 
 void
@@ -1567,8 +1818,68 @@ SVGMainWindow::_UpdateCPPTab()
 		return;
 	}
 
-	BString cppContent = SVGCodeGenerator::GenerateCPP(fCurrentHVIFData, fCurrentHVIFSize);
-	fCPPTextView->SetText(cppContent.String());
+	std::vector<HighlightRange> ranges;
+	SVGCodeGenerator::GetCPPHighlights(fCurrentHVIFSize, NULL, NULL, ranges);
+	fCPPTextView->SetHighlightedText(_CPPText().String(), ranges);
+}
+
+void
+SVGMainWindow::_InvalidateCodeTabs()
+{
+	fRDefTabValid = false;
+	fCPPTabValid = false;
+
+	_UpdateCodeTabs();
+}
+
+void
+SVGMainWindow::_UpdateCodeTabs()
+{
+	if (!_IsCodeTabVisible())
+		return;
+
+	int32 selection = fTabView->Selection();
+	if (selection == TAB_RDEF && !fRDefTabValid) {
+		_UpdateRDefTab();
+		fRDefTabValid = true;
+	} else if (selection == TAB_CPP && !fCPPTabValid) {
+		_UpdateCPPTab();
+		fCPPTabValid = true;
+	}
+}
+
+bool
+SVGMainWindow::_IsCodeTabVisible() const
+{
+	if (!fTabView || !fSplitView || fSplitView->IsItemCollapsed(1))
+		return false;
+
+	int32 selection = fTabView->Selection();
+	return selection == TAB_RDEF || selection == TAB_CPP;
+}
+
+bool
+SVGMainWindow::_HasHVIFData() const
+{
+	return fCurrentHVIFData && fCurrentHVIFSize > 0 && !fHVIFPending;
+}
+
+const BString&
+SVGMainWindow::_RDefText()
+{
+	if (fCurrentRDefText.IsEmpty() && fCurrentHVIFData && fCurrentHVIFSize > 0)
+		fCurrentRDefText = SVGCodeGenerator::GenerateRDef(fCurrentHVIFData, fCurrentHVIFSize);
+
+	return fCurrentRDefText;
+}
+
+const BString&
+SVGMainWindow::_CPPText()
+{
+	if (fCurrentCPPText.IsEmpty() && fCurrentHVIFData && fCurrentHVIFSize > 0)
+		fCurrentCPPText = SVGCodeGenerator::GenerateCPP(fCurrentHVIFData, fCurrentHVIFSize);
+
+	return fCurrentCPPText;
 }
 
 void
@@ -1580,6 +1891,7 @@ SVGMainWindow::_ToggleSourceView()
 	fShowSourceView = !fShowSourceView;
 
 	fSplitView->SetItemCollapsed(1, !fShowSourceView);
+	_UpdateCodeTabs();
 
 	if (fShowSourceView) {
 		float mainWeight = gSettings->GetFloat(kMainViewWeight, 0.7f);
@@ -1588,6 +1900,7 @@ SVGMainWindow::_ToggleSourceView()
 		fSplitView->SetItemWeight(1, sourceWeight, false);
 	}
 
+	_CheckTextSelectionState();
 	_UpdateViewMenu();
 	_UpdateStatus();
 	_UpdateUIState();
@@ -1635,23 +1948,20 @@ SVGMainWindow::_ReloadFromSource()
 		return;
 	}
 
-	status_t result = fSVGView->LoadFromMemory(sourceText.String());
-	if (result != B_OK) {
+	if (!_SetDocumentSource(sourceText)) {
 		_ShowError(ERROR_PARSING_SVG);
 	} else {
 		if (fCurrentSource != sourceText)
 			fDocumentModified = true;
 
 		fCurrentSource = sourceText;
+		fSourceRevision++;
 
 		_GenerateHVIFFromSVG();
-		_UpdateRDefTab();
-		_UpdateCPPTab();
 		_UpdateStatus();
 		_UpdateUIState();
 	}
 
-	fStatView->SetSVGImage(fSVGView->SVGImage());
 	_UpdateStatView();
 }
 
@@ -1659,7 +1969,7 @@ void
 SVGMainWindow::_UpdateStructureView()
 {
 	if (fStructureView) {
-		fStructureView->SetSVGImage(fSVGView->SVGImage());
+		fStructureView->SetDocument(fDocument.Get());
 	}
 }
 
@@ -1702,7 +2012,7 @@ SVGMainWindow::_UpdateInterface()
 void
 SVGMainWindow::_UpdateStatView()
 {
-	fStatView->SetSVGImage(fSVGView->SVGImage());
+	fStatView->SetDocument(fDocument.Get());
 	fStatView->SetIntValue("svg-size", fCurrentSource.Length());
 	fStatView->SetIntValue("hvif-size", fCurrentHVIFSize);
 	_UpdateStructureView();
@@ -1841,6 +2151,12 @@ SVGMainWindow::_UpdateToggleButtonStates()
 	if (fEditToolBar && fSVGTextView) {
 		bool wordWrapEnabled = fSVGTextView->DoesWordWrap();
 		_SetToolBarButtonPressed(fEditToolBar, MSG_EDIT_WORD_WRAP, wordWrapEnabled);
+		_SetToolBarButtonPressed(fEditToolBar, MSG_SEARCH_MATCH_CASE,
+			(fSearchFlags & SEARCH_IGNORE_CASE) == 0);
+		_SetToolBarButtonPressed(fEditToolBar, MSG_SEARCH_WHOLE_WORD,
+			(fSearchFlags & SEARCH_WHOLE_WORD) != 0);
+		_SetToolBarButtonPressed(fEditToolBar, MSG_SEARCH_REGEX,
+			(fSearchFlags & SEARCH_REGEX) != 0);
 	}
 }
 
@@ -1858,7 +2174,7 @@ SVGMainWindow::_CalculateCurrentUIState() const
 	if (_HasUnAppliedEditorChanges())
 		state |= UI_STATE_HAS_UNAPPLIED_CHANGES;
 
-	if (fCurrentHVIFData && fCurrentHVIFSize > 0)
+	if (_HasHVIFData())
 		state |= UI_STATE_HAS_HVIF_DATA;
 
 	if (fSplitView && !fSplitView->IsItemCollapsed(1))
@@ -1966,18 +2282,20 @@ SVGMainWindow::_FindMenuItem(BMenu* menu, uint32 command)
 	return NULL;
 }
 
+// The UI state follows events rather than being polled: the clipboard
+// reports its changes, the editors post MSG_TEXT_MODIFIED and
+// MSG_SELECTION_CHANGED.
 void
 SVGMainWindow::_StartStateMonitoring()
 {
-	BMessage updateMsg(MSG_STATE_UPDATE);
-	fStateUpdateRunner = new BMessageRunner(BMessenger(this), &updateMsg, 500000, -1);
+	be_clipboard->StartWatching(BMessenger(this));
+	_CheckClipboardState();
 }
 
 void
 SVGMainWindow::_StopStateMonitoring()
 {
-	delete fStateUpdateRunner;
-	fStateUpdateRunner = NULL;
+	be_clipboard->StopWatching(BMessenger(this));
 }
 
 void
@@ -2014,6 +2332,9 @@ SVGMainWindow::_CheckTextSelectionState()
 void
 SVGMainWindow::_OnTextModified()
 {
+	// typing over a selection removes it without a selection event
+	_CheckTextSelectionState();
+	_UpdateSearchMatches();
 	_UpdateUIState();
 }
 
@@ -2132,14 +2453,26 @@ SVGMainWindow::_RestoreSettings()
 	_UpdateUIState();
 }
 
+// The editor text is only compared with the applied source after one of
+// them changed: the editor bumps its revision on every edit, and the
+// window bumps fSourceRevision whenever it assigns fCurrentSource.
 bool
 SVGMainWindow::_HasUnAppliedEditorChanges() const
 {
 	if (!fSVGTextView || fSplitView->IsItemCollapsed(1))
 		return false;
 
-	BString editorText = fSVGTextView->Text();
-	return (editorText != fCurrentSource);
+	if (fSVGTextView->Revision() != fCheckedRevision
+		|| fSourceRevision != fCheckedSourceRevision) {
+		fCheckedRevision = fSVGTextView->Revision();
+		fCheckedSourceRevision = fSourceRevision;
+
+		int32 length = fCurrentSource.Length();
+		fHasUnappliedChanges = fSVGTextView->TextLength() != length
+			|| memcmp(fSVGTextView->Text(), fCurrentSource.String(), length) != 0;
+	}
+
+	return fHasUnappliedChanges;
 }
 
 BString
@@ -2246,15 +2579,15 @@ SVGMainWindow::_RestoreBackupState()
 	}
 
 	fCurrentSource = fBackupSource;
+	fSourceRevision++;
 	fCurrentFilePath = fBackupFilePath;
 	fOriginalSourceText = fBackupOriginalSourceText;
 	fDocumentModified = fBackupDocumentModified;
 	SetTitle(fBackupWindowTitle.String());
 
-	if (fSVGView) {
-		fSVGView->LoadFromMemory(fCurrentSource.String());
+	_SetDocumentSource(fCurrentSource);
+	if (fSVGView)
 		fSVGView->ResetView();
-	}
 
 	_GenerateHVIFFromSVG();
 
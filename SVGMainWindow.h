@@ -19,8 +19,10 @@
 #include <Menu.h>
 #include <MessageRunner.h>
 #include <NumberFormat.h>
+#include <Referenceable.h>
 
 #include "SVGConstants.h"
+#include "SVGDocument.h"
 #include "SVGStatView.h"
 #include "SVGStructureView.h"
 #include "BSVGView.h"
@@ -32,6 +34,7 @@ class SVGMenuManager;
 class SVGFileManager;
 class SVGToolBar;
 class SVGVectorizationWorker;
+class SVGConversionWorker;
 class SVGVectorizationDialog;
 
 class BMenuBar;
@@ -79,13 +82,17 @@ private:
 	void _HandleVectorizationMessages(BMessage* message);
 	void _HandleSelectionMessages(BMessage *message);
 	void _HandleSearchMessages(BMessage* message);
+	void _HandleReplaceMessages(BMessage* message);
+	SVGTextEdit* _SearchTargetEditor() const;
+	void _UpdateSearchMatches();
 	void _HandleClipboardCopyMessages(BMessage* message);
 	void _HandleIconDataReady(BMessage* message);
+	void _HandleConversionResult(BMessage* message);
+	void _DrainWorkerResults();
 
 	// Clipboard
 	void _CopyToClipboard(const char* text);
 	void _CopyBitmapToClipboard(BBitmap* bitmap);
-	BString _EncodeBase64(const BString& input);
 
 	// Tools handlers
 	void _HandleOpenInIconOMatic();
@@ -104,11 +111,19 @@ private:
 
 	// Data generation
 	void _GenerateHVIFFromSVG();
+	bool _SetDocumentSource(const BString& source);
+	void _SetDocument(SVGDocument* document);
 
 	// Tab management
 	void _UpdateAllTabs();
 	void _UpdateRDefTab();
 	void _UpdateCPPTab();
+	void _InvalidateCodeTabs();
+	void _UpdateCodeTabs();
+	bool _IsCodeTabVisible() const;
+	bool _HasHVIFData() const;
+	const BString& _RDefText();
+	const BString& _CPPText();
 	void _HandleTabSelection();
 
 	// View management
@@ -190,11 +205,14 @@ private:
 	SVGToolBar*      fToolBar;
 	SVGToolBar*      fEditToolBar;
 	BTextControl*    fSearchControl;
+	BStringView*     fSearchCountView;
+	uint32           fSearchFlags;
 	SVGStatView*     fStatView;
 	SVGStructureView* fStructureView;
 
 	// Document state
 	BString          fCurrentSource;
+	BReference<SVGDocument> fDocument;
 	BString          fCurrentFilePath;
 	BString          fOriginalSourceText;
 	bool             fDocumentModified;
@@ -210,9 +228,13 @@ private:
 	uint32           fCurrentUIState;
 
 	// State monitoring
-	BMessageRunner*  fStateUpdateRunner;
 	bool             fClipboardHasData;
 	bool             fTextHasSelection;
+	// Bumped whenever fCurrentSource is assigned
+	uint32           fSourceRevision;
+	mutable uint32   fCheckedRevision;
+	mutable uint32   fCheckedSourceRevision;
+	mutable bool     fHasUnappliedChanges;
 
 	// Number formatting
 	BNumberFormat    fNumberFormat;
@@ -220,6 +242,13 @@ private:
 	// HVIF data for export
 	unsigned char*   fCurrentHVIFData;
 	size_t           fCurrentHVIFSize;
+	BString          fCurrentRDefText;
+	BString          fCurrentCPPText;
+	bool             fRDefTabValid;
+	bool             fCPPTabValid;
+	// The HVIF data is from an older source while a conversion runs
+	bool             fHVIFPending;
+	SVGConversionWorker* fConversionWorker;
 
 	// Vectorization
 	SVGVectorizationWorker* fVectorizationWorker;
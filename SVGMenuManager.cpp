@@ -192,6 +192,8 @@ SVGMenuManager::_CreateToolsMenu(BHandler* target)
 	fOpenInIconOMaticItem = new BMenuItem(B_TRANSLATE("Icon-O-Matic" B_UTF8_ELLIPSIS), new BMessage(MSG_OPEN_IN_ICON_O_MATIC));
 	fOpenInIconOMaticItem->SetEnabled(false);
 	fToolsMenu->AddItem(fOpenInIconOMaticItem);
+	fToolsMenu->AddSeparatorItem();
+	fToolsMenu->AddItem(new BMenuItem(B_TRANSLATE("Replace all" B_UTF8_ELLIPSIS), new BMessage(MSG_REPLACE_ALL)));
 
 	fToolsMenu->SetTargetForItems(target);
 	fMenuBar->AddItem(fToolsMenu);
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <Message.h>
+#include <MessageQueue.h>
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "SVGConstants.h"
+#include "SVGSearchWorker.h"
+#include "SVGTextBuffer.h"
+#include "SVGTextSearch.h"
+#include "SVGTextSnapshot.h"
+
+static const int32 kMatchBatchSize = 4096;
+
+SVGSearchWorker::SVGSearchWorker()
+	: BLooper("text_search_worker", B_LOW_PRIORITY),
+	fFindGeneration(0),
+	fReplaceGeneration(0),
+	fShutdown(false)
+{
+	Run();
+}
+
+SVGSearchWorker::~SVGSearchWorker()
+{
+	BMessage* request;
+	while ((request = MessageQueue()->NextMessage()) != NULL) {
+		_ReleaseRequest(request);
+		delete request;
+	}
+}
+
+void
+SVGSearchWorker::Shutdown()
+{
+	fShutdown = true;
+	atomic_add(&fFindGeneration, 1);
+	atomic_add(&fReplaceGeneration, 1);
+
+	if (Lock())
+		Quit();
+}
+
+int32
+SVGSearchWorker::RequestFind(SVGTextSnapshot* snapshot, const char* pattern,
+	uint32 flags, BMessenger target)
+{
+	return _Request(snapshot, pattern, flags, NULL, target);
+}
+
+int32
+SVGSearchWorker::RequestReplace(SVGTextSnapshot* snapshot, const char* pattern,
+	uint32 flags, const char* replacement, BMessenger target)
+{
+	return _Request(snapshot, pattern, flags, replacement != NULL ? replacement : "",
+		target);
+}
+
+void
+SVGSearchWorker::CancelFind()
+{
+	atomic_add(&fFindGeneration, 1);
+}
+
+void
+SVGSearchWorker::CancelReplace()
+{
+	atomic_add(&fReplaceGeneration, 1);
+}
+
+bool
+SVGSearchWorker::IsCurrent(int32 generation, bool replace) const
+{
+	const vint32* current = replace ? &fReplaceGeneration : &fFindGeneration;
+	return generation == atomic_get(const_cast<vint32*>(current));
+}
+
+void
+SVGSearchWorker::MessageReceived(BMessage* message)
+{
+	switch (message->what) {
+		case MSG_TEXT_SEARCH_REQUEST:
+			_Search(message);
+			_ReleaseRequest(message);
+			break;
+
+		default:
+			BLooper::MessageReceived(message);
+			break;
+	}
+}
+
+int32
+SVGSearchWorker::_Request(SVGTextSnapshot* snapshot, const char* pattern,
+	uint32 flags, const char* replacement, BMessenger target)
+{
+	bool replace = replacement != NULL;
+	int32 generation = atomic_add(replace ? &fReplaceGeneration : &fFindGeneration, 1) + 1;
+
+	if (fShutdown || snapshot == NULL || pattern == NULL)
+		return generation;
+
+	snapshot->AcquireReference();
+
+	BMessage request(MSG_TEXT_SEARCH_REQUEST);
+	request.AddPointer("snapshot", snapshot);
+	request.AddString("pattern", pattern);
+	request.AddInt32("flags", flags);
+	if (replace)
+		request.AddString("replacement", replacement);
+	request.AddInt32("generation", generation);
+	request.AddMessenger("target", target);
+
+	if (PostMessage(&request) != B_OK)
+		snapshot->ReleaseReference();
+
+	return generation;
+}
+
+void
+SVGSearchWorker::_Search(BMessage* request)
+{
+	SVGTextSnapshot* snapshot = NULL;
+	BMessenger target;
+	if (request->FindPointer("snapshot", (void**)&snapshot) != B_OK || snapshot == NULL
+		|| request->FindMessenger("target", &target) != B_OK) {
+		return;
+	}
+
+	const char* replacement = NULL;
+	bool replace = request->FindString("replacement", &replacement) == B_OK;
+	int32 generation = request->GetInt32("generation", 0);
+	if (fShutdown || !IsCurrent(generation, replace))
+		return;
+
+	BMessage reply(MSG_TEXT_SEARCH_RESULT);
+	reply.AddInt32("generation", generation);
+	reply.AddInt32("revision", snapshot->Revision());
+	reply.AddBool("replace", replace);
+
+	BMessage result(MSG_TEXT_REPLACE_RESULT);
+	result.AddInt32("generation", generation);
+	result.AddInt32("revision", snapshot->Revision());
+
+	SVGTextSearch search;
+	status_t status = search.SetTo(request->GetString("pattern", ""),
+		request->GetInt32("flags", 0));
+	const char* text = status == B_OK ? snapshot->Text() : NULL;
+	if (text == NULL) {
+		BMessage& failed = replace ? result : reply;
+		failed.AddString("error", status != B_OK ? search.ErrorString() : strerror(B_NO_MEMORY));
+		failed.AddBool("final", true);
+		target.SendMessage(&failed);
+		return;
+	}
+
+	int32 length = snapshot->Length();
+
+	// With a replacement the text from the first match to the end of the
+	// last one is rewritten as it goes.
+	std::vector<SVGSearchMatch> matches;
+	if (!replace)
+		matches.reserve(kMatchBatchSize);
+	std::string output;
+	int32 start = -1;
+	int32 end = 0;
+	int32 count = 0;
+
+	SVGSearchMatch match;
+	int32 position = 0;
+	while (position <= length && search.FindNext(text, length, position, &match)) {
+		if (replace) {
+			if (start < 0)
+				start = end = match.start;
+			output.append(text + end, match.start - end);
+			search.AppendReplacement(text, replacement, output);
+			end = match.start + match.length;
+		}
+
+		if (!replace)
+			matches.push_back(match);
+		count++;
+
+		position = match.start + match.length;
+		if (match.length == 0) {
+			// step over the whole character after an empty match
+			position++;
+			while (position < length && (text[position] & 0xc0) == 0x80)
+				position++;
+		}
+
+		if (count % kMatchBatchSize == 0) {
+			if (fShutdown || !IsCurrent(generation, replace))
+				return;
+			if (!_SendMatches(target, reply, matches.empty() ? NULL : &matches[0],
+					matches.size(), count, false)) {
+				return;
+			}
+			matches.clear();
+		}
+	}
+
+	if (fShutdown || !IsCurrent(generation, replace))
+		return;
+
+	if (!_SendMatches(target, reply, matches.empty() ? NULL : &matches[0],
+			matches.size(), count, true) || !replace) {
+		return;
+	}
+
+	SVGTextBlock* block = NULL;
+	if (!output.empty()) {
+		block = new SVGTextBlock(output.size());
+		if (block->Append(output.data(), output.size()) < 0) {
+			block->ReleaseReference();
+			result.AddString("error", strerror(B_NO_MEMORY));
+			target.SendMessage(&result);
+			return;
+		}
+	}
+
+	// the block goes with its initial reference, which the target adopts
+	result.AddInt32("count", count);
+	result.AddInt32("start", start < 0 ? 0 : start);
+	result.AddInt32("end", end);
+	result.AddInt32("length", output.size());
+	result.AddPointer("block", block);
+
+	if (target.SendMessage(&result) != B_OK && block != NULL)
+		block->ReleaseReference();
+}
+
+bool
+SVGSearchWorker::_SendMatches(BMessenger& target, BMessage& reply,
+	const void* matches, int32 count, int32 found, bool final)
+{
+	reply.RemoveName("matches");
+	reply.RemoveName("count");
+	reply.RemoveName("final");
+
+	if (count > 0)
+		reply.AddData("matches", B_RAW_TYPE, matches, count * sizeof(SVGSearchMatch));
+	reply.AddInt32("count", found);
+	reply.AddBool("final", final);
+
+	return target.SendMessage(&reply) == B_OK;
+}
+
+void
+SVGSearchWorker::_ReleaseRequest(BMessage* request)
+{
+	if (request->what != MSG_TEXT_SEARCH_REQUEST)
+		return;
+
+	SVGTextSnapshot* snapshot = NULL;
+	if (request->FindPointer("snapshot", (void**)&snapshot) == B_OK && snapshot != NULL)
+		snapshot->ReleaseReference();
+}
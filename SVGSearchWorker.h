@@ -0,0 +1,59 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_SEARCH_WORKER_H
+#define SVG_SEARCH_WORKER_H
+
+#include <Looper.h>
+#include <Messenger.h>
+#include <String.h>
+#include <SupportDefs.h>
+
+class SVGTextSnapshot;
+
+// Runs searches and replace-alls over text snapshots off the window thread.
+//
+// Matches go back to the target in MSG_TEXT_SEARCH_RESULT batches of
+// SVGSearchMatch ("matches"), the last one flagged "final"; each also has
+// the "count" found so far. A replace only reports that count while it
+// runs, and ends with MSG_TEXT_REPLACE_RESULT: the text from the first match to the
+// end of the last one is rewritten as a whole and sent as one block
+// ("block" pointer with a reference the receiver takes over, "start",
+// "end", "length" and "count"), so the editor can apply it as a single
+// edit. Every reply carries the "generation" of its request and the
+// "revision" of the snapshot; find and replace requests have their own
+// generations, and a newer request of the same kind stops an older one
+// at the next batch.
+class SVGSearchWorker : public BLooper {
+public:
+	SVGSearchWorker();
+	virtual ~SVGSearchWorker();
+
+	virtual void MessageReceived(BMessage* message);
+
+	int32 RequestFind(SVGTextSnapshot* snapshot, const char* pattern,
+				uint32 flags, BMessenger target);
+	int32 RequestReplace(SVGTextSnapshot* snapshot, const char* pattern,
+				uint32 flags, const char* replacement, BMessenger target);
+	void CancelFind();
+	void CancelReplace();
+	bool IsCurrent(int32 generation, bool replace = false) const;
+	void Shutdown();
+
+private:
+	int32 _Request(SVGTextSnapshot* snapshot, const char* pattern,
+				uint32 flags, const char* replacement, BMessenger target);
+	void _Search(BMessage* request);
+	bool _SendMatches(BMessenger& target, BMessage& reply,
+				const void* matches, int32 count, int32 found, bool final);
+	void _ReleaseRequest(BMessage* request);
+
+private:
+	vint32			fFindGeneration;
+	vint32			fReplaceGeneration;
+	volatile bool	fShutdown;
+};
+
+#endif
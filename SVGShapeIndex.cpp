@@ -0,0 +1,315 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <algorithm>
+#include <math.h>
+
+#include "nanosvg.h"
+
+#include "SVGShapeIndex.h"
+
+static const int32 kLeafSize = 4;
+
+// Splitting at the median keeps the depth near log2 of the shape count.
+static const int32 kMaxDepth = 64;
+
+// Lines a curve is flattened into for hit-testing at most.
+static const int32 kMaxCurveSteps = 16;
+
+static inline bool
+_Overlaps(const float* a, const float* b)
+{
+	return a[0] <= b[2] && b[0] <= a[2] && a[1] <= b[3] && b[1] <= a[3];
+}
+
+// Winding of the edge from a to b around point, for a ray towards +x.
+static inline int32
+_Winding(float ax, float ay, float bx, float by, float x, float y)
+{
+	float side = (bx - ax) * (y - ay) - (x - ax) * (by - ay);
+	if (ay <= y) {
+		if (by > y && side > 0)
+			return 1;
+	} else if (by <= y && side < 0)
+		return -1;
+
+	return 0;
+}
+
+static inline float
+_SquaredDistance(float ax, float ay, float bx, float by, float x, float y)
+{
+	float dx = bx - ax;
+	float dy = by - ay;
+	float length = dx * dx + dy * dy;
+	float t = length > 0 ? ((x - ax) * dx + (y - ay) * dy) / length : 0;
+	t = std::max(0.0f, std::min(1.0f, t));
+
+	float px = ax + t * dx - x;
+	float py = ay + t * dy - y;
+	return px * px + py * py;
+}
+
+// Flattens the cubic curves of the paths that can matter and sums up
+// their winding around the point; a fill is closed implicitly. An edge
+// within reach is a hit right away.
+static bool
+_HitsShape(const NSVGshape* shape, float x, float y, float tolerance)
+{
+	if ((shape->flags & NSVG_FLAGS_VISIBLE) == 0)
+		return false;
+
+	bool fill = shape->fill.type != NSVG_PAINT_NONE;
+	bool stroke = shape->stroke.type != NSVG_PAINT_NONE;
+	float reach = tolerance + (stroke ? shape->strokeWidth * 0.5f : 0);
+	float squaredReach = reach * reach;
+	float flatness = std::max(reach, 0.01f);
+
+	int32 winding = 0;
+	for (const NSVGpath* path = shape->paths; path != NULL; path = path->next) {
+		if (path->npts < 1)
+			continue;
+
+		const float* bounds = path->bounds;
+		bool near = (stroke || tolerance > 0) && x >= bounds[0] - reach
+			&& x <= bounds[2] + reach && y >= bounds[1] - reach && y <= bounds[3] + reach;
+		bool crosses = fill && y >= bounds[1] && y <= bounds[3] && x <= bounds[2];
+		if (!near && !crosses)
+			continue;
+
+		float lastX = path->pts[0];
+		float lastY = path->pts[1];
+		for (int32 i = 0; i + 3 < path->npts; i += 3) {
+			const float* p = &path->pts[i * 2];
+			float length = hypotf(p[2] - p[0], p[3] - p[1])
+				+ hypotf(p[4] - p[2], p[5] - p[3]) + hypotf(p[6] - p[4], p[7] - p[5]);
+			int32 steps = std::max(1, std::min(kMaxCurveSteps,
+				(int32)ceilf(length / (flatness * 4))));
+
+			for (int32 step = 1; step <= steps; step++) {
+				float t = (float)step / steps;
+				float u = 1 - t;
+				float a = u * u * u, b = 3 * u * u * t, c = 3 * u * t * t, d = t * t * t;
+				float px = a * p[0] + b * p[2] + c * p[4] + d * p[6];
+				float py = a * p[1] + b * p[3] + c * p[5] + d * p[7];
+
+				if (near && _SquaredDistance(lastX, lastY, px, py, x, y) <= squaredReach)
+					return true;
+				if (crosses)
+					winding += _Winding(lastX, lastY, px, py, x, y);
+
+				lastX = px;
+				lastY = py;
+			}
+		}
+
+		if (crosses)
+			winding += _Winding(lastX, lastY, path->pts[0], path->pts[1], x, y);
+	}
+
+	if (!fill)
+		return false;
+
+	if (shape->fillRule == NSVG_FILLRULE_EVENODD)
+		return (winding & 1) != 0;
+
+	return winding != 0;
+}
+
+// Far enough out for any join or cap; a miter can reach miterLimit times
+// half the stroke width past the outline.
+static float
+_StrokeMargin(const NSVGshape* shape)
+{
+	if (shape->stroke.type == NSVG_PAINT_NONE)
+		return 0;
+
+	float factor = 1.5f;
+	if (shape->strokeLineJoin == NSVG_JOIN_MITER)
+		factor = std::max(shape->miterLimit, factor);
+
+	return shape->strokeWidth * 0.5f * factor;
+}
+
+SVGShapeIndex::SVGShapeIndex(NSVGimage* image)
+{
+	if (image == NULL)
+		return;
+
+	for (NSVGshape* shape = image->shapes; shape != NULL; shape = shape->next) {
+		float margin = _StrokeMargin(shape);
+		fShapes.push_back(shape);
+		fBounds.push_back(shape->bounds[0] - margin);
+		fBounds.push_back(shape->bounds[1] - margin);
+		fBounds.push_back(shape->bounds[2] + margin);
+		fBounds.push_back(shape->bounds[3] + margin);
+	}
+
+	if (fShapes.empty())
+		return;
+
+	fOrder.resize(fShapes.size());
+	for (size_t i = 0; i < fOrder.size(); i++)
+		fOrder[i] = i;
+
+	fNodes.reserve(fShapes.size() * 2 / kLeafSize + 1);
+	fNodes.resize(1);
+	_Build(0, 0, fOrder.size());
+}
+
+SVGShapeIndex::~SVGShapeIndex()
+{
+}
+
+NSVGshape*
+SVGShapeIndex::ShapeAt(int32 index) const
+{
+	if (index < 0 || index >= CountShapes())
+		return NULL;
+
+	return fShapes[index];
+}
+
+BRect
+SVGShapeIndex::ShapeBounds(int32 index) const
+{
+	if (index < 0 || index >= CountShapes())
+		return BRect();
+
+	const float* bounds = &fBounds[index * 4];
+	return BRect(bounds[0], bounds[1], bounds[2], bounds[3]);
+}
+
+void
+SVGShapeIndex::FindShapes(BRect rect, std::vector<int32>& shapes) const
+{
+	float area[4] = { rect.left, rect.top, rect.right, rect.bottom };
+	_Find(area, shapes);
+}
+
+void
+SVGShapeIndex::FindShapes(BPoint point, std::vector<int32>& shapes) const
+{
+	float area[4] = { point.x, point.y, point.x, point.y };
+	_Find(area, shapes);
+}
+
+int32
+SVGShapeIndex::FindPath(int32 shapeIndex, BPoint point, float tolerance) const
+{
+	NSVGshape* shape = ShapeAt(shapeIndex);
+	if (shape == NULL)
+		return -1;
+
+	tolerance += _StrokeMargin(shape);
+	float area[4] = { point.x - tolerance, point.y - tolerance,
+		point.x + tolerance, point.y + tolerance };
+
+	int32 found = -1;
+	int32 pathIndex = 0;
+	for (NSVGpath* path = shape->paths; path != NULL; path = path->next) {
+		if (_Overlaps(path->bounds, area))
+			found = pathIndex;
+		pathIndex++;
+	}
+
+	return found;
+}
+
+int32
+SVGShapeIndex::HitTest(BPoint point, float tolerance) const
+{
+	std::vector<int32> candidates;
+	FindShapes(BRect(point.x - tolerance, point.y - tolerance,
+		point.x + tolerance, point.y + tolerance), candidates);
+
+	for (int32 i = candidates.size() - 1; i >= 0; i--) {
+		if (_HitsShape(fShapes[candidates[i]], point.x, point.y, tolerance))
+			return candidates[i];
+	}
+
+	return -1;
+}
+
+// Splits at the median of the shape centers along the longer side of
+// their extent, which keeps the tree balanced for any distribution.
+void
+SVGShapeIndex::_Build(int32 node, int32 begin, int32 end)
+{
+	float bounds[4] = { fBounds[fOrder[begin] * 4], fBounds[fOrder[begin] * 4 + 1],
+		fBounds[fOrder[begin] * 4 + 2], fBounds[fOrder[begin] * 4 + 3] };
+	float centers[4] = { bounds[0] + bounds[2], bounds[1] + bounds[3],
+		bounds[0] + bounds[2], bounds[1] + bounds[3] };
+
+	for (int32 i = begin + 1; i < end; i++) {
+		const float* shape = &fBounds[fOrder[i] * 4];
+		bounds[0] = std::min(bounds[0], shape[0]);
+		bounds[1] = std::min(bounds[1], shape[1]);
+		bounds[2] = std::max(bounds[2], shape[2]);
+		bounds[3] = std::max(bounds[3], shape[3]);
+
+		float centerX = shape[0] + shape[2];
+		float centerY = shape[1] + shape[3];
+		centers[0] = std::min(centers[0], centerX);
+		centers[1] = std::min(centers[1], centerY);
+		centers[2] = std::max(centers[2], centerX);
+		centers[3] = std::max(centers[3], centerY);
+	}
+
+	std::copy(bounds, bounds + 4, fNodes[node].bounds);
+	if (end - begin <= kLeafSize) {
+		fNodes[node].first = begin;
+		fNodes[node].count = end - begin;
+		return;
+	}
+
+	int32 axis = centers[2] - centers[0] >= centers[3] - centers[1] ? 0 : 1;
+	const float* shapeBounds = &fBounds[0];
+	int32 middle = begin + (end - begin) / 2;
+	std::nth_element(fOrder.begin() + begin, fOrder.begin() + middle,
+		fOrder.begin() + end, [shapeBounds, axis](int32 a, int32 b) {
+			return shapeBounds[a * 4 + axis] + shapeBounds[a * 4 + axis + 2]
+				< shapeBounds[b * 4 + axis] + shapeBounds[b * 4 + axis + 2];
+		});
+
+	int32 children = fNodes.size();
+	fNodes.resize(children + 2);
+	fNodes[node].first = children;
+	fNodes[node].count = 0;
+
+	_Build(children, begin, middle);
+	_Build(children + 1, middle, end);
+}
+
+void
+SVGShapeIndex::_Find(const float* area, std::vector<int32>& shapes) const
+{
+	if (fNodes.empty())
+		return;
+
+	size_t firstFound = shapes.size();
+	int32 stack[kMaxDepth * 2];
+	int32 depth = 0;
+	stack[depth++] = 0;
+
+	while (depth > 0) {
+		const Node& node = fNodes[stack[--depth]];
+		if (!_Overlaps(node.bounds, area))
+			continue;
+
+		if (node.count == 0) {
+			stack[depth++] = node.first;
+			stack[depth++] = node.first + 1;
+			continue;
+		}
+
+		for (int32 i = node.first; i < node.first + node.count; i++) {
+			if (_Overlaps(&fBounds[fOrder[i] * 4], area))
+				shapes.push_back(fOrder[i]);
+		}
+	}
+
+	std::sort(shapes.begin() + firstFound, shapes.end());
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_SHAPE_INDEX_H
+#define SVG_SHAPE_INDEX_H
+
+#include <Point.h>
+#include <Rect.h>
+#include <SupportDefs.h>
+
+#include <vector>
+
+struct NSVGimage;
+struct NSVGshape;
+
+// Bounding volume hierarchy over the shapes of a parsed image, in image
+// coordinates. A shape's bounds are grown by its stroke, so everything it
+// paints is inside them. Shapes are numbered in drawing order, the same
+// way as the structure view and the highlight do, and every query returns
+// them in that order. Built once and only read afterwards, so any number
+// of threads can query it.
+class SVGShapeIndex {
+public:
+	SVGShapeIndex(NSVGimage* image);
+	~SVGShapeIndex();
+
+	int32 CountShapes() const { return fShapes.size(); }
+	NSVGshape* ShapeAt(int32 index) const;
+	BRect ShapeBounds(int32 index) const;
+
+	// Appends the shapes whose bounds intersect rect, or contain point.
+	void FindShapes(BRect rect, std::vector<int32>& shapes) const;
+	void FindShapes(BPoint point, std::vector<int32>& shapes) const;
+
+	// The last path of the shape whose bounds, grown by tolerance, contain
+	// point, or -1.
+	int32 FindPath(int32 shapeIndex, BPoint point, float tolerance = 0) const;
+
+	// The topmost visible shape that paints point, or comes within
+	// tolerance of its outline, or -1. Only the shapes whose bounds are
+	// that close get the exact test against their fill and stroke.
+	int32 HitTest(BPoint point, float tolerance = 0) const;
+
+private:
+	// A leaf holds count shapes from fOrder starting at first, any other
+	// node has its two children at first and first + 1.
+	struct Node {
+		float	bounds[4];
+		int32	first;
+		int32	count;
+	};
+
+	void _Build(int32 node, int32 begin, int32 end);
+	void _Find(const float* area, std::vector<int32>& shapes) const;
+
+	SVGShapeIndex(const SVGShapeIndex&);
+	SVGShapeIndex& operator=(const SVGShapeIndex&);
+
+private:
+	std::vector<NSVGshape*>	fShapes;
+	std::vector<float>		fBounds;
+	std::vector<int32>		fOrder;
+	std::vector<Node>		fNodes;
+};
+
+#endif
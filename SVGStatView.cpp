@@ -91,9 +91,10 @@ SVGStatView::Draw(BRect updateRect)
 }
 
 void
-SVGStatView::SetSVGImage(NSVGimage* image)
+SVGStatView::SetDocument(SVGDocument* document)
 {
-	svgImage = image;
+	svgDocument.SetTo(document);
+	svgImage = document ? document->Image() : NULL;
 	UpdateStatistics();
 }
 
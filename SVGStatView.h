@@ -14,6 +14,9 @@
 #include <SpaceLayoutItem.h>
 #include <ControlLook.h>
 #include <Font.h>
+#include <Referenceable.h>
+
+#include "SVGDocument.h"
 
 struct NSVGimage;
 
@@ -24,7 +27,7 @@ class SVGStatView : public BView {
 
 		virtual void Draw(BRect rect);
 
-		void SetSVGImage(NSVGimage* image);
+		void SetDocument(SVGDocument* document);
 		void SetFloatValue(const char *param, float value, bool exp = true);
 		void SetIntValue(const char *param, int value);
 		void SetTextValue(const char *param, const char *value);
@@ -39,6 +42,7 @@ class SVGStatView : public BView {
 		BFont font;
 		BNumberFormat fNumberFormat;
 		NSVGimage* svgImage;
+		BReference<SVGDocument> svgDocument;
 };
 
 #endif
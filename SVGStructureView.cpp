@@ -190,9 +190,16 @@ SVGStructureView::MessageReceived(BMessage* message)
 }
 
 void
-SVGStructureView::SetSVGImage(NSVGimage* image)
+SVGStructureView::SetDocument(SVGDocument* document)
 {
-	fSVGImage = image;
+	if (document == fDocument.Get())
+		return;
+
+	// List items point into the document's shapes, so the document has to
+	// stay referenced until they are rebuilt.
+	BReference<SVGDocument> oldDocument = fDocument;
+	fDocument.SetTo(document);
+	fSVGImage = document ? document->Image() : NULL;
 	UpdateStructure();
 }
 
@@ -17,7 +17,9 @@
 #include <ControlLook.h>
 #include <TabView.h>
 #include <Bitmap.h>
+#include <Referenceable.h>
 
+#include "SVGDocument.h"
 #include "SVGListItem.h"
 #include "SVGTextEdit.h"
 
@@ -36,7 +38,7 @@ public:
 	virtual void AttachedToWindow();
 	virtual void Hide();
 
-	void SetSVGImage(NSVGimage* image);
+	void SetDocument(SVGDocument* document);
 	void SetSVGView(SVGView* svgView) { fSVGView = svgView; }
 	void SetSVGTextEdit(SVGTextEdit *svgTextEdit) { fSVGTextEdit = svgTextEdit; }
 	void UpdateStructure();
@@ -73,6 +75,7 @@ private:
 	BScrollView* fPaintsScroll;
 
 	NSVGimage* fSVGImage;
+	BReference<SVGDocument> fDocument;
 	SVGView* fSVGView;
 	SVGTextEdit* fSVGTextEdit;
 	BFont fFont;
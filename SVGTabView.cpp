@@ -0,0 +1,25 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <Window.h>
+
+#include "SVGConstants.h"
+#include "SVGTabView.h"
+
+SVGTabView::SVGTabView(const char* name, button_width width)
+	: BTabView(name, width)
+{
+}
+
+void
+SVGTabView::Select(int32 index)
+{
+	int32 previous = Selection();
+
+	BTabView::Select(index);
+
+	if (index != previous && Window() != NULL)
+		Window()->PostMessage(MSG_TAB_SELECTION);
+}
@@ -0,0 +1,20 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_TAB_VIEW_H
+#define SVG_TAB_VIEW_H
+
+#include <TabView.h>
+
+// BTabView that tells its window (MSG_TAB_SELECTION) when another tab gets
+// selected, so tab contents can be filled in when they are first shown.
+class SVGTabView : public BTabView {
+public:
+	SVGTabView(const char* name, button_width width = B_WIDTH_FROM_WIDEST);
+
+	virtual void Select(int32 index);
+};
+
+#endif
@@ -0,0 +1,311 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "SVGTextBuffer.h"
+
+SVGTextBlock::SVGTextBlock(int32 capacity)
+	: fData(NULL),
+	fCapacity(0),
+	fLength(0)
+{
+	fData = (char*)malloc(capacity > 0 ? capacity : 1);
+	if (fData != NULL)
+		fCapacity = capacity;
+}
+
+SVGTextBlock::~SVGTextBlock()
+{
+	free(fData);
+}
+
+int32
+SVGTextBlock::Append(const char* text, int32 length)
+{
+	if (length > Available())
+		return -1;
+
+	int32 offset = fLength;
+	memcpy(fData + offset, text, length);
+	fLength += length;
+	return offset;
+}
+
+
+SVGTextBuffer::SVGTextBuffer()
+	: fLength(0),
+	fCursorIndex(0),
+	fCursorPosition(0),
+	fDeletedLength(0)
+{
+}
+
+status_t
+SVGTextBuffer::SetTo(const char* text, int32 length)
+{
+	fPieces.clear();
+	fAddBlock.Unset();
+	fLength = 0;
+	fCursorIndex = 0;
+	fCursorPosition = 0;
+	fDeletedLength = 0;
+
+	if (text == NULL || length <= 0)
+		return B_OK;
+
+	BReference<SVGTextBlock> block(new SVGTextBlock(length), true);
+	int32 offset = block->Append(text, length);
+	if (offset < 0)
+		return B_NO_MEMORY;
+
+	fPieces.push_back(SVGTextPiece(block.Get(), offset, length));
+	fLength = length;
+	return B_OK;
+}
+
+status_t
+SVGTextBuffer::Insert(int32 offset, const char* text, int32 length,
+	SVGPieceList* inserted)
+{
+	if (inserted != NULL)
+		inserted->clear();
+
+	if (offset < 0 || offset > fLength || length < 0 || (text == NULL && length > 0))
+		return B_BAD_VALUE;
+
+	if (length == 0)
+		return B_OK;
+
+	SVGPieceList pieces;
+	status_t status = _Store(text, length, pieces);
+	if (status != B_OK)
+		return status;
+
+	if (inserted != NULL)
+		*inserted = pieces;
+
+	return InsertPieces(offset, pieces);
+}
+
+status_t
+SVGTextBuffer::InsertPieces(int32 offset, const SVGPieceList& pieces)
+{
+	if (offset < 0 || offset > fLength)
+		return B_BAD_VALUE;
+
+	if (pieces.empty())
+		return B_OK;
+
+	int32 index = _Split(offset);
+
+	SVGPieceList joined;
+	if (index > 0) {
+		// continue the piece in front when the new text directly follows it
+		const SVGTextPiece& previous = fPieces[index - 1];
+		joined.push_back(previous);
+		AppendPieces(joined, pieces);
+		fPieces[index - 1] = joined[0];
+		joined.erase(joined.begin());
+	} else
+		AppendPieces(joined, pieces);
+
+	fPieces.insert(fPieces.begin() + index, joined.begin(), joined.end());
+
+	int32 length = PiecesLength(pieces);
+	fLength += length;
+	fCursorIndex = index + joined.size();
+	fCursorPosition = offset + length;
+
+	_CompactIfNeeded();
+	return B_OK;
+}
+
+status_t
+SVGTextBuffer::Delete(int32 start, int32 end, SVGPieceList* removed)
+{
+	if (removed != NULL)
+		removed->clear();
+
+	if (start < 0 || end > fLength || start > end)
+		return B_BAD_VALUE;
+
+	if (start == end)
+		return B_OK;
+
+	int32 first = _Split(start);
+	int32 last = _Split(end);
+
+	if (removed != NULL)
+		removed->assign(fPieces.begin() + first, fPieces.begin() + last);
+
+	fPieces.erase(fPieces.begin() + first, fPieces.begin() + last);
+	fLength -= end - start;
+	fDeletedLength += end - start;
+	fCursorIndex = first;
+	fCursorPosition = start;
+
+	_CompactIfNeeded();
+	return B_OK;
+}
+
+status_t
+SVGTextBuffer::DetachPieces(SVGPieceList& pieces)
+{
+	SVGPieceList detached;
+	for (size_t i = 0; i < pieces.size(); i++) {
+		const SVGTextPiece& piece = pieces[i];
+		int32 capacity = piece.block->Capacity();
+		if (capacity <= kBlockSize || piece.length > capacity / 4) {
+			AppendPieces(detached, SVGPieceList(1, piece));
+			continue;
+		}
+
+		SVGPieceList copy;
+		status_t status = _Store(piece.block->Data() + piece.offset, piece.length, copy);
+		if (status != B_OK)
+			return status;
+
+		AppendPieces(detached, copy);
+	}
+
+	pieces.swap(detached);
+	return B_OK;
+}
+
+void
+SVGTextBuffer::AppendPieces(SVGPieceList& list, const SVGPieceList& pieces)
+{
+	for (size_t i = 0; i < pieces.size(); i++) {
+		const SVGTextPiece& piece = pieces[i];
+		if (piece.length <= 0)
+			continue;
+
+		if (!list.empty()) {
+			SVGTextPiece& last = list.back();
+			if (last.block.Get() == piece.block.Get()
+				&& last.offset + last.length == piece.offset) {
+				last.length += piece.length;
+				continue;
+			}
+		}
+
+		list.push_back(piece);
+	}
+}
+
+int32
+SVGTextBuffer::PiecesLength(const SVGPieceList& pieces)
+{
+	int32 length = 0;
+	for (size_t i = 0; i < pieces.size(); i++)
+		length += pieces[i].length;
+	return length;
+}
+
+void
+SVGTextBuffer::CopyPieces(const SVGPieceList& pieces, char* output)
+{
+	for (size_t i = 0; i < pieces.size(); i++) {
+		const SVGTextPiece& piece = pieces[i];
+		memcpy(output, piece.block->Data() + piece.offset, piece.length);
+		output += piece.length;
+	}
+}
+
+// Copies text into a block and returns the piece it became. Typing keeps
+// appending to the same block, so consecutive characters end up in one
+// piece. Large texts get a block of their own.
+status_t
+SVGTextBuffer::_Store(const char* text, int32 length, SVGPieceList& pieces)
+{
+	BReference<SVGTextBlock> block = fAddBlock;
+	int32 blockOffset = block.Get() != NULL ? block->Append(text, length) : -1;
+	if (blockOffset < 0) {
+		if (length >= kBlockSize / 2) {
+			block.SetTo(new SVGTextBlock(length), true);
+		} else {
+			block.SetTo(new SVGTextBlock(kBlockSize), true);
+			fAddBlock = block;
+		}
+
+		blockOffset = block->Append(text, length);
+		if (blockOffset < 0)
+			return B_NO_MEMORY;
+	}
+
+	pieces.clear();
+	pieces.push_back(SVGTextPiece(block.Get(), blockOffset, length));
+	return B_OK;
+}
+
+// Makes sure a piece starts at offset and returns its index, or the number
+// of pieces when offset is the end of the text. The search walks from the
+// cursor, so edits close to each other do not scan the whole list.
+int32
+SVGTextBuffer::_Split(int32 offset)
+{
+	int32 count = fPieces.size();
+	int32 index = fCursorIndex;
+	int32 position = fCursorPosition;
+	if (index > count) {
+		index = 0;
+		position = 0;
+	}
+
+	while (index > 0 && position > offset)
+		position -= fPieces[--index].length;
+	while (index < count && position + fPieces[index].length <= offset)
+		position += fPieces[index++].length;
+
+	fCursorIndex = index;
+	fCursorPosition = position;
+	if (index == count || position == offset)
+		return index;
+
+	SVGTextPiece& piece = fPieces[index];
+	int32 head = offset - position;
+	SVGTextPiece tail(piece.block.Get(), piece.offset + head, piece.length - head);
+	piece.length = head;
+	fPieces.insert(fPieces.begin() + index + 1, tail);
+
+	fCursorIndex = index + 1;
+	fCursorPosition = offset;
+	return index + 1;
+}
+
+// Copies the text into a block of its own once the list got long enough to
+// make edits slow, or once most of what the blocks hold has been deleted.
+// The old blocks go away as soon as undo and snapshots let go of them.
+void
+SVGTextBuffer::_CompactIfNeeded()
+{
+	if ((int32)fPieces.size() <= kMaxPieces
+		&& fDeletedLength <= max_c(fLength, kBlockSize)) {
+		return;
+	}
+
+	BReference<SVGTextBlock> block;
+	if (fLength > 0) {
+		block.SetTo(new SVGTextBlock(fLength), true);
+		if (block->Available() < fLength)
+			return;
+
+		for (size_t i = 0; i < fPieces.size(); i++) {
+			const SVGTextPiece& piece = fPieces[i];
+			block->Append(piece.block->Data() + piece.offset, piece.length);
+		}
+	}
+
+	fPieces.clear();
+	if (block.Get() != NULL)
+		fPieces.push_back(SVGTextPiece(block.Get(), 0, fLength));
+
+	fAddBlock.Unset();
+	fCursorIndex = 0;
+	fCursorPosition = 0;
+	fDeletedLength = 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_TEXT_BUFFER_H
+#define SVG_TEXT_BUFFER_H
+
+#include <Referenceable.h>
+#include <SupportDefs.h>
+
+#include <vector>
+
+// Storage for text that was once part of the document. Bytes are only ever
+// appended, never changed or moved, so a piece stays valid for as long as
+// it holds a reference to its block, even while the block keeps growing.
+class SVGTextBlock : public BReferenceable {
+public:
+	SVGTextBlock(int32 capacity);
+	virtual ~SVGTextBlock();
+
+	const char* Data() const { return fData; }
+	int32 Length() const { return fLength; }
+	int32 Capacity() const { return fCapacity; }
+	int32 Available() const { return fCapacity - fLength; }
+
+	// Returns the offset of the appended bytes, or -1 without space.
+	int32 Append(const char* text, int32 length);
+
+private:
+	char* fData;
+	int32 fCapacity;
+	int32 fLength;
+};
+
+struct SVGTextPiece {
+	BReference<SVGTextBlock> block;
+	int32 offset;
+	int32 length;
+
+	SVGTextPiece(SVGTextBlock* b, int32 o, int32 l)
+		: block(b), offset(o), length(l) {}
+};
+
+typedef std::vector<SVGTextPiece> SVGPieceList;
+
+// Piece table mirroring the editor text. An edit only rearranges the piece
+// list; inserted text is appended to a shared block once and deleted text
+// stays where it is, so undo can keep the pieces instead of copies of the
+// text, and a snapshot is a copy of the piece list.
+class SVGTextBuffer {
+public:
+	SVGTextBuffer();
+
+	int32 Length() const { return fLength; }
+	int32 CountPieces() const { return fPieces.size(); }
+
+	status_t SetTo(const char* text, int32 length);
+	status_t Insert(int32 offset, const char* text, int32 length,
+				SVGPieceList* inserted = NULL);
+	status_t InsertPieces(int32 offset, const SVGPieceList& pieces);
+	status_t Delete(int32 start, int32 end, SVGPieceList* removed = NULL);
+
+	void GetPieces(SVGPieceList& pieces) const { pieces = fPieces; }
+	// Copies the pieces that are small against a large block they are in,
+	// so that keeping them, as undo does, does not keep the block alive.
+	status_t DetachPieces(SVGPieceList& pieces);
+
+	// Appends to a list, joining pieces that continue each other.
+	static void AppendPieces(SVGPieceList& list, const SVGPieceList& pieces);
+	static int32 PiecesLength(const SVGPieceList& pieces);
+	// Writes PiecesLength() bytes, without terminator.
+	static void CopyPieces(const SVGPieceList& pieces, char* output);
+
+	static const int32 kBlockSize = 65536;
+	// More pieces than this, or more deleted bytes than the text has, and
+	// the text is copied into a single block.
+	static const int32 kMaxPieces = 4096;
+
+private:
+	status_t _Store(const char* text, int32 length, SVGPieceList& pieces);
+	int32 _Split(int32 offset);
+	void _CompactIfNeeded();
+
+	SVGPieceList fPieces;
+	BReference<SVGTextBlock> fAddBlock;
+	int32 fLength;
+	// Index and text offset of a piece next to the last edit, where the
+	// next lookup starts.
+	int32 fCursorIndex;
+	int32 fCursorPosition;
+	// Deleted since the last compaction; still held by the blocks.
+	int32 fDeletedLength;
+};
+
+#endif
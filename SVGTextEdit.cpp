@@ -7,6 +7,10 @@
 #include <string.h>
 #include <stdlib.h>
 #include <Clipboard.h>
+#include <MessageQueue.h>
+#include <Region.h>
+
+#include <algorithm>
 
 #include "SVGConstants.h"
 #include "SVGTextEdit.h"
@@ -16,26 +20,151 @@ UndoCommand::UndoCommand()
 	: type(CMD_INSERT_TEXT),
 	offset(0),
 	length(0),
-	text(NULL),
 	runs(NULL),
+	replacedLength(0),
+	replacedRuns(NULL),
 	selectionStart(0),
 	selectionEnd(0),
 	timestamp(0),
-	canMerge(true)
+	canMerge(true),
+	size(0)
 {
 }
 
 UndoCommand::~UndoCommand()
 {
-	free(text);
 	free(runs);
+	free(replacedRuns);
+}
+
+static bool
+_CompareRangeStart(const HighlightRange& a, const HighlightRange& b)
+{
+	return a.start < b.start;
+}
+
+static bool
+_MatchStartsBefore(const SVGSearchMatch& match, int32 offset)
+{
+	return match.start < offset;
+}
+
+static bool
+_MatchStartsAfter(int32 offset, const SVGSearchMatch& match)
+{
+	return offset < match.start;
+}
+
+static bool
+_MatchEndsBefore(const SVGSearchMatch& match, int32 offset)
+{
+	return match.start + match.length < offset;
+}
+
+static bool
+_MatchEndsAfter(int32 offset, const SVGSearchMatch& match)
+{
+	return offset < match.start + match.length;
+}
+
+static rgb_color
+_HighlightColor(highlight_type type, const ColorScheme& colors)
+{
+	switch (type) {
+		case HIGHLIGHT_KEYWORD:
+			return colors.keyword;
+		case HIGHLIGHT_STRING:
+			return colors.string;
+		case HIGHLIGHT_COMMENT:
+			return colors.comment;
+		case HIGHLIGHT_NUMBER:
+			return colors.number;
+		case HIGHLIGHT_OPERATOR:
+			return colors.operator_color;
+		case HIGHLIGHT_TAG:
+			return colors.tag;
+		case HIGHLIGHT_ATTRIBUTE:
+			return colors.attribute;
+		case HIGHLIGHT_PREPROCESSOR:
+			return colors.preprocessor;
+		default:
+			return colors.text;
+	}
+}
+
+HighlightPass::HighlightPass(int32 start, int32 convergeFrom,
+	const int32* oldCheckpoints, int32 oldCount)
+	: fStart(start),
+	fEnd(-1),
+	fLimit(INT32_MAX),
+	fComplete(false),
+	fConvergeFrom(convergeFrom),
+	fOldCheckpoints(oldCheckpoints),
+	fOldCount(oldCheckpoints != NULL ? oldCount : 0),
+	fOldIndex(0),
+	fNextCheckpoint(start),
+	fRecording(true)
+{
+}
+
+bool
+HighlightPass::AtTokenBoundary(int32 pos)
+{
+	if (pos >= fConvergeFrom) {
+		while (fOldIndex < fOldCount && fOldCheckpoints[fOldIndex] < pos)
+			fOldIndex++;
+
+		if (fOldIndex < fOldCount && fOldCheckpoints[fOldIndex] == pos) {
+			fEnd = pos;
+			fComplete = true;
+			return true;
+		}
+	}
+
+	// every chunk covers at least one token
+	if (pos >= fLimit && pos > fStart) {
+		fEnd = pos;
+		return true;
+	}
+
+	if (fRecording && pos >= fNextCheckpoint) {
+		fCheckpoints.push_back(pos);
+		fNextCheckpoint = pos + HIGHLIGHT_CHECKPOINT_INTERVAL;
+	}
+
+	return false;
+}
+
+void
+HighlightPass::Resume(int32 limit)
+{
+	fStart = Position();
+	fEnd = -1;
+	fLimit = limit;
+	fCheckpoints.clear();
+}
+
+void
+HighlightPass::Finish(int32 length)
+{
+	if (fEnd < 0) {
+		fEnd = length;
+		fComplete = true;
+	}
 }
 
 HighlightWorker::HighlightWorker()
 	: BLooper("highlight_worker"),
 	  fShutdown(false),
 	  fLastRequestTime(0),
-	  fWorkerThread(-1)
+	  fWorkerThread(-1),
+	  fActiveRequest(NULL),
+	  fActivePass(NULL),
+	  fActiveTimestamp(0),
+	  fViewportStart(0),
+	  fViewportEnd(0),
+	  fPreviewStart(0),
+	  fPreviewEnd(0)
 {
 	Run();
 	fWorkerThread = Thread();
@@ -44,6 +173,16 @@ HighlightWorker::HighlightWorker()
 HighlightWorker::~HighlightWorker()
 {
 	fShutdown = true;
+	_FinishActiveRequest();
+
+	// Requests that never reached the queue are still in the port, and
+	// each of them holds a reference to its snapshot.
+	BMessage* request;
+	while ((request = MessageQueue()->NextMessage()) != NULL
+		|| (request = MessageFromPort(0)) != NULL) {
+		_ReleaseRequest(request);
+		delete request;
+	}
 }
 
 bool
@@ -63,21 +202,45 @@ HighlightWorker::Shutdown()
 }
 
 void
-HighlightWorker::RequestHighlighting(const char* text, int32 length,
+HighlightWorker::RequestHighlighting(SVGTextSnapshot* snapshot,
 									syntax_type type, bigtime_t timestamp,
-									BMessenger target)
+									BMessenger target, int32 start,
+									int32 convergeFrom,
+									const int32* checkpoints,
+									int32 checkpointCount)
 {
-	if (fShutdown)
+	if (fShutdown || snapshot == NULL)
 		return;
 
+	snapshot->AcquireReference();
+
 	BMessage request(MSG_HIGHLIGHT_REQUEST);
-	request.AddString("text", text);
-	request.AddInt32("length", length);
+	request.AddPointer("snapshot", snapshot);
 	request.AddInt32("syntax_type", (int32)type);
 	request.AddInt64("timestamp", timestamp);
 	request.AddMessenger("target", target);
+	request.AddInt32("pass_start", start);
+	request.AddInt32("converge_from", convergeFrom);
+	if (checkpoints != NULL && checkpointCount > 0) {
+		request.AddData("checkpoints", B_RAW_TYPE, checkpoints,
+			checkpointCount * sizeof(int32));
+	}
 
-	PostMessage(&request);
+	if (PostMessage(&request) != B_OK)
+		snapshot->ReleaseReference();
+}
+
+void
+HighlightWorker::SetViewport(bigtime_t timestamp, int32 visibleStart, int32 visibleEnd)
+{
+	if (fShutdown)
+		return;
+
+	BMessage viewport(MSG_HIGHLIGHT_VIEWPORT);
+	viewport.AddInt64("timestamp", timestamp);
+	viewport.AddInt32("visible_start", visibleStart);
+	viewport.AddInt32("visible_end", visibleEnd);
+	PostMessage(&viewport);
 }
 
 void
@@ -94,12 +257,28 @@ HighlightWorker::CancelRequests(bigtime_t beforeTime)
 void
 HighlightWorker::MessageReceived(BMessage* message)
 {
-	if (fShutdown)
+	if (fShutdown) {
+		_ReleaseRequest(message);
 		return;
+	}
 
 	switch (message->what) {
 		case MSG_HIGHLIGHT_REQUEST:
-			_ProcessHighlighting(message);
+			if (!_ProcessHighlighting(message))
+				_ReleaseRequest(message);
+			break;
+
+		case MSG_HIGHLIGHT_CONTINUE:
+			if (message->GetInt64("timestamp", -1) == fActiveTimestamp)
+				_ContinueHighlighting();
+			break;
+
+		case MSG_HIGHLIGHT_VIEWPORT:
+			if (fActiveRequest != NULL
+				&& message->GetInt64("timestamp", -1) == fActiveTimestamp) {
+				fViewportStart = message->GetInt32("visible_start", 0);
+				fViewportEnd = message->GetInt32("visible_end", 0);
+			}
 			break;
 
 		case MSG_HIGHLIGHT_CANCEL:
@@ -109,6 +288,8 @@ HighlightWorker::MessageReceived(BMessage* message)
 					if (beforeTime > fLastRequestTime)
 						fLastRequestTime = beforeTime;
 				}
+				if (fActiveRequest != NULL && fActiveTimestamp < fLastRequestTime)
+					_FinishActiveRequest();
 			}
 			break;
 
@@ -123,42 +304,209 @@ HighlightWorker::MessageReceived(BMessage* message)
 	}
 }
 
-void
+// Returns true when the request became the active one and is kept, false
+// when the caller still has to release it.
+bool
 HighlightWorker::_ProcessHighlighting(BMessage* request)
 {
 	if (fShutdown)
-		return;
+		return false;
 
 	bigtime_t timestamp;
 	if (request->FindInt64("timestamp", &timestamp) != B_OK)
-		return;
+		return false;
 
 	if (timestamp < fLastRequestTime)
-		return;
+		return false;
 
 	fLastRequestTime = timestamp;
 
-	const char* text;
-	int32 length;
+	SVGTextSnapshot* snapshot = NULL;
 	int32 syntaxType;
-	BMessenger target;
 
-	if (request->FindString("text", &text) != B_OK ||
-	    request->FindInt32("length", &length) != B_OK ||
+	if (request->FindPointer("snapshot", (void**)&snapshot) != B_OK || snapshot == NULL ||
 	    request->FindInt32("syntax_type", &syntaxType) != B_OK ||
-	    request->FindMessenger("target", &target) != B_OK)
+	    !request->HasMessenger("target"))
+		return false;
+
+	int32 length = snapshot->Length();
+
+	int32 start = request->GetInt32("pass_start", 0);
+	int32 convergeFrom = request->GetInt32("converge_from", length);
+	if (start < 0 || start > length)
+		start = 0;
+
+	const void* checkpoints = NULL;
+	ssize_t checkpointsSize = 0;
+	if (request->FindData("checkpoints", B_RAW_TYPE, &checkpoints, &checkpointsSize) != B_OK)
+		checkpoints = NULL;
+
+	// A newer request replaces the one in progress. The message keeps the
+	// snapshot reference and the old checkpoints while the pass needs them.
+	_FinishActiveRequest();
+	fActiveRequest = DetachCurrentMessage();
+	fActiveTimestamp = timestamp;
+	fViewportStart = fViewportEnd = 0;
+	fPreviewStart = fPreviewEnd = 0;
+
+	// Only the SVG lexer resumes from checkpoints; the generated C++ and
+	// RDef code is small and always analyzed as a whole.
+	if ((syntax_type)syntaxType == SYNTAX_SVG_XML) {
+		fActivePass = new HighlightPass(start, convergeFrom, (const int32*)checkpoints,
+			checkpointsSize / sizeof(int32));
+	} else
+		fActivePass = new HighlightPass(0, length, NULL, 0);
+
+	// Go through the queue once, so a viewport posted right after the
+	// request is known before the first chunk is lexed.
+	BMessage next(MSG_HIGHLIGHT_CONTINUE);
+	next.AddInt64("timestamp", timestamp);
+	PostMessage(&next);
+	return true;
+}
+
+// Lexes one chunk of the active request and sends it back as a partial
+// result. Between chunks the worker returns to its message loop, where a
+// newer request or a cancel drops the rest of this one.
+void
+HighlightWorker::_ContinueHighlighting()
+{
+	if (fShutdown || fActiveRequest == NULL)
 		return;
 
-	BMessage* result = _CreateHighlightResult(text, length, (syntax_type)syntaxType);
-	if (result && !fShutdown) {
-		result->AddInt64("timestamp", timestamp);
-		target.SendMessage(result);
+	if (fActiveTimestamp < fLastRequestTime) {
+		_FinishActiveRequest();
+		return;
+	}
+
+	SVGTextSnapshot* snapshot = NULL;
+	int32 syntaxType;
+	BMessenger target;
+
+	if (fActiveRequest->FindPointer("snapshot", (void**)&snapshot) != B_OK ||
+	    fActiveRequest->FindInt32("syntax_type", &syntaxType) != B_OK ||
+	    fActiveRequest->FindMessenger("target", &target) != B_OK) {
+		_FinishActiveRequest();
+		return;
+	}
+
+	const char* text = snapshot->Text();
+	int32 length = snapshot->Length();
+	if (text == NULL) {
+		_FinishActiveRequest();
+		return;
+	}
+
+	if ((syntax_type)syntaxType == SYNTAX_SVG_XML)
+		_PreviewViewport(text, length);
+
+	int32 position = fActivePass->Position();
+	fActivePass->Resume(position < length - HIGHLIGHT_CHUNK_SIZE
+		? position + HIGHLIGHT_CHUNK_SIZE : INT32_MAX);
+
+	BMessage* result = _CreateHighlightResult(text, length, (syntax_type)syntaxType,
+		*fActivePass);
+	if (result == NULL || fShutdown) {
 		delete result;
+		_FinishActiveRequest();
+		return;
+	}
+
+	bool complete = fActivePass->IsComplete();
+	result->AddInt64("timestamp", fActiveTimestamp);
+	result->AddInt32("revision", snapshot->Revision());
+	result->AddBool("final", complete);
+	target.SendMessage(result);
+	delete result;
+
+	if (complete) {
+		_FinishActiveRequest();
+		return;
+	}
+
+	BMessage next(MSG_HIGHLIGHT_CONTINUE);
+	next.AddInt64("timestamp", fActiveTimestamp);
+	PostMessage(&next);
+}
+
+// When the exact pass is still far from what the user is looking at, the
+// visible range is lexed on its own first, starting at a line break in
+// front of it. The exact pass overwrites it once it gets there, which it
+// is only sure to do before the point where it may converge.
+void
+HighlightWorker::_PreviewViewport(const char* text, int32 length)
+{
+	int32 position = fActivePass->Position();
+	if (fViewportEnd <= position + HIGHLIGHT_CHUNK_SIZE)
+		return;
+
+	int32 from = std::max(position, fViewportStart - HIGHLIGHT_VIEWPORT_MARGIN);
+	int32 to = std::min(std::min(length, fActivePass->ConvergeFrom()),
+		fViewportEnd + HIGHLIGHT_VIEWPORT_MARGIN);
+	if (from >= to || (from >= fPreviewStart && to <= fPreviewEnd))
+		return;
+
+	for (int32 lineStart = from; lineStart > position
+			&& lineStart > from - HIGHLIGHT_VIEWPORT_MARGIN; lineStart--) {
+		if (text[lineStart - 1] == '\n') {
+			from = lineStart;
+			break;
+		}
+	}
+
+	HighlightPass preview(from, length + 1, NULL, 0);
+	preview.SetRecording(false);
+	preview.SetLimit(to);
+
+	BMessage* result = _CreateHighlightResult(text, length, SYNTAX_SVG_XML, preview);
+	if (result == NULL)
+		return;
+
+	// The last token may run on past the limit; the view clips to pass_end.
+	to = std::min(to, preview.End());
+	result->ReplaceInt32("pass_end", to);
+
+	SVGTextSnapshot* snapshot = NULL;
+	BMessenger target;
+	if (fActiveRequest->FindPointer("snapshot", (void**)&snapshot) == B_OK
+		&& fActiveRequest->FindMessenger("target", &target) == B_OK) {
+		result->AddInt64("timestamp", fActiveTimestamp);
+		result->AddInt32("revision", snapshot->Revision());
+		result->AddBool("preview", true);
+		target.SendMessage(result);
 	}
+	delete result;
+
+	fPreviewStart = from;
+	fPreviewEnd = to;
+}
+
+void
+HighlightWorker::_FinishActiveRequest()
+{
+	delete fActivePass;
+	fActivePass = NULL;
+	if (fActiveRequest != NULL)
+		_ReleaseRequest(fActiveRequest);
+	delete fActiveRequest;
+	fActiveRequest = NULL;
+	fActiveTimestamp = 0;
+}
+
+void
+HighlightWorker::_ReleaseRequest(BMessage* request)
+{
+	if (request->what != MSG_HIGHLIGHT_REQUEST)
+		return;
+
+	SVGTextSnapshot* snapshot = NULL;
+	if (request->FindPointer("snapshot", (void**)&snapshot) == B_OK && snapshot != NULL)
+		snapshot->ReleaseReference();
 }
 
 BMessage*
-HighlightWorker::_CreateHighlightResult(const char* text, int32 length, syntax_type type)
+HighlightWorker::_CreateHighlightResult(const char* text, int32 length, syntax_type type,
+	HighlightPass& pass)
 {
 	if (fShutdown)
 		return NULL;
@@ -167,14 +515,14 @@ HighlightWorker::_CreateHighlightResult(const char* text, int32 length, syntax_t
 	if (!result)
 		return NULL;
 
-	BList ranges;
+	std::vector<HighlightRange> ranges;
 
 	switch (type) {
 		case SYNTAX_CPP:
 			_AnalyzeCppSyntax(text, length, &ranges);
 			break;
 		case SYNTAX_SVG_XML:
-			_AnalyzeSVGSyntax(text, length, &ranges);
+			_AnalyzeSVGSyntax(text, length, &ranges, &pass);
 			break;
 		case SYNTAX_RDEF:
 			_AnalyzeRdefSyntax(text, length, &ranges);
@@ -183,42 +531,41 @@ HighlightWorker::_CreateHighlightResult(const char* text, int32 length, syntax_t
 			break;
 	}
 
-	for (int32 i = 0; i < ranges.CountItems(); i++) {
-		if (fShutdown) {
-			for (int32 j = i; j < ranges.CountItems(); j++)
-				delete (HighlightRange*)ranges.ItemAt(j);
-			delete result;
-			return NULL;
-		}
+	if (fShutdown) {
+		delete result;
+		return NULL;
+	}
 
-		HighlightRange* range = (HighlightRange*)ranges.ItemAt(i);
-		if (range) {
-			result->AddInt32("start", range->start);
-			result->AddInt32("end", range->end);
-			result->AddInt32("type", (int32)range->type);
-		}
+	pass.Finish(length);
+	result->AddInt32("pass_start", pass.Start());
+	result->AddInt32("pass_end", pass.End());
+	if (!pass.Checkpoints().empty()) {
+		result->AddData("checkpoints", B_RAW_TYPE, &pass.Checkpoints()[0],
+			pass.Checkpoints().size() * sizeof(int32));
 	}
 
-	for (int32 i = 0; i < ranges.CountItems(); i++)
-		delete (HighlightRange*)ranges.ItemAt(i);
+	// All ranges travel as one packed array instead of three fields each.
+	if (!ranges.empty()) {
+		result->AddData("ranges", B_RAW_TYPE, &ranges[0],
+			ranges.size() * sizeof(HighlightRange));
+	}
 
 	return result;
 }
 
 void
-HighlightWorker::_AddRange(BList* ranges, int32 start, int32 end, highlight_type type)
+HighlightWorker::_AddRange(std::vector<HighlightRange>* ranges, int32 start, int32 end,
+	highlight_type type)
 {
 	if (!ranges || fShutdown)
 		return;
 
-	HighlightRange* range = new HighlightRange(start, end, type);
-	if (range)
-		ranges->AddItem(range);
+	ranges->push_back(HighlightRange(start, end, type));
 }
 
 SVGTextEdit::SVGTextEdit(const char* name)
 	: BTextView(name),
-	fMaxUndoLevels(DEFAULT_MAX_UNDO_LEVELS),
+	fUndoMemory(0),
 	fInUndoRedo(false),
 	fLastOperationTime(0),
 	fMergeTimeLimit(MERGE_TIME_LIMIT_MICROSECONDS),
@@ -226,8 +573,23 @@ SVGTextEdit::SVGTextEdit(const char* name)
 	fSyntaxType(SYNTAX_NONE),
 	fHighlightWorker(NULL),
 	fLastHighlightRequest(0),
+	fHighlightedRevision(0),
 	fHighlightDelayRunner(NULL),
-	fForceHighlightUpdate(false)
+	fForceHighlightUpdate(false),
+	fRevision(1),
+	fDirtyStart(0),
+	fDirtyEnd(0),
+	fHighlightedSyntax(SYNTAX_NONE),
+	fHasPresetHighlighting(false),
+	fStreamMatches(false),
+	fSearchRunning(false),
+	fLineCount(0),
+	fFindMatchesFlags(0),
+	fFindMatchesRevision(0),
+	fSearchWorker(NULL),
+	fFindGeneration(0),
+	fReplaceGeneration(0),
+	fReplaceFound(0)
 {
 	SetWordWrap(false);
 	MakeEditable(true);
@@ -253,6 +615,9 @@ SVGTextEdit::~SVGTextEdit()
 		snooze(100000);
 	}
 
+	if (fSearchWorker)
+		fSearchWorker->Shutdown();
+
 	ClearUndoHistory();
 }
 
@@ -287,6 +652,14 @@ SVGTextEdit::MessageReceived(BMessage* message)
 			_ApplyHighlightResult(message);
 			break;
 
+		case MSG_TEXT_SEARCH_RESULT:
+			_ApplySearchResult(message);
+			break;
+
+		case MSG_TEXT_REPLACE_RESULT:
+			_ApplyReplaceResult(message);
+			break;
+
 		default:
 			break;
 	}
@@ -310,7 +683,9 @@ SVGTextEdit::Select(int32 startOffset, int32 endOffset)
 void
 SVGTextEdit::SetText(const char* text, const text_run_array* runs)
 {
-	fLastHighlightedText.SetTo("");
+	fHasPresetHighlighting = false;
+	fPresetRanges.clear();
+	fHighlightedRevision = 0;
 	fForceHighlightUpdate = true;
 	_CancelPendingHighlighting();
 
@@ -320,6 +695,29 @@ SVGTextEdit::SetText(const char* text, const text_run_array* runs)
 	ForceHighlightRefresh();
 }
 
+void
+SVGTextEdit::SetHighlightedText(const char* text, const std::vector<HighlightRange>& ranges)
+{
+	_CancelPendingHighlighting();
+
+	fPresetRanges = ranges;
+	fHasPresetHighlighting = true;
+
+	text_run_array* runs = _CreatePresetRunArray(text != NULL ? strlen(text) : 0);
+
+	// The text comes with its highlighting, so nothing is recorded for undo
+	// and no request goes to the highlight worker.
+	_SetUndoRedoMode(true);
+	BTextView::SetText(text, runs);
+	_SetUndoRedoMode(false);
+
+	if (runs != NULL)
+		BTextView::FreeRunArray(runs);
+	BTextView::ScrollToOffset(0);
+
+	_ResetHighlightState();
+}
+
 void
 SVGTextEdit::InsertText(const char* text, int32 length, int32 offset, const text_run_array* runs)
 {
@@ -328,17 +726,22 @@ SVGTextEdit::InsertText(const char* text, int32 length, int32 offset, const text
 		if (length > MAX_MERGEABLE_TEXT_LENGTH)
 			canMerge = false;
 
-		_AddUndoCommand(CMD_INSERT_TEXT, offset, length, text, runs, canMerge);
+		SVGPieceList inserted;
+		fBuffer.Insert(offset, text, length, &inserted);
+		_AddUndoCommand(CMD_INSERT_TEXT, offset, length, inserted, runs, canMerge);
 
 		for (int32 i = 0; i < fRedoStack.CountItems(); i++)
 			_DeleteCommand((UndoCommand*)fRedoStack.ItemAt(i));
 
 		fRedoStack.MakeEmpty();
-	}
+	} else
+		fBuffer.Insert(offset, text, length);
 
 	BTextView::InsertText(text, length, offset, runs);
+	_NoteTextChange(offset, 0, length);
 
 	if (!_IsInUndoRedoMode()) {
+		fHasPresetHighlighting = false;
 		_RequestAsyncHighlighting();
 
 		BWindow* window = Window();
@@ -355,30 +758,29 @@ SVGTextEdit::DeleteText(int32 start, int32 finish)
 	if (!_IsInUndoRedoMode()) {
 		int32 deleteLength = finish - start;
 		if (deleteLength > 0) {
-			char* deletedText = (char*)malloc(deleteLength + 1);
-			if (deletedText) {
-				GetText(start, deleteLength, deletedText);
-				deletedText[deleteLength] = '\0';
+			SVGPieceList deleted;
+			fBuffer.Delete(start, finish, &deleted);
 
-				text_run_array* deletedRuns = RunArray(start, finish);
+			text_run_array* deletedRuns = _UndoKeepsRuns() ? RunArray(start, finish) : NULL;
 
-				bool canMerge = fLastWasTyping && (deleteLength == 1);
-				_AddUndoCommand(CMD_DELETE_TEXT, start, deleteLength, deletedText, deletedRuns, canMerge);
+			bool canMerge = fLastWasTyping && (deleteLength == 1);
+			_AddUndoCommand(CMD_DELETE_TEXT, start, deleteLength, deleted, deletedRuns, canMerge);
 
-				free(deletedText);
-				free(deletedRuns);
-			}
+			free(deletedRuns);
 		}
 
 		for (int32 i = 0; i < fRedoStack.CountItems(); i++)
 			_DeleteCommand((UndoCommand*)fRedoStack.ItemAt(i));
 
 		fRedoStack.MakeEmpty();
-	}
+	} else
+		fBuffer.Delete(start, finish);
 
 	BTextView::DeleteText(start, finish);
+	_NoteTextChange(start, finish - start, 0);
 
 	if (!_IsInUndoRedoMode()) {
+		fHasPresetHighlighting = false;
 		_RequestAsyncHighlighting();
 
 		BWindow* window = Window();
@@ -508,8 +910,18 @@ SVGTextEdit::ApplySyntaxHighlighting()
 void
 SVGTextEdit::ForceHighlightRefresh()
 {
-	fLastHighlightedText.SetTo("");
+	if (fHasPresetHighlighting) {
+		text_run_array* runs = _CreatePresetRunArray(TextLength());
+		if (runs != NULL) {
+			SetRunArray(0, TextLength(), runs);
+			BTextView::FreeRunArray(runs);
+		}
+		return;
+	}
+
+	fHighlightedRevision = 0;
 	fForceHighlightUpdate = true;
+	_ResetHighlightState();
 
 	if (fSyntaxType == SYNTAX_NONE && TextLength() > 0)
 		fSyntaxType = _DetectSyntaxFromContent();
@@ -518,38 +930,55 @@ SVGTextEdit::ForceHighlightRefresh()
 }
 
 bool
-SVGTextEdit::Find(const char* text, bool forward, bool wrap)
+SVGTextEdit::Find(const char* text, bool forward, bool wrap, uint32 flags)
 {
-	if (!text || strlen(text) == 0)
+	if (text == NULL || text[0] == '\0')
 		return false;
 
-	BString content(Text());
-	int32 contentLength = content.Length();
-	int32 searchLen = strlen(text);
-
 	int32 selStart, selEnd;
 	GetSelection(&selStart, &selEnd);
 
-	int32 foundPos = B_ERROR;
+	SVGSearchMatch found = { -1, 0 };
 
-	if (forward) {
-		foundPos = content.FindFirst(text, selEnd);
-		if (foundPos == B_ERROR && wrap) {
-			foundPos = content.FindFirst(text, 0);
-		}
+	if (fSearch.PatternLength() > 0 && fSearch.Flags() == flags
+		&& strcmp(fSearch.Pattern(), text) == 0 && !fSearchRunning) {
+		// every match is known already
+		_FindInMatches(fSearchMatches, selStart, selEnd, forward, wrap, &found);
 	} else {
-		if (selStart > 0) {
-			BString sub = content;
-			sub.Truncate(selStart);
-			foundPos = sub.FindLast(text);
-		}
-		if (foundPos == B_ERROR && wrap) {
-			foundPos = content.FindLast(text);
+		// Text() is the view's own buffer, the search runs on it in place
+		SVGTextSearch search(text, flags);
+		const char* content = Text();
+		int32 contentLength = TextLength();
+
+		// An empty regular expression match is already selected once
+		// found, so the search has to start past it.
+		bool emptySelection = selStart == selEnd;
+		if (forward) {
+			int32 from = emptySelection && search.IsRegex() ? selEnd + 1 : selEnd;
+			if (!search.FindNext(content, contentLength, from, &found) && wrap)
+				search.FindNext(content, contentLength, 0, &found);
+		} else if (search.IsRegex()) {
+			// A regular expression only runs forwards, so going back needs
+			// all the matches in front of the selection. They are kept
+			// until the text or the pattern changes.
+			if (fFindMatchesRevision != fRevision || fFindMatchesFlags != flags
+				|| fFindMatchesPattern != text) {
+				fFindMatches.clear();
+				search.FindAll(content, contentLength, 0, contentLength + 1,
+					fFindMatches);
+				fFindMatchesPattern = text;
+				fFindMatchesFlags = flags;
+				fFindMatchesRevision = fRevision;
+			}
+			_FindInMatches(fFindMatches, selStart, selEnd, forward, wrap, &found);
+		} else {
+			if (!search.FindPrevious(content, contentLength, selStart, &found) && wrap)
+				search.FindPrevious(content, contentLength, contentLength, &found);
 		}
 	}
 
-	if (foundPos != B_ERROR) {
-		Select(foundPos, foundPos + searchLen);
+	if (found.start >= 0) {
+		Select(found.start, found.start + found.length);
 		ScrollToSelection();
 		return true;
 	}
@@ -557,6 +986,168 @@ SVGTextEdit::Find(const char* text, bool forward, bool wrap)
 	return false;
 }
 
+// Picks the match after or before the selection from a sorted list. An
+// empty match that is selected already is skipped.
+void
+SVGTextEdit::_FindInMatches(const std::vector<SVGSearchMatch>& matches,
+	int32 selStart, int32 selEnd, bool forward, bool wrap, SVGSearchMatch* found)
+{
+	if (matches.empty())
+		return;
+
+	bool emptySelection = selStart == selEnd;
+	std::vector<SVGSearchMatch>::const_iterator it;
+	if (forward) {
+		it = std::lower_bound(matches.begin(), matches.end(), selEnd,
+			_MatchStartsBefore);
+		if (emptySelection && it != matches.end() && it->start == selEnd
+			&& it->length == 0) {
+			it++;
+		}
+		if (it != matches.end())
+			*found = *it;
+		else if (wrap)
+			*found = matches.front();
+	} else {
+		it = std::upper_bound(matches.begin(), matches.end(), selStart,
+			_MatchEndsAfter);
+		if (emptySelection && it != matches.begin()
+			&& (it - 1)->start == selStart && (it - 1)->length == 0) {
+			it--;
+		}
+		if (it != matches.begin())
+			*found = *(it - 1);
+		else if (wrap)
+			*found = matches.back();
+	}
+}
+
+int32
+SVGTextEdit::FindAll(const char* text, uint32 flags)
+{
+	if (text == NULL || text[0] == '\0') {
+		ClearSearchMatches();
+		return 0;
+	}
+
+	if (fSearch.PatternLength() > 0 && fSearch.Flags() == flags
+		&& strcmp(fSearch.Pattern(), text) == 0) {
+		return fSearchMatches.size();
+	}
+
+	fSearch.SetTo(text, flags);
+	fSearchMatches.clear();
+
+	if (fSearch.IsRegex())
+		_StartBackgroundSearch(true);
+	else {
+		if (fSearchRunning) {
+			_SearchWorker()->CancelFind();
+			fSearchRunning = false;
+		}
+		fSearch.FindAll(Text(), TextLength(), 0, TextLength(), fSearchMatches);
+	}
+
+	Invalidate();
+	return fSearchMatches.size();
+}
+
+void
+SVGTextEdit::ClearSearchMatches()
+{
+	if (fSearch.PatternLength() == 0)
+		return;
+
+	if (fSearchRunning) {
+		_SearchWorker()->CancelFind();
+		fSearchRunning = false;
+	}
+
+	fSearch.SetTo(NULL);
+	fSearchMatches.clear();
+	fPendingMatches.clear();
+	Invalidate();
+}
+
+const char*
+SVGTextEdit::SearchError() const
+{
+	return fSearch.InitCheck() != B_OK ? fSearch.ErrorString() : NULL;
+}
+
+int32
+SVGTextEdit::SelectedSearchMatch() const
+{
+	int32 selStart, selEnd;
+	GetSelection(&selStart, &selEnd);
+
+	std::vector<SVGSearchMatch>::const_iterator it = std::lower_bound(
+		fSearchMatches.begin(), fSearchMatches.end(), selStart, _MatchStartsBefore);
+	if (it == fSearchMatches.end() || it->start != selStart
+		|| it->start + it->length != selEnd) {
+		return -1;
+	}
+
+	return it - fSearchMatches.begin();
+}
+
+void
+SVGTextEdit::ReplaceAll(const char* text, const char* replacement, uint32 flags)
+{
+	if (text == NULL || text[0] == '\0')
+		return;
+
+	fReplaceFound = 0;
+	fReplaceGeneration = _SearchWorker()->RequestReplace(_Snapshot(), text, flags,
+		replacement, BMessenger(this));
+}
+
+void
+SVGTextEdit::Draw(BRect updateRect)
+{
+	BTextView::Draw(updateRect);
+
+	if (fSearchMatches.empty())
+		return;
+
+	// Starts and ends of the matches both ascend, so the ones that can
+	// reach into the update rect are a single run.
+	int32 start = OffsetAt(updateRect.LeftTop());
+	int32 end = OffsetAt(updateRect.RightBottom());
+
+	std::vector<SVGSearchMatch>::const_iterator it = std::lower_bound(
+		fSearchMatches.begin(), fSearchMatches.end(), start, _MatchEndsBefore);
+	if (it == fSearchMatches.end() || it->start > end)
+		return;
+
+	PushState();
+	SetDrawingMode(B_OP_ALPHA);
+	SetBlendingMode(B_PIXEL_ALPHA, B_ALPHA_OVERLAY);
+	SetHighColor(GetColorScheme(this).search_match);
+
+	for (; it != fSearchMatches.end() && it->start <= end; it++) {
+		BRegion region;
+		GetTextRegion(it->start, it->start + it->length, &region);
+		FillRegion(&region);
+	}
+
+	PopState();
+}
+
+void
+SVGTextEdit::ScrollTo(BPoint where)
+{
+	BTextView::ScrollTo(where);
+
+	// While a pass is still filling in the document, let it jump ahead to
+	// whatever is scrolled into view.
+	if (fHighlightWorker != NULL && fDirtyStart >= 0 && !fHasPresetHighlighting) {
+		int32 visibleStart, visibleEnd;
+		_GetVisibleRange(&visibleStart, &visibleEnd);
+		fHighlightWorker->SetViewport(fLastHighlightRequest, visibleStart, visibleEnd);
+	}
+}
+
 void
 SVGTextEdit::_RequestAsyncHighlighting()
 {
@@ -574,7 +1165,7 @@ SVGTextEdit::_RequestAsyncHighlighting()
 void
 SVGTextEdit::_SendHighlightRequest()
 {
-	if (!fHighlightWorker)
+	if (!fHighlightWorker || fHasPresetHighlighting)
 		return;
 
 	syntax_type detectedType = _DetectSyntaxFromContent();
@@ -582,11 +1173,57 @@ SVGTextEdit::_SendHighlightRequest()
 		fSyntaxType = detectedType;
 	}
 
-	const char* text = Text();
-	int32 length = TextLength();
+	if (fSyntaxType != fHighlightedSyntax) {
+		fHighlightedSyntax = fSyntaxType;
+		_ResetHighlightState();
+	}
+
+	SVGTextSnapshot* snapshot = _Snapshot();
+	if (snapshot == NULL)
+		return;
 
-	fHighlightWorker->RequestHighlighting(text, length, fSyntaxType,
-										fLastHighlightRequest, BMessenger(this));
+	int32 length = snapshot->Length();
+
+	// Re-lex from the last checkpoint whose lookahead cannot reach into the
+	// edited region, until the lexer meets a checkpoint after it again.
+	int32 start = 0;
+	int32 convergeFrom = length;
+	const int32* checkpoints = NULL;
+	int32 checkpointCount = 0;
+
+	if (fDirtyStart >= 0) {
+		std::vector<int32>::const_iterator restart = std::upper_bound(
+			fCheckpoints.cbegin(), fCheckpoints.cend(), fDirtyStart - HIGHLIGHT_LOOKAHEAD);
+		if (restart != fCheckpoints.cbegin())
+			start = *(restart - 1);
+
+		convergeFrom = fDirtyEnd;
+		std::vector<int32>::const_iterator converge = std::lower_bound(restart,
+			fCheckpoints.cend(), fDirtyEnd);
+		if (converge != fCheckpoints.cend()) {
+			checkpoints = &*converge;
+			checkpointCount = fCheckpoints.cend() - converge;
+		}
+	}
+
+	fHighlightWorker->RequestHighlighting(snapshot, fSyntaxType,
+										fLastHighlightRequest, BMessenger(this),
+										start, convergeFrom, checkpoints,
+										checkpointCount);
+
+	int32 visibleStart, visibleEnd;
+	_GetVisibleRange(&visibleStart, &visibleEnd);
+	fHighlightWorker->SetViewport(fLastHighlightRequest, visibleStart, visibleEnd);
+}
+
+void
+SVGTextEdit::_GetVisibleRange(int32* start, int32* end)
+{
+	BRect bounds = Bounds();
+	*start = OffsetAt(bounds.LeftTop());
+	*end = OffsetAt(bounds.RightBottom());
+	if (*end < TextLength())
+		*end = std::min(TextLength(), *end + 1);
 }
 
 void
@@ -596,95 +1233,67 @@ SVGTextEdit::_ApplyHighlightResult(BMessage* result)
 	if (result->FindInt64("timestamp", &timestamp) != B_OK)
 		return;
 
-	if (timestamp != fLastHighlightRequest)
+	if (timestamp != fLastHighlightRequest || fHasPresetHighlighting)
 		return;
 
-	if (!fForceHighlightUpdate && fLastHighlightedText == Text())
+	if ((uint32)result->GetInt32("revision", 0) != fRevision)
 		return;
 
-	fForceHighlightUpdate = false;
+	if (!fForceHighlightUpdate && fHighlightedRevision == fRevision)
+		return;
 
-	BFont font(be_fixed_font);
-	const ColorScheme& colors = GetColorScheme(this);
+	// Large passes arrive in chunks, possibly preceded by a preview of the
+	// visible range that is not used for incremental state.
+	bool preview = result->GetBool("preview", false);
+	bool lastChunk = result->GetBool("final", true);
 
-	SetFontAndColor(0, TextLength(), &font, B_FONT_ALL, &colors.text);
-
-	BList sortedRanges;
-
-	type_code messageType;
-	int32 count;
-	if (result->GetInfo("start", &messageType, &count) == B_OK) {
-		for (int32 i = 0; i < count; i++) {
-			int32 start, end, type;
-
-			if (result->FindInt32("start", i, &start) == B_OK &&
-			    result->FindInt32("end", i, &end) == B_OK &&
-			    result->FindInt32("type", i, &type) == B_OK) {
-
-				if (start >= 0 && end <= TextLength() && start < end) {
-					HighlightRange* range = new HighlightRange(start, end, (highlight_type)type);
-					if (range) {
-						bool inserted = false;
-						for (int32 j = 0; j < sortedRanges.CountItems(); j++) {
-							HighlightRange* existing = (HighlightRange*)sortedRanges.ItemAt(j);
-							if (existing && range->start < existing->start) {
-								sortedRanges.AddItem(range, j);
-								inserted = true;
-								break;
-							}
-						}
-						if (!inserted) {
-							sortedRanges.AddItem(range);
-						}
-					}
-				}
-			}
+	int32 passStart = result->GetInt32("pass_start", 0);
+	int32 passEnd = result->GetInt32("pass_end", TextLength());
+	if (passStart < 0 || passEnd > TextLength() || passStart > passEnd) {
+		passStart = 0;
+		passEnd = TextLength();
+	}
+
+	// Only the re-lexed part changes, the styles around it stay in place.
+	if (passStart < passEnd) {
+		const void* data = NULL;
+		ssize_t dataSize = 0;
+		if (result->FindData("ranges", B_RAW_TYPE, &data, &dataSize) != B_OK)
+			dataSize = 0;
+
+		text_run_array* runs = _CreateRunArray((const HighlightRange*)data,
+			dataSize / sizeof(HighlightRange), passStart, passEnd);
+		if (runs != NULL) {
+			SetRunArray(passStart, passEnd, runs);
+			BTextView::FreeRunArray(runs);
 		}
 	}
 
-	for (int32 i = 0; i < sortedRanges.CountItems(); i++) {
-		HighlightRange* range = (HighlightRange*)sortedRanges.ItemAt(i);
-		if (range) {
-			rgb_color color;
-
-			switch (range->type) {
-				case HIGHLIGHT_KEYWORD:
-					color = colors.keyword;
-					break;
-				case HIGHLIGHT_STRING:
-					color = colors.string;
-					break;
-				case HIGHLIGHT_COMMENT:
-					color = colors.comment;
-					break;
-				case HIGHLIGHT_NUMBER:
-					color = colors.number;
-					break;
-				case HIGHLIGHT_OPERATOR:
-					color = colors.operator_color;
-					break;
-				case HIGHLIGHT_TAG:
-					color = colors.tag;
-					break;
-				case HIGHLIGHT_ATTRIBUTE:
-					color = colors.attribute;
-					break;
-				case HIGHLIGHT_PREPROCESSOR:
-					color = colors.preprocessor;
-					break;
-				default:
-					color = colors.text;
-					break;
-			}
+	if (preview)
+		return;
 
-			SetFontAndColor(range->start, range->end, &font, B_FONT_ALL, &color);
-		}
+	std::vector<int32>::iterator first = std::lower_bound(fCheckpoints.begin(),
+		fCheckpoints.end(), passStart);
+	std::vector<int32>::iterator last = std::lower_bound(first, fCheckpoints.end(),
+		passEnd);
+	first = fCheckpoints.erase(first, last);
+
+	const void* checkpoints = NULL;
+	ssize_t checkpointsSize = 0;
+	if (result->FindData("checkpoints", B_RAW_TYPE, &checkpoints, &checkpointsSize) == B_OK) {
+		const int32* newCheckpoints = (const int32*)checkpoints;
+		fCheckpoints.insert(first, newCheckpoints,
+			newCheckpoints + checkpointsSize / sizeof(int32));
 	}
 
-	for (int32 i = 0; i < sortedRanges.CountItems(); i++)
-		delete (HighlightRange*)sortedRanges.ItemAt(i);
+	if (!lastChunk)
+		return;
+
+	fDirtyStart = -1;
+	fDirtyEnd = -1;
 
-	fLastHighlightedText.SetTo(Text());
+	fForceHighlightUpdate = false;
+	fHighlightedRevision = fRevision;
 }
 
 void
@@ -698,6 +1307,476 @@ SVGTextEdit::_CancelPendingHighlighting()
 	fHighlightDelayRunner = NULL;
 }
 
+// The snapshot of the current revision, shared by all requests until the
+// next edit.
+SVGTextSnapshot*
+SVGTextEdit::_Snapshot()
+{
+	if (fSnapshot.Get() != NULL && fSnapshot->Revision() == fRevision)
+		return fSnapshot.Get();
+
+	// The buffer follows every edit; should it ever disagree with the
+	// view, start over from the view's text.
+	if (fBuffer.Length() != TextLength())
+		fBuffer.SetTo(Text(), TextLength());
+
+	SVGPieceList pieces;
+	fBuffer.GetPieces(pieces);
+
+	fSnapshot.SetTo(new SVGTextSnapshot(pieces, fRevision), true);
+	return fSnapshot.Get();
+}
+
+text_run_array*
+SVGTextEdit::_CreatePresetRunArray(int32 textLength)
+{
+	return _CreateRunArray(fPresetRanges.empty() ? NULL : &fPresetRanges[0],
+		fPresetRanges.size(), 0, textLength);
+}
+
+// Turns highlight ranges into one run array for [start, end), with run
+// offsets relative to start. Ranges may come in any order and may overlap,
+// in which case the later of two ranges starting at the same offset and
+// the one starting last win, as if each range were painted in turn.
+// Neighbouring runs of the same color are merged.
+text_run_array*
+SVGTextEdit::_CreateRunArray(const HighlightRange* ranges, int32 count,
+	int32 start, int32 end)
+{
+	std::vector<HighlightRange> sorted;
+	sorted.reserve(count);
+	for (int32 i = 0; i < count; i++) {
+		if (ranges[i].start < ranges[i].end && ranges[i].start < end
+			&& ranges[i].end > start)
+			sorted.push_back(ranges[i]);
+	}
+
+	if (!std::is_sorted(sorted.begin(), sorted.end(), _CompareRangeStart))
+		std::stable_sort(sorted.begin(), sorted.end(), _CompareRangeStart);
+
+	text_run_array* runs = BTextView::AllocRunArray(sorted.size() * 2 + 1);
+	if (runs == NULL)
+		return NULL;
+
+	BFont font(be_fixed_font);
+	const ColorScheme& colors = GetColorScheme(this);
+
+	// Ranges that are still open, the one painted last on top. A range
+	// below the top only shows again once everything above it has ended.
+	std::vector<const HighlightRange*> active;
+	int32 runCount = 0;
+	int32 position = start;
+	size_t next = 0;
+
+	while (position < end || runCount == 0) {
+		while (!active.empty() && active.back()->end <= position)
+			active.pop_back();
+
+		if (next < sorted.size() && sorted[next].start <= position) {
+			active.push_back(&sorted[next++]);
+			continue;
+		}
+
+		int32 runEnd = next < sorted.size() ? sorted[next].start : end;
+		rgb_color color = colors.text;
+		if (!active.empty()) {
+			runEnd = std::min(runEnd, active.back()->end);
+			color = _HighlightColor(active.back()->type, colors);
+		}
+
+		if (runCount == 0 || color != runs->runs[runCount - 1].color) {
+			runs->runs[runCount].offset = position - start;
+			runs->runs[runCount].font = font;
+			runs->runs[runCount].color = color;
+			runCount++;
+		}
+
+		if (runEnd <= position)
+			break;
+		position = runEnd;
+	}
+
+	runs->count = runCount;
+	return runs;
+}
+
+void
+SVGTextEdit::_NoteTextChange(int32 offset, int32 removedLength, int32 insertedLength)
+{
+	fRevision++;
+	_UpdateSearchMatches(offset, removedLength, insertedLength);
+
+	// Checkpoints inside the removed text are gone, the ones after it move.
+	int32 delta = insertedLength - removedLength;
+	std::vector<int32>::iterator first = std::lower_bound(fCheckpoints.begin(),
+		fCheckpoints.end(), offset);
+	std::vector<int32>::iterator last = std::lower_bound(first, fCheckpoints.end(),
+		offset + removedLength);
+	first = fCheckpoints.erase(first, last);
+	for (; first != fCheckpoints.end(); first++)
+		*first += delta;
+
+	if (fDirtyStart < 0) {
+		fDirtyStart = offset;
+		fDirtyEnd = offset + insertedLength;
+		return;
+	}
+
+	if (fDirtyEnd >= offset + removedLength)
+		fDirtyEnd += delta;
+	else if (fDirtyEnd > offset)
+		fDirtyEnd = offset;
+
+	fDirtyStart = std::min(fDirtyStart, offset);
+	fDirtyEnd = std::max(fDirtyEnd, offset + insertedLength);
+}
+
+// Keeps the marked search matches in step with an edit. Only matches that
+// overlap the edit or touch it can change, since a whole-word match also
+// depends on its neighbours, so those are dropped and the rest move. A
+// plain pattern is then searched for again around the edit; a regular
+// expression is searched again in the background.
+void
+SVGTextEdit::_UpdateSearchMatches(int32 offset, int32 removedLength,
+	int32 insertedLength)
+{
+	int32 lineCount = CountLines();
+	bool linesMoved = lineCount != fLineCount;
+	fLineCount = lineCount;
+
+	int32 patternLength = fSearch.PatternLength();
+	if (patternLength == 0 || fSearch.InitCheck() != B_OK)
+		return;
+
+	// The text range whose marks change, as it is after the edit
+	int32 changedStart = offset;
+	int32 changedEnd = offset + insertedLength;
+
+	int32 delta = insertedLength - removedLength;
+	std::vector<SVGSearchMatch>::iterator first = std::lower_bound(
+		fSearchMatches.begin(), fSearchMatches.end(), offset, _MatchEndsBefore);
+	std::vector<SVGSearchMatch>::iterator last = std::upper_bound(first,
+		fSearchMatches.end(), offset + removedLength, _MatchStartsAfter);
+	bool removed = first != last;
+	if (removed) {
+		int32 removedEnd = (last - 1)->start + (last - 1)->length;
+		changedStart = std::min(changedStart, first->start);
+		if (removedEnd > offset + removedLength)
+			changedEnd = std::max(changedEnd, removedEnd + delta);
+	}
+
+	first = fSearchMatches.erase(first, last);
+	for (std::vector<SVGSearchMatch>::iterator it = first; it != fSearchMatches.end(); it++)
+		it->start += delta;
+
+	if (fSearch.IsRegex()) {
+		_StartBackgroundSearch(false);
+		_InvalidateEditedLines(changedStart, changedEnd, linesMoved, removed);
+		return;
+	}
+
+	// Starts in [scanFrom, scanTo) plus one byte on each side for the
+	// word boundaries. GetText() leaves the view's gap buffer alone.
+	int32 textLength = TextLength();
+	int32 scanFrom = std::max((int32)0, offset - patternLength);
+	int32 scanTo = std::min(textLength, offset + insertedLength + 1);
+	int32 contextStart = std::max((int32)0, scanFrom - 1);
+	int32 contextEnd = std::min(textLength, scanTo + patternLength);
+
+	std::vector<SVGSearchMatch> found;
+	if (contextEnd > contextStart) {
+		int32 contextLength = contextEnd - contextStart;
+		char* context = (char*)malloc(contextLength);
+		if (context != NULL) {
+			GetText(contextStart, contextLength, context);
+			fSearch.FindAll(context, contextLength, scanFrom - contextStart,
+				scanTo - contextStart, found);
+			free(context);
+		}
+	}
+
+	for (size_t i = 0; i < found.size(); i++)
+		found[i].start += contextStart;
+	fSearchMatches.insert(first, found.begin(), found.end());
+
+	if (!found.empty()) {
+		changedStart = std::min(changedStart, found.front().start);
+		changedEnd = std::max(changedEnd, found.back().start + found.back().length);
+	}
+
+	_InvalidateEditedLines(changedStart, changedEnd, linesMoved,
+		removed || !found.empty());
+}
+
+// BTextView redraws the lines an edit touched, and everything below them
+// once the number of lines changed, without going through Draw(), so the
+// marks there are gone. Only those lines are invalidated, and only when a
+// mark was on them or changed.
+void
+SVGTextEdit::_InvalidateEditedLines(int32 start, int32 end, bool linesMoved,
+	bool marksChanged)
+{
+	BRect bounds = Bounds();
+	int32 lineStart = OffsetAt(LineAt(start));
+	float top = PointAt(lineStart).y;
+	float bottom = bounds.bottom;
+
+	int32 lineEnd;
+	if (linesMoved)
+		lineEnd = OffsetAt(bounds.RightBottom());
+	else {
+		int32 line = LineAt(end);
+		lineEnd = line + 1 < CountLines() ? OffsetAt(line + 1) : TextLength();
+
+		float height;
+		bottom = PointAt(OffsetAt(line), &height).y + height;
+	}
+
+	if (!marksChanged) {
+		std::vector<SVGSearchMatch>::const_iterator it = std::lower_bound(
+			fSearchMatches.cbegin(), fSearchMatches.cend(), lineStart, _MatchEndsBefore);
+		if (it == fSearchMatches.cend() || it->start > lineEnd)
+			return;
+	}
+
+	if (top <= bounds.bottom && bottom >= bounds.top)
+		Invalidate(BRect(bounds.left, top, bounds.right, bottom));
+}
+
+// Invalidates the marks of the matches on screen. Their starts have to
+// ascend.
+void
+SVGTextEdit::_InvalidateMatches(const SVGSearchMatch* matches, int32 count)
+{
+	BRect bounds = Bounds();
+	int32 visibleStart = OffsetAt(bounds.LeftTop());
+	int32 visibleEnd = OffsetAt(bounds.RightBottom());
+
+	for (int32 i = 0; i < count && matches[i].start <= visibleEnd; i++) {
+		if (matches[i].start + matches[i].length < visibleStart)
+			continue;
+
+		BRegion region;
+		GetTextRegion(matches[i].start, matches[i].start + matches[i].length, &region);
+		Invalidate(&region);
+	}
+}
+
+// Invalidates the matches that are in only one of the lists, which are
+// both sorted. Of two matches at the same start the longer covers both.
+void
+SVGTextEdit::_InvalidateChangedMatches(const std::vector<SVGSearchMatch>& before,
+	const std::vector<SVGSearchMatch>& after)
+{
+	std::vector<SVGSearchMatch> changed;
+	size_t i = 0;
+	size_t j = 0;
+	while (i < before.size() || j < after.size()) {
+		if (j == after.size() || (i < before.size() && before[i].start < after[j].start))
+			changed.push_back(before[i++]);
+		else if (i == before.size() || after[j].start < before[i].start)
+			changed.push_back(after[j++]);
+		else {
+			if (before[i].length != after[j].length)
+				changed.push_back(before[i].length > after[j].length ? before[i] : after[j]);
+			i++;
+			j++;
+		}
+	}
+
+	if (!changed.empty())
+		_InvalidateMatches(&changed[0], changed.size());
+}
+
+SVGSearchWorker*
+SVGTextEdit::_SearchWorker()
+{
+	if (fSearchWorker == NULL)
+		fSearchWorker = new SVGSearchWorker();
+	return fSearchWorker;
+}
+
+void
+SVGTextEdit::_StartBackgroundSearch(bool streamMatches)
+{
+	fPendingMatches.clear();
+	fStreamMatches = streamMatches;
+	fSearchRunning = fSearch.InitCheck() == B_OK;
+
+	if (fSearchRunning) {
+		fFindGeneration = _SearchWorker()->RequestFind(_Snapshot(), fSearch.Pattern(),
+			fSearch.Flags(), BMessenger(this));
+	} else if (fSearchWorker != NULL)
+		fSearchWorker->CancelFind();
+}
+
+void
+SVGTextEdit::_ApplySearchResult(BMessage* result)
+{
+	if (fSearchWorker == NULL)
+		return;
+
+	bool replace = result->GetBool("replace", false);
+	int32 generation = result->GetInt32("generation", 0);
+	if (generation != (replace ? fReplaceGeneration : fFindGeneration)
+		|| !fSearchWorker->IsCurrent(generation, replace)) {
+		return;
+	}
+
+	const void* data = NULL;
+	ssize_t dataSize = 0;
+	int32 count = 0;
+	if (result->FindData("matches", B_RAW_TYPE, &data, &dataSize) == B_OK)
+		count = dataSize / sizeof(SVGSearchMatch);
+
+	bool final = result->GetBool("final", false);
+
+	BMessage progress(MSG_SEARCH_PROGRESS);
+	progress.AddPointer("source", this);
+	progress.AddBool("final", final);
+
+	if (replace) {
+		// nothing to show but how far the replace has got
+		fReplaceFound = result->GetInt32("count", fReplaceFound);
+		progress.AddBool("replace", true);
+		progress.AddInt32("count", fReplaceFound);
+	} else {
+		const SVGSearchMatch* matches = (const SVGSearchMatch*)data;
+		std::vector<SVGSearchMatch>& target = fStreamMatches ? fSearchMatches
+			: fPendingMatches;
+		if (count > 0)
+			target.insert(target.end(), matches, matches + count);
+
+		if (fStreamMatches)
+			_InvalidateMatches(matches, count);
+
+		if (final) {
+			if (!fStreamMatches) {
+				_InvalidateChangedMatches(fSearchMatches, fPendingMatches);
+				fSearchMatches.swap(fPendingMatches);
+			}
+			fPendingMatches.clear();
+			fSearchRunning = false;
+		}
+
+		progress.AddInt32("count", target.size());
+	}
+
+	BWindow* window = Window();
+	if (window)
+		window->PostMessage(&progress);
+}
+
+void
+SVGTextEdit::_ApplyReplaceResult(BMessage* result)
+{
+	// the worker hands over its reference to the block
+	SVGTextBlock* block = NULL;
+	result->FindPointer("block", (void**)&block);
+	BReference<SVGTextBlock> blockReference(block, true);
+
+	int32 generation = result->GetInt32("generation", 0);
+	if (fSearchWorker == NULL || generation != fReplaceGeneration
+		|| !fSearchWorker->IsCurrent(generation, true)) {
+		return;
+	}
+
+	BMessage done(MSG_REPLACE_DONE);
+	done.AddPointer("source", this);
+
+	const char* error = NULL;
+	int32 count = result->GetInt32("count", 0);
+	if (result->FindString("error", &error) == B_OK) {
+		done.AddString("error", error);
+		count = 0;
+	} else if ((uint32)result->GetInt32("revision", 0) != fRevision) {
+		// the text was edited while the worker was replacing
+		done.AddInt32("status", B_CANCELED);
+		count = 0;
+	} else if (count > 0) {
+		SVGPieceList pieces;
+		int32 length = result->GetInt32("length", 0);
+		if (block != NULL && length > 0)
+			pieces.push_back(SVGTextPiece(block, 0, length));
+		_ReplaceText(result->GetInt32("start", 0), result->GetInt32("end", 0), pieces);
+	}
+
+	done.AddInt32("count", count);
+
+	BWindow* window = Window();
+	if (window)
+		window->PostMessage(&done);
+}
+
+// Replaces [start, end) as a single undo step, which is how a replace-all
+// gets applied: the text from its first to its last match is rewritten at
+// once, however many matches there are.
+void
+SVGTextEdit::_ReplaceText(int32 start, int32 end, const SVGPieceList& pieces)
+{
+	if (start < 0 || end > TextLength() || start > end)
+		return;
+
+	BreakUndoGroup();
+
+	int32 length = SVGTextBuffer::PiecesLength(pieces);
+	UndoCommand* cmd = _CreateCommand(CMD_REPLACE_TEXT, start, length, pieces, NULL, false);
+	if (cmd != NULL) {
+		cmd->timestamp = system_time();
+		GetSelection(&cmd->selectionStart, &cmd->selectionEnd);
+
+		_ChargeCommand(cmd, false);
+		fBuffer.Delete(start, end, &cmd->replaced);
+		fBuffer.DetachPieces(cmd->replaced);
+		cmd->replacedLength = end - start;
+		if (_UndoKeepsRuns()) {
+			text_run_array* runs = RunArray(start, end);
+			if (runs != NULL && runs->count > 1)
+				cmd->replacedRuns = runs;
+			else
+				free(runs);
+		}
+
+		cmd->size = _CommandSize(cmd);
+		_ChargeCommand(cmd, true);
+
+		for (int32 i = 0; i < fRedoStack.CountItems(); i++)
+			_DeleteCommand((UndoCommand*)fRedoStack.ItemAt(i));
+		fRedoStack.MakeEmpty();
+
+		fUndoStack.AddItem(cmd);
+		_TrimUndoHistory();
+	} else
+		fBuffer.Delete(start, end);
+
+	_SetUndoRedoMode(true);
+	BTextView::DeleteText(start, end);
+	_NoteTextChange(start, end - start, 0);
+	if (length > 0)
+		_InsertPieces(start, pieces, NULL);
+	_SetUndoRedoMode(false);
+
+	Select(start, start);
+	ScrollToSelection();
+
+	fHasPresetHighlighting = false;
+	_RequestAsyncHighlighting();
+
+	BWindow* window = Window();
+	if (window) {
+		BMessage msg(MSG_TEXT_MODIFIED);
+		window->PostMessage(&msg);
+	}
+}
+
+void
+SVGTextEdit::_ResetHighlightState()
+{
+	fCheckpoints.clear();
+	fDirtyStart = 0;
+	fDirtyEnd = TextLength();
+}
+
 syntax_type
 SVGTextEdit::_DetectSyntaxType(const char* filename)
 {
@@ -728,11 +1807,12 @@ SVGTextEdit::_DetectSyntaxFromContent()
 
 void
 SVGTextEdit::_AddUndoCommand(command_type type, int32 offset, int32 length,
-						const char* text, const text_run_array* runs, bool canMerge)
+						const SVGPieceList& pieces, const text_run_array* runs,
+						bool canMerge)
 {
 	bigtime_t currentTime = system_time();
 
-	UndoCommand* newCmd = _CreateCommand(type, offset, length, text, runs, canMerge);
+	UndoCommand* newCmd = _CreateCommand(type, offset, length, pieces, runs, canMerge);
 	if (!newCmd)
 		return;
 
@@ -746,6 +1826,7 @@ SVGTextEdit::_AddUndoCommand(command_type type, int32 offset, int32 length,
 			_MergeCommands(lastCmd, newCmd);
 			_DeleteCommand(newCmd);
 			fLastOperationTime = currentTime;
+			_TrimUndoHistory();
 			return;
 		}
 	}
@@ -753,16 +1834,17 @@ SVGTextEdit::_AddUndoCommand(command_type type, int32 offset, int32 length,
 	fUndoStack.AddItem(newCmd);
 	fLastOperationTime = currentTime;
 
-	while (fUndoStack.CountItems() > fMaxUndoLevels) {
-		UndoCommand* oldCmd = (UndoCommand*)fUndoStack.RemoveItem((int32)0);
-		_DeleteCommand(oldCmd);
-	}
+	_TrimUndoHistory();
 }
 
 UndoCommand*
 SVGTextEdit::_CreateCommand(command_type type, int32 offset, int32 length,
-							const char* text, const text_run_array* runs, bool canMerge)
+							const SVGPieceList& pieces, const text_run_array* runs,
+							bool canMerge)
 {
+	if (SVGTextBuffer::PiecesLength(pieces) != length)
+		return NULL;
+
 	UndoCommand* cmd = new UndoCommand;
 	if (!cmd)
 		return NULL;
@@ -771,20 +1853,16 @@ SVGTextEdit::_CreateCommand(command_type type, int32 offset, int32 length,
 	cmd->offset = offset;
 	cmd->length = length;
 	cmd->canMerge = canMerge;
-	cmd->text = NULL;
-	cmd->runs = NULL;
-
-	if (text && length > 0) {
-		cmd->text = (char*)malloc(length + 1);
-		if (!cmd->text) {
-			delete cmd;
-			return NULL;
-		}
-		memcpy(cmd->text, text, length);
-		cmd->text[length] = '\0';
-	}
+	cmd->pieces = pieces;
+	fBuffer.DetachPieces(cmd->pieces);
+
+	// Highlighting restyles restored text anyway, and a single run is what
+	// the text gets when inserted without runs.
+	if (_UndoKeepsRuns() && runs != NULL && runs->count > 1)
+		cmd->runs = _CopyRunArray(runs);
 
-	cmd->runs = _CopyRunArray(runs);
+	cmd->size = _CommandSize(cmd);
+	_ChargeCommand(cmd, true);
 	return cmd;
 }
 
@@ -814,43 +1892,29 @@ SVGTextEdit::_MergeCommands(UndoCommand* target, UndoCommand* source)
 	if (!target || !source || target->type != source->type)
 		return;
 
+	_ChargeCommand(target, false);
+
 	if (target->type == CMD_INSERT_TEXT) {
-		int32 newLength = target->length + source->length;
-		char* newText = (char*)realloc(target->text, newLength + 1);
-		if (newText && source->text) {
-			target->text = newText;
-			memcpy(target->text + target->length, source->text, source->length);
-			target->text[newLength] = '\0';
-			target->length = newLength;
-		}
+		SVGTextBuffer::AppendPieces(target->pieces, source->pieces);
+		target->length += source->length;
 	} else if (target->type == CMD_DELETE_TEXT) {
 		if (source->offset + source->length == target->offset) {
-			int32 newLength = target->length + source->length;
-			char* newText = (char*)malloc(newLength + 1);
-			if (newText && source->text && target->text) {
-				memcpy(newText, source->text, source->length);
-				memcpy(newText + source->length, target->text, target->length);
-				newText[newLength] = '\0';
-				free(target->text);
-				target->text = newText;
-				target->length = newLength;
-				target->offset = source->offset;
-			} else {
-				free(newText);
-			}
+			// backspace: the new text goes in front
+			SVGPieceList pieces = source->pieces;
+			SVGTextBuffer::AppendPieces(pieces, target->pieces);
+			target->pieces.swap(pieces);
+			target->length += source->length;
+			target->offset = source->offset;
 		} else if (source->offset == target->offset) {
-			int32 newLength = target->length + source->length;
-			char* newText = (char*)realloc(target->text, newLength + 1);
-			if (newText && source->text) {
-				target->text = newText;
-				memcpy(target->text + target->length, source->text, source->length);
-				target->text[newLength] = '\0';
-				target->length = newLength;
-			}
+			SVGTextBuffer::AppendPieces(target->pieces, source->pieces);
+			target->length += source->length;
 		}
 	}
 
 	target->timestamp = source->timestamp;
+
+	target->size = _CommandSize(target);
+	_ChargeCommand(target, true);
 }
 
 bool
@@ -882,29 +1946,71 @@ SVGTextEdit::_ExecuteCommand(UndoCommand* cmd, bool isUndo)
 	switch (cmd->type) {
 		case CMD_INSERT_TEXT:
 			if (isUndo) {
+				fBuffer.Delete(cmd->offset, cmd->offset + cmd->length);
 				BTextView::DeleteText(cmd->offset, cmd->offset + cmd->length);
+				_NoteTextChange(cmd->offset, cmd->length, 0);
 				Select(cmd->selectionStart, cmd->selectionEnd);
 			} else {
-				BTextView::InsertText(cmd->text, cmd->length, cmd->offset, cmd->runs);
+				_InsertPieces(cmd->offset, cmd->pieces, cmd->runs);
 				Select(cmd->offset + cmd->length, cmd->offset + cmd->length);
 			}
 			break;
 
 		case CMD_DELETE_TEXT:
 			if (isUndo) {
-				BTextView::InsertText(cmd->text, cmd->length, cmd->offset, cmd->runs);
+				_InsertPieces(cmd->offset, cmd->pieces, cmd->runs);
 				Select(cmd->selectionStart, cmd->selectionEnd);
 			} else {
+				fBuffer.Delete(cmd->offset, cmd->offset + cmd->length);
 				BTextView::DeleteText(cmd->offset, cmd->offset + cmd->length);
+				_NoteTextChange(cmd->offset, cmd->length, 0);
+				Select(cmd->offset, cmd->offset);
+			}
+			break;
+
+		case CMD_REPLACE_TEXT:
+		{
+			int32 removedLength = isUndo ? cmd->length : cmd->replacedLength;
+			fBuffer.Delete(cmd->offset, cmd->offset + removedLength);
+			BTextView::DeleteText(cmd->offset, cmd->offset + removedLength);
+			_NoteTextChange(cmd->offset, removedLength, 0);
+
+			if (isUndo) {
+				_InsertPieces(cmd->offset, cmd->replaced, cmd->replacedRuns);
+				Select(cmd->selectionStart, cmd->selectionEnd);
+			} else {
+				_InsertPieces(cmd->offset, cmd->pieces, cmd->runs);
 				Select(cmd->offset, cmd->offset);
 			}
 			break;
+		}
 
 		default:
 			break;
 	}
 }
 
+// Puts the text of an undo command back. The buffer gets the same pieces
+// again; BTextView keeps its own copy of the text and needs the bytes.
+void
+SVGTextEdit::_InsertPieces(int32 offset, const SVGPieceList& pieces,
+	const text_run_array* runs)
+{
+	int32 length = SVGTextBuffer::PiecesLength(pieces);
+	char* text = (char*)malloc(length + 1);
+	if (text == NULL)
+		return;
+
+	SVGTextBuffer::CopyPieces(pieces, text);
+	text[length] = '\0';
+
+	fBuffer.InsertPieces(offset, pieces);
+	BTextView::InsertText(text, length, offset, runs);
+	_NoteTextChange(offset, 0, length);
+
+	free(text);
+}
+
 text_run_array*
 SVGTextEdit::_CopyRunArray(const text_run_array* runs)
 {
@@ -922,5 +2028,81 @@ SVGTextEdit::_CopyRunArray(const text_run_array* runs)
 void
 SVGTextEdit::_DeleteCommand(UndoCommand* cmd)
 {
+	if (cmd == NULL)
+		return;
+
+	_ChargeCommand(cmd, false);
 	delete cmd;
 }
+
+// What a command takes besides its text: its runs and bookkeeping.
+size_t
+SVGTextEdit::_CommandSize(const UndoCommand* cmd) const
+{
+	size_t size = sizeof(UndoCommand)
+		+ (cmd->pieces.capacity() + cmd->replaced.capacity()) * sizeof(SVGTextPiece);
+
+	if (cmd->runs != NULL && cmd->runs->count > 0)
+		size += sizeof(text_run_array) + (cmd->runs->count - 1) * sizeof(text_run);
+	if (cmd->replacedRuns != NULL && cmd->replacedRuns->count > 0)
+		size += sizeof(text_run_array) + (cmd->replacedRuns->count - 1) * sizeof(text_run);
+
+	return size;
+}
+
+// Adds a command to the memory of the history, or takes it out again. Its
+// pieces must not change in between.
+void
+SVGTextEdit::_ChargeCommand(const UndoCommand* cmd, bool charge)
+{
+	if (charge)
+		fUndoMemory += cmd->size;
+	else
+		fUndoMemory -= cmd->size;
+
+	_ChargeBlocks(cmd->pieces, charge);
+	_ChargeBlocks(cmd->replaced, charge);
+}
+
+// The text is charged by the blocks that hold it, each block once at its
+// full capacity for as long as any piece of the history refers to it.
+// Pieces keep whole blocks alive, and blocks are shared between commands,
+// so counting the text of every command would miss the former and count
+// the latter twice. Undo detaches small pieces from large blocks, which
+// keeps the charge close to the text.
+void
+SVGTextEdit::_ChargeBlocks(const SVGPieceList& pieces, bool charge)
+{
+	for (size_t i = 0; i < pieces.size(); i++) {
+		const SVGTextBlock* block = pieces[i].block.Get();
+		if (charge) {
+			if (fUndoBlocks[block]++ == 0)
+				fUndoMemory += block->Capacity();
+		} else if (--fUndoBlocks[block] == 0) {
+			fUndoMemory -= block->Capacity();
+			fUndoBlocks.erase(block);
+		}
+	}
+}
+
+// The history is trimmed from the oldest end to stay within the limit;
+// the latest command is always kept.
+void
+SVGTextEdit::_TrimUndoHistory()
+{
+	while (fUndoMemory > DEFAULT_UNDO_MEMORY_LIMIT && fRedoStack.CountItems() > 0) {
+		UndoCommand* oldCmd = (UndoCommand*)fRedoStack.RemoveItem((int32)0);
+		_DeleteCommand(oldCmd);
+	}
+
+	while (fUndoMemory > DEFAULT_UNDO_MEMORY_LIMIT && fUndoStack.CountItems() > 1) {
+		UndoCommand* oldCmd = (UndoCommand*)fUndoStack.RemoveItem((int32)0);
+		_DeleteCommand(oldCmd);
+	}
+}
+
+bool
+SVGTextEdit::_UndoKeepsRuns() const
+{
+	return fSyntaxType == SYNTAX_NONE && !fHasPresetHighlighting;
+}
@@ -17,6 +17,15 @@
 #include <String.h>
 #include <Window.h>
 
+#include <unordered_map>
+#include <vector>
+
+#include "SVGHighlightRange.h"
+#include "SVGSearchWorker.h"
+#include "SVGTextBuffer.h"
+#include "SVGTextSearch.h"
+#include "SVGTextSnapshot.h"
+
 enum command_type {
 	CMD_INSERT_TEXT,
 	CMD_DELETE_TEXT,
@@ -30,55 +39,92 @@ enum syntax_type {
 	SYNTAX_RDEF
 };
 
-enum highlight_type {
-	HIGHLIGHT_TEXT,
-	HIGHLIGHT_KEYWORD,
-	HIGHLIGHT_STRING,
-	HIGHLIGHT_COMMENT,
-	HIGHLIGHT_NUMBER,
-	HIGHLIGHT_OPERATOR,
-	HIGHLIGHT_TAG,
-	HIGHLIGHT_ATTRIBUTE,
-	HIGHLIGHT_PREPROCESSOR
-};
-
+// The text of a command is kept as pieces of the editor's text buffer,
+// which still hold the inserted or deleted bytes, so recording an edit
+// never copies text. A replace keeps the text it removed in replaced.
 struct UndoCommand {
 	command_type type;
 	int32 offset;
 	int32 length;
-	char* text;
+	SVGPieceList pieces;
 	text_run_array* runs;
+	int32 replacedLength;
+	SVGPieceList replaced;
+	text_run_array* replacedRuns;
 	int32 selectionStart;
 	int32 selectionEnd;
 	bigtime_t timestamp;
 	bool canMerge;
+	size_t size;
 
 	UndoCommand();
 	~UndoCommand();
 };
 
-struct HighlightRange {
-	int32 start;
-	int32 end;
-	highlight_type type;
-
-	HighlightRange(int32 s, int32 e, highlight_type t)
-		: start(s), end(e), type(t) {}
-};
-
 enum {
 	MSG_DELAYED_HIGHLIGHTING = 'dlhl',
 	MSG_HIGHLIGHT_REQUEST = 'hlrq',
 	MSG_HIGHLIGHT_RESULT = 'hlrs',
 	MSG_HIGHLIGHT_CANCEL = 'hlcn',
+	MSG_HIGHLIGHT_CONTINUE = 'hlct',
+	MSG_HIGHLIGHT_VIEWPORT = 'hlvp',
 	MSG_WORKER_QUIT = 'wqut'
 };
 
 enum {
-	DEFAULT_MAX_UNDO_LEVELS = 50,
+	DEFAULT_UNDO_MEMORY_LIMIT = 32 * 1024 * 1024,
 	MERGE_TIME_LIMIT_MICROSECONDS = 2000000,
 	HIGHLIGHT_DELAY_MICROSECONDS = 15000,
-	MAX_MERGEABLE_TEXT_LENGTH = 10
+	MAX_MERGEABLE_TEXT_LENGTH = 10,
+	HIGHLIGHT_CHECKPOINT_INTERVAL = 512,
+	HIGHLIGHT_LOOKAHEAD = 16,
+	HIGHLIGHT_CHUNK_SIZE = 65536,
+	HIGHLIGHT_VIEWPORT_MARGIN = 4096
+};
+
+// One incremental lexer run. It starts at a checkpoint before the edited
+// region and records a new checkpoint about every
+// HIGHLIGHT_CHECKPOINT_INTERVAL bytes where the lexer is between tokens.
+// It stops at the first old checkpoint at or after the end of the edit,
+// because from there on the text and therefore the old tokens are
+// unchanged. A pass may also be cut into chunks with SetLimit() and
+// Resume(), each chunk ending at a token boundary.
+class HighlightPass {
+public:
+	HighlightPass(int32 start, int32 convergeFrom,
+				const int32* oldCheckpoints, int32 oldCount);
+
+	int32 Start() const { return fStart; }
+	int32 End() const { return fEnd; }
+	int32 Position() const { return fEnd >= 0 ? fEnd : fStart; }
+	int32 ConvergeFrom() const { return fConvergeFrom; }
+	bool IsComplete() const { return fComplete; }
+	const std::vector<int32>& Checkpoints() const { return fCheckpoints; }
+
+	// Called by the lexer whenever it is between tokens. Returns true once
+	// the lexer has caught up with the previous result or reached the limit.
+	bool AtTokenBoundary(int32 pos);
+	// A token scan ran to the end of the text without finding its end, so
+	// later positions depend on everything after them: stop recording.
+	void LookaheadReachedEnd() { fRecording = false; }
+	void SetRecording(bool recording) { fRecording = recording; }
+	void SetLimit(int32 limit) { fLimit = limit; }
+	// Starts the next chunk where the previous one stopped.
+	void Resume(int32 limit);
+	void Finish(int32 length);
+
+private:
+	int32 fStart;
+	int32 fEnd;
+	int32 fLimit;
+	bool fComplete;
+	int32 fConvergeFrom;
+	const int32* fOldCheckpoints;
+	int32 fOldCount;
+	int32 fOldIndex;
+	int32 fNextCheckpoint;
+	bool fRecording;
+	std::vector<int32> fCheckpoints;
 };
 
 class HighlightWorker : public BLooper {
@@ -89,23 +135,47 @@ public:
 	virtual void MessageReceived(BMessage* message);
 	virtual bool QuitRequested();
 
-	void RequestHighlighting(const char* text, int32 length,
+	// Holds a reference to the snapshot until the request is done with it.
+	void RequestHighlighting(SVGTextSnapshot* snapshot,
 							syntax_type type, bigtime_t timestamp,
-							BMessenger target);
+							BMessenger target, int32 start = 0,
+							int32 convergeFrom = 0,
+							const int32* checkpoints = NULL,
+							int32 checkpointCount = 0);
+	void SetViewport(bigtime_t timestamp, int32 visibleStart, int32 visibleEnd);
 	void CancelRequests(bigtime_t beforeTime);
 	void Shutdown();
 
 private:
-	void _ProcessHighlighting(BMessage* request);
-	BMessage* _CreateHighlightResult(const char* text, int32 length, syntax_type type);
-	void _AnalyzeCppSyntax(const char* text, int32 length, BList* ranges);
-	void _AnalyzeSVGSyntax(const char* text, int32 length, BList* ranges);
-	void _AnalyzeRdefSyntax(const char* text, int32 length, BList* ranges);
-	void _AddRange(BList* ranges, int32 start, int32 end, highlight_type type);
+	bool _ProcessHighlighting(BMessage* request);
+	void _ReleaseRequest(BMessage* request);
+	void _ContinueHighlighting();
+	void _PreviewViewport(const char* text, int32 length);
+	void _FinishActiveRequest();
+	BMessage* _CreateHighlightResult(const char* text, int32 length, syntax_type type,
+							HighlightPass& pass);
+	void _AnalyzeCppSyntax(const char* text, int32 length,
+							std::vector<HighlightRange>* ranges);
+	void _AnalyzeSVGSyntax(const char* text, int32 length,
+							std::vector<HighlightRange>* ranges,
+							HighlightPass* pass = NULL);
+	void _AnalyzeRdefSyntax(const char* text, int32 length,
+							std::vector<HighlightRange>* ranges);
+	void _AddRange(std::vector<HighlightRange>* ranges, int32 start, int32 end,
+							highlight_type type);
 
 	volatile bool fShutdown;
 	bigtime_t fLastRequestTime;
 	thread_id fWorkerThread;
+
+	// The request being worked on chunk by chunk and its snapshot.
+	BMessage* fActiveRequest;
+	HighlightPass* fActivePass;
+	bigtime_t fActiveTimestamp;
+	int32 fViewportStart;
+	int32 fViewportEnd;
+	int32 fPreviewStart;
+	int32 fPreviewEnd;
 };
 
 class SVGTextEdit : public BTextView {
@@ -119,8 +189,11 @@ public:
 	virtual void KeyDown(const char* bytes, int32 numBytes);
 	virtual void MessageReceived(BMessage* message);
 	virtual void Select(int32 startOffset, int32 endOffset);
+	virtual void ScrollTo(BPoint where);
+	virtual void Draw(BRect updateRect);
 
 	void SetText(const char* text, const text_run_array* runs = NULL);
+	void SetHighlightedText(const char* text, const std::vector<HighlightRange>& ranges);
 
 	void Redo();
 	bool CanUndo() const;
@@ -131,24 +204,76 @@ public:
 	void ApplySyntaxHighlighting();
 	void SetSyntaxType(syntax_type type);
 	syntax_type GetSyntaxType() const { return fSyntaxType; }
+	// Changes with every edit, so equal revisions mean equal text.
+	uint32 Revision() const { return fRevision; }
 	void ForceHighlightRefresh();
-	bool Find(const char* text, bool forward = true, bool wrap = true);
+	bool Find(const char* text, bool forward = true, bool wrap = true,
+			uint32 flags = 0);
+
+	// Marks every match of text and returns how many there are. The matches
+	// follow later edits until the pattern changes or they are cleared.
+	// Regular expressions are searched in the background; the window gets
+	// MSG_SEARCH_PROGRESS while the matches come in.
+	int32 FindAll(const char* text, uint32 flags = 0);
+	void ClearSearchMatches();
+	const std::vector<SVGSearchMatch>& SearchMatches() const
+			{ return fSearchMatches; }
+	bool IsSearching() const { return fSearchRunning; }
+	// Why the pattern could not be used, or NULL.
+	const char* SearchError() const;
+	// Index of the match that is selected, or -1.
+	int32 SelectedSearchMatch() const;
+
+	// Replaces every match in the background and applies the result as one
+	// undoable edit. The window gets MSG_REPLACE_DONE with the "count".
+	void ReplaceAll(const char* text, const char* replacement, uint32 flags = 0);
 
 private:
 	void _RequestAsyncHighlighting();
 	void _SendHighlightRequest();
+	void _GetVisibleRange(int32* start, int32* end);
 	void _ApplyHighlightResult(BMessage* result);
 	void _CancelPendingHighlighting();
+	void _NoteTextChange(int32 offset, int32 removedLength, int32 insertedLength);
+	void _ResetHighlightState();
+	void _UpdateSearchMatches(int32 offset, int32 removedLength,
+						int32 insertedLength);
+	static void _FindInMatches(const std::vector<SVGSearchMatch>& matches,
+						int32 selStart, int32 selEnd, bool forward, bool wrap,
+						SVGSearchMatch* found);
+	void _InvalidateEditedLines(int32 start, int32 end, bool linesMoved,
+						bool marksChanged);
+	void _InvalidateMatches(const SVGSearchMatch* matches, int32 count);
+	void _InvalidateChangedMatches(const std::vector<SVGSearchMatch>& before,
+						const std::vector<SVGSearchMatch>& after);
+	SVGSearchWorker* _SearchWorker();
+	void _StartBackgroundSearch(bool streamMatches);
+	void _ApplySearchResult(BMessage* result);
+	void _ApplyReplaceResult(BMessage* result);
+	void _ReplaceText(int32 start, int32 end, const SVGPieceList& pieces);
+	SVGTextSnapshot* _Snapshot();
+	text_run_array* _CreatePresetRunArray(int32 textLength);
+	text_run_array* _CreateRunArray(const HighlightRange* ranges, int32 count,
+						int32 start, int32 end);
 	syntax_type _DetectSyntaxType(const char* filename = NULL);
 	syntax_type _DetectSyntaxFromContent();
 
 	void _AddUndoCommand(command_type type, int32 offset, int32 length,
-						const char* text, const text_run_array* runs, bool canMerge = true);
+						const SVGPieceList& pieces, const text_run_array* runs,
+						bool canMerge = true);
 	UndoCommand* _CreateCommand(command_type type, int32 offset, int32 length,
-						const char* text, const text_run_array* runs, bool canMerge = true);
+						const SVGPieceList& pieces, const text_run_array* runs,
+						bool canMerge = true);
 	void _ExecuteCommand(UndoCommand* cmd, bool isUndo);
+	void _InsertPieces(int32 offset, const SVGPieceList& pieces,
+						const text_run_array* runs);
 	text_run_array* _CopyRunArray(const text_run_array* runs);
 	void _DeleteCommand(UndoCommand* cmd);
+	size_t _CommandSize(const UndoCommand* cmd) const;
+	void _ChargeCommand(const UndoCommand* cmd, bool charge);
+	void _ChargeBlocks(const SVGPieceList& pieces, bool charge);
+	void _TrimUndoHistory();
+	bool _UndoKeepsRuns() const;
 	bool _ShouldMergeCommands(UndoCommand* last, UndoCommand* current);
 	void _MergeCommands(UndoCommand* target, UndoCommand* source);
 	bool _IsTypingOperation(const char* bytes, int32 numBytes);
@@ -159,7 +284,9 @@ private:
 private:
 	BList fUndoStack;
 	BList fRedoStack;
-	int32 fMaxUndoLevels;
+	size_t fUndoMemory;
+	// How many pieces of the history refer to each block
+	std::unordered_map<const SVGTextBlock*, int32> fUndoBlocks;
 	bool fInUndoRedo;
 	bigtime_t fLastOperationTime;
 	bigtime_t fMergeTimeLimit;
@@ -168,9 +295,40 @@ private:
 
 	HighlightWorker* fHighlightWorker;
 	bigtime_t fLastHighlightRequest;
-	BString fLastHighlightedText;
+	uint32 fHighlightedRevision;
 	BMessageRunner* fHighlightDelayRunner;
 	bool fForceHighlightUpdate;
+
+	SVGTextBuffer fBuffer;
+	uint32 fRevision;
+	BReference<SVGTextSnapshot> fSnapshot;
+
+	std::vector<int32> fCheckpoints;
+	int32 fDirtyStart;
+	int32 fDirtyEnd;
+	syntax_type fHighlightedSyntax;
+
+	std::vector<HighlightRange> fPresetRanges;
+	bool fHasPresetHighlighting;
+
+	SVGTextSearch fSearch;
+	std::vector<SVGSearchMatch> fSearchMatches;
+	// Background searches collect here until the last batch, unless they
+	// are the first for a pattern and can show their matches right away.
+	std::vector<SVGSearchMatch> fPendingMatches;
+	bool fStreamMatches;
+	bool fSearchRunning;
+	// As of the last edit, to tell when one moved the lines below it
+	int32 fLineCount;
+	// Every match of the last regular expression Find() went back with
+	std::vector<SVGSearchMatch> fFindMatches;
+	BString fFindMatchesPattern;
+	uint32 fFindMatchesFlags;
+	uint32 fFindMatchesRevision;
+	SVGSearchWorker* fSearchWorker;
+	int32 fFindGeneration;
+	int32 fReplaceGeneration;
+	int32 fReplaceFound;
 };
 
 #endif
@@ -60,7 +60,8 @@ _IsKeyword(const char* word, int32 length)
 }
 
 void
-HighlightWorker::_AnalyzeCppSyntax(const char* text, int32 length, BList* ranges)
+HighlightWorker::_AnalyzeCppSyntax(const char* text, int32 length,
+	std::vector<HighlightRange>* ranges)
 {
 	if (!text || length == 0 || !ranges)
 		return;
@@ -20,6 +20,7 @@ struct ColorScheme {
 	rgb_color tag;
 	rgb_color attribute;
 	rgb_color preprocessor;
+	rgb_color search_match;
 };
 
 static const ColorScheme kLightColors = {
@@ -31,7 +32,8 @@ static const ColorScheme kLightColors = {
 	{255, 140, 0, 255},     // operator
 	{0, 0, 128, 255},       // tag
 	{128, 0, 128, 255},     // attribute
-	{128, 0, 255, 255}      // preprocessor
+	{128, 0, 255, 255},     // preprocessor
+	{255, 200, 0, 96}       // search match, drawn over the text
 };
 
 static const ColorScheme kDarkColors = {
@@ -43,7 +45,8 @@ static const ColorScheme kDarkColors = {
 	{255, 200, 100, 255},   // operator
 	{150, 150, 255, 255},   // tag
 	{255, 150, 255, 255},   // attribute
-	{200, 150, 255, 255}    // preprocessor
+	{200, 150, 255, 255},   // preprocessor
+	{255, 200, 0, 72}       // search match, drawn over the text
 };
 
 enum syntax_type;
@@ -87,7 +87,8 @@ _IsRdefType(const char* word, int32 length)
 }
 
 void
-HighlightWorker::_AnalyzeRdefSyntax(const char* text, int32 length, BList* ranges)
+HighlightWorker::_AnalyzeRdefSyntax(const char* text, int32 length,
+	std::vector<HighlightRange>* ranges)
 {
 	if (!text || length == 0 || !ranges)
 		return;
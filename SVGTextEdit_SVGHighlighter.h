@@ -49,21 +49,19 @@ DetectSVGFromContent(const char* text, int32 length)
 }
 
 static void
-_AnalyzeXMLTag(const char* text, int32 start, int32 end, BList* ranges)
+_AnalyzeXMLTag(const char* text, int32 start, int32 end,
+	std::vector<HighlightRange>* ranges)
 {
 	// Add < and >
-	HighlightRange* range1 = new HighlightRange(start, start + 1, HIGHLIGHT_TAG);
-	if (range1) ranges->AddItem(range1);
+	ranges->push_back(HighlightRange(start, start + 1, HIGHLIGHT_TAG));
 
-	HighlightRange* range2 = new HighlightRange(end - 1, end, HIGHLIGHT_TAG);
-	if (range2) ranges->AddItem(range2);
+	ranges->push_back(HighlightRange(end - 1, end, HIGHLIGHT_TAG));
 
 	int32 pos = start + 1;
 
 	// Handle closing tags
 	if (pos < end && text[pos] == '/') {
-		HighlightRange* slashRange = new HighlightRange(pos, pos + 1, HIGHLIGHT_TAG);
-		if (slashRange) ranges->AddItem(slashRange);
+		ranges->push_back(HighlightRange(pos, pos + 1, HIGHLIGHT_TAG));
 		pos++;
 	}
 
@@ -74,8 +72,7 @@ _AnalyzeXMLTag(const char* text, int32 start, int32 end, BList* ranges)
 	}
 
 	if (pos > tagNameStart) {
-		HighlightRange* tagRange = new HighlightRange(tagNameStart, pos, HIGHLIGHT_TAG);
-		if (tagRange) ranges->AddItem(tagRange);
+		ranges->push_back(HighlightRange(tagNameStart, pos, HIGHLIGHT_TAG));
 	}
 
 	// Self-closing tag
@@ -102,8 +99,7 @@ _AnalyzeXMLTag(const char* text, int32 start, int32 end, BList* ranges)
 		}
 
 		if (pos > attrStart) {
-			HighlightRange* attrRange = new HighlightRange(attrStart, pos, HIGHLIGHT_ATTRIBUTE);
-			if (attrRange) ranges->AddItem(attrRange);
+			ranges->push_back(HighlightRange(attrStart, pos, HIGHLIGHT_ATTRIBUTE));
 		}
 
 		// Skip whitespace and =
@@ -123,28 +119,31 @@ _AnalyzeXMLTag(const char* text, int32 start, int32 end, BList* ranges)
 
 			if (pos < end - 1) {
 				pos++;
-				HighlightRange* valueRange = new HighlightRange(valueStart, pos, HIGHLIGHT_STRING);
-				if (valueRange) ranges->AddItem(valueRange);
+				ranges->push_back(HighlightRange(valueStart, pos, HIGHLIGHT_STRING));
 			}
 		}
 	}
 
 	// Handle self-closing tag
 	if (selfClosing && end >= 2) {
-		HighlightRange* closeRange = new HighlightRange(end - 2, end - 1, HIGHLIGHT_TAG);
-		if (closeRange) ranges->AddItem(closeRange);
+		ranges->push_back(HighlightRange(end - 2, end - 1, HIGHLIGHT_TAG));
 	}
 }
 
 void
-HighlightWorker::_AnalyzeSVGSyntax(const char* text, int32 length, BList* ranges)
+HighlightWorker::_AnalyzeSVGSyntax(const char* text, int32 length,
+	std::vector<HighlightRange>* ranges,
+	HighlightPass* pass)
 {
 	if (!text || length == 0 || !ranges)
 		return;
 
-	int32 pos = 0;
+	int32 pos = pass != NULL ? pass->Start() : 0;
 
 	while (pos < length && !fShutdown) {
+		if (pass != NULL && pass->AtTokenBoundary(pos))
+			break;
+
 		// XML Comments
 		if (pos + 4 <= length && strncmp(&text[pos], "<!--", 4) == 0) {
 			int32 commentEnd = pos + 4;
@@ -153,6 +152,8 @@ HighlightWorker::_AnalyzeSVGSyntax(const char* text, int32 length, BList* ranges
 			}
 			if (commentEnd + 3 <= length) {
 				commentEnd += 3;
+			} else if (pass != NULL) {
+				pass->LookaheadReachedEnd();
 			}
 			_AddRange(ranges, pos, commentEnd, HIGHLIGHT_COMMENT);
 			pos = commentEnd;
@@ -167,6 +168,8 @@ HighlightWorker::_AnalyzeSVGSyntax(const char* text, int32 length, BList* ranges
 			}
 			if (declEnd + 2 <= length) {
 				declEnd += 2;
+			} else if (pass != NULL) {
+				pass->LookaheadReachedEnd();
 			}
 			_AddRange(ranges, pos, declEnd, HIGHLIGHT_PREPROCESSOR);
 			pos = declEnd;
@@ -181,6 +184,8 @@ HighlightWorker::_AnalyzeSVGSyntax(const char* text, int32 length, BList* ranges
 			}
 			if (cdataEnd + 3 <= length) {
 				cdataEnd += 3;
+			} else if (pass != NULL) {
+				pass->LookaheadReachedEnd();
 			}
 			_AddRange(ranges, pos, cdataEnd, HIGHLIGHT_STRING);
 			pos = cdataEnd;
@@ -199,6 +204,8 @@ HighlightWorker::_AnalyzeSVGSyntax(const char* text, int32 length, BList* ranges
 				_AnalyzeXMLTag(text, pos, tagEnd, ranges);
 				pos = tagEnd;
 			} else {
+				if (pass != NULL)
+					pass->LookaheadReachedEnd();
 				pos++;
 			}
 		} else {
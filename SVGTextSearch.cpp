@@ -0,0 +1,367 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <ctype.h>
+#include <string.h>
+
+#include "SVGTextSearch.h"
+
+namespace {
+
+inline bool
+IsWordChar(uint8 c)
+{
+	// bytes of multibyte UTF-8 characters count as letters
+	return c >= 0x80 || isalnum(c) || c == '_';
+}
+
+} // namespace
+
+
+SVGTextSearch::SVGTextSearch()
+	:
+	fHasRegex(false)
+{
+	SetTo(NULL);
+}
+
+SVGTextSearch::SVGTextSearch(const char* pattern, uint32 flags)
+	:
+	fHasRegex(false)
+{
+	SetTo(pattern, flags);
+}
+
+SVGTextSearch::~SVGTextSearch()
+{
+	_FreeRegex();
+}
+
+status_t
+SVGTextSearch::SetTo(const char* pattern, uint32 flags)
+{
+	_FreeRegex();
+
+	fPattern = pattern;
+	fLength = fPattern.Length();
+	fFlags = flags;
+	fStatus = B_OK;
+	fError = "";
+
+	if ((flags & SEARCH_REGEX) != 0 && fLength > 0) {
+		int regexFlags = REG_EXTENDED | REG_NEWLINE;
+		if ((flags & SEARCH_IGNORE_CASE) != 0)
+			regexFlags |= REG_ICASE;
+
+		int error = regcomp(&fRegex, fPattern.String(), regexFlags);
+		if (error != 0) {
+			char message[256];
+			regerror(error, &fRegex, message, sizeof(message));
+			regfree(&fRegex);
+			fError = message;
+			fStatus = B_BAD_VALUE;
+			return fStatus;
+		}
+
+		fHasRegex = true;
+		return fStatus;
+	}
+
+	for (int32 i = 0; i < 256; i++) {
+		fFold[i] = (flags & SEARCH_IGNORE_CASE) != 0 ? tolower(i) : i;
+		fShift[i] = fLength;
+		fBackShift[i] = fLength;
+	}
+
+	fFolded = fPattern;
+	if ((flags & SEARCH_IGNORE_CASE) != 0)
+		fFolded.ToLower();
+
+	// Forward: how far the window may move when its last byte is c.
+	// Backward: the same for the first byte, looking at the pattern from
+	// its other end.
+	const uint8* folded = (const uint8*)fFolded.String();
+	for (int32 i = 0; i < fLength - 1; i++)
+		fShift[folded[i]] = fLength - 1 - i;
+	for (int32 i = fLength - 1; i > 0; i--)
+		fBackShift[folded[i]] = i;
+
+	return fStatus;
+}
+
+bool
+SVGTextSearch::FindNext(const char* text, int32 length, int32 from,
+	SVGSearchMatch* match) const
+{
+	if (text == NULL || fLength == 0 || fStatus != B_OK)
+		return false;
+
+	if (from < 0)
+		from = 0;
+
+	if (fHasRegex)
+		return _NextRegex(text, length, from, match);
+
+	int32 position = _Next((const uint8*)text, length, from, length - fLength + 1);
+	if (position < 0)
+		return false;
+
+	match->start = position;
+	match->length = fLength;
+	return true;
+}
+
+bool
+SVGTextSearch::FindPrevious(const char* text, int32 length, int32 end,
+	SVGSearchMatch* match) const
+{
+	if (text == NULL || fLength == 0 || fStatus != B_OK)
+		return false;
+
+	if (end > length)
+		end = length;
+
+	if (fHasRegex) {
+		// a regular expression can only be run forwards
+		bool found = false;
+		SVGSearchMatch next;
+		int32 position = 0;
+		while (position <= end && _NextRegex(text, length, position, &next)
+			&& next.start + next.length <= end) {
+			*match = next;
+			found = true;
+			position = next.start + (next.length > 0 ? next.length : 1);
+		}
+		return found;
+	}
+
+	const uint8* data = (const uint8*)text;
+	int32 position = end - fLength;
+	while (position >= 0) {
+		uint8 c = fFold[data[position]];
+		if (_Matches(data + position) && _IsWholeWord(data, length, position, fLength)) {
+			match->start = position;
+			match->length = fLength;
+			return true;
+		}
+		position -= fBackShift[c];
+	}
+
+	return false;
+}
+
+int32
+SVGTextSearch::FindAll(const char* text, int32 length, int32 from, int32 to,
+	std::vector<SVGSearchMatch>& matches) const
+{
+	if (text == NULL || fLength == 0 || fStatus != B_OK)
+		return 0;
+
+	if (from < 0)
+		from = 0;
+
+	int32 count = 0;
+	SVGSearchMatch match;
+
+	if (fHasRegex) {
+		if (to > length + 1)
+			to = length + 1;
+
+		int32 position = from;
+		while (position < to && _NextRegex(text, length, position, &match)
+			&& match.start < to) {
+			matches.push_back(match);
+			count++;
+
+			position = match.start + match.length;
+			if (match.length == 0) {
+				// step over the whole character after an empty match
+				position++;
+				while (position < length && (text[position] & 0xc0) == 0x80)
+					position++;
+			}
+		}
+		return count;
+	}
+
+	if (to > length - fLength + 1)
+		to = length - fLength + 1;
+
+	const uint8* data = (const uint8*)text;
+	match.length = fLength;
+	for (int32 position = _Next(data, length, from, to); position >= 0;
+			position = _Next(data, length, position + 1, to)) {
+		match.start = position;
+		matches.push_back(match);
+		count++;
+	}
+
+	return count;
+}
+
+void
+SVGTextSearch::AppendReplacement(const char* text, const char* replacement,
+	std::string& output) const
+{
+	if (replacement == NULL)
+		return;
+
+	if (!fHasRegex) {
+		output.append(replacement);
+		return;
+	}
+
+	const char* literal = replacement;
+	const char* c = replacement;
+	while (*c != '\0') {
+		if (*c != '\\' || c[1] == '\0') {
+			c++;
+			continue;
+		}
+
+		output.append(literal, c - literal);
+		char escaped = c[1];
+		if (escaped >= '0' && escaped <= '9') {
+			const regmatch_t& group = fGroups[escaped - '0'];
+			if (group.rm_so >= 0)
+				output.append(text + group.rm_so, group.rm_eo - group.rm_so);
+		} else if (escaped == 'n')
+			output += '\n';
+		else if (escaped == 't')
+			output += '\t';
+		else
+			output += escaped;
+
+		c += 2;
+		literal = c;
+	}
+
+	output.append(literal, c - literal);
+}
+
+// First match starting in [from, to), where to leaves room for the pattern.
+int32
+SVGTextSearch::_Next(const uint8* text, int32 length, int32 from, int32 to) const
+{
+	if (fLength == 1 && (fFlags & SEARCH_IGNORE_CASE) == 0) {
+		// a single byte is what memchr is made for
+		const uint8* position = text + from;
+		const uint8* end = text + to;
+		while (position < end) {
+			position = (const uint8*)memchr(position, fPattern[0], end - position);
+			if (position == NULL)
+				break;
+			if (_IsWholeWord(text, length, position - text, fLength))
+				return position - text;
+			position++;
+		}
+		return -1;
+	}
+
+	const uint8 last = fFolded[fLength - 1];
+	int32 position = from;
+	while (position < to) {
+		uint8 c = fFold[text[position + fLength - 1]];
+		if (c == last && _Matches(text + position)
+			&& _IsWholeWord(text, length, position, fLength)) {
+			return position;
+		}
+		position += fShift[c];
+	}
+
+	return -1;
+}
+
+// The match starts at or after from. Offsets in fGroups are relative to
+// text, which is what AppendReplacement() expects. For whole words, a
+// match inside a word is skipped and the search goes on one character
+// after its start.
+bool
+SVGTextSearch::_NextRegex(const char* text, int32 length, int32 from,
+	SVGSearchMatch* match) const
+{
+	while (_ExecRegex(text, length, from)) {
+		match->start = fGroups[0].rm_so;
+		match->length = fGroups[0].rm_eo - fGroups[0].rm_so;
+		if (_IsWholeWord((const uint8*)text, length, match->start, match->length))
+			return true;
+
+		from = match->start + 1;
+		while (from < length && (text[from] & 0xc0) == 0x80)
+			from++;
+	}
+
+	return false;
+}
+
+bool
+SVGTextSearch::_ExecRegex(const char* text, int32 length, int32 from) const
+{
+	if (from > length)
+		return false;
+
+#ifdef REG_STARTEND
+	// Searches [from, length) while '^' still sees the text before from.
+	fGroups[0].rm_so = from;
+	fGroups[0].rm_eo = length;
+	return regexec(&fRegex, text, 10, fGroups, REG_STARTEND) == 0;
+#else
+	// text is terminated; only the start has to be told about the line
+	int flags = from > 0 && text[from - 1] != '\n' ? REG_NOTBOL : 0;
+	if (regexec(&fRegex, text + from, 10, fGroups, flags) != 0)
+		return false;
+
+	for (int32 i = 0; i < 10; i++) {
+		if (fGroups[i].rm_so >= 0) {
+			fGroups[i].rm_so += from;
+			fGroups[i].rm_eo += from;
+		}
+	}
+	return true;
+#endif
+}
+
+bool
+SVGTextSearch::_Matches(const uint8* text) const
+{
+	const uint8* folded = (const uint8*)fFolded.String();
+	if ((fFlags & SEARCH_IGNORE_CASE) == 0)
+		return memcmp(text, folded, fLength) == 0;
+
+	for (int32 i = 0; i < fLength; i++) {
+		if (fFold[text[i]] != folded[i])
+			return false;
+	}
+	return true;
+}
+
+// Only edges of the match that are word characters need a boundary, so
+// "<rect" still matches "<rect" directly after a '>'. An empty match has
+// no edges.
+bool
+SVGTextSearch::_IsWholeWord(const uint8* text, int32 length, int32 offset,
+	int32 matchLength) const
+{
+	if ((fFlags & SEARCH_WHOLE_WORD) == 0 || matchLength <= 0)
+		return true;
+
+	if (offset > 0 && IsWordChar(text[offset]) && IsWordChar(text[offset - 1]))
+		return false;
+
+	int32 end = offset + matchLength;
+	if (end < length && IsWordChar(text[end - 1]) && IsWordChar(text[end]))
+		return false;
+
+	return true;
+}
+
+void
+SVGTextSearch::_FreeRegex()
+{
+	if (fHasRegex) {
+		regfree(&fRegex);
+		fHasRegex = false;
+	}
+}
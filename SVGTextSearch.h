@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_TEXT_SEARCH_H
+#define SVG_TEXT_SEARCH_H
+
+#include <String.h>
+#include <SupportDefs.h>
+
+#include <regex.h>
+#include <string>
+#include <vector>
+
+enum search_flags {
+	SEARCH_IGNORE_CASE	= 0x01,
+	SEARCH_WHOLE_WORD	= 0x02,
+	SEARCH_REGEX		= 0x04
+};
+
+struct SVGSearchMatch {
+	int32 start;
+	int32 length;
+};
+
+// Searches text that is already in memory, so looking for the next, the
+// previous or every match never copies the text being searched.
+//
+// Plain patterns use Boyer-Moore-Horspool with skip tables built once per
+// pattern; case is folded for ASCII only, other UTF-8 bytes must match
+// exactly. With SEARCH_REGEX the pattern is a POSIX extended regular
+// expression compiled with REG_NEWLINE, so a match never crosses a line
+// break, and the text must be terminated at its length. Whole-word
+// matching applies to both: a match may not start or end inside a word.
+class SVGTextSearch {
+public:
+	SVGTextSearch();
+	SVGTextSearch(const char* pattern, uint32 flags = 0);
+	~SVGTextSearch();
+
+	// Fails with B_BAD_VALUE for a regular expression that does not
+	// compile; ErrorString() says why.
+	status_t SetTo(const char* pattern, uint32 flags = 0);
+	status_t InitCheck() const { return fStatus; }
+	const char* ErrorString() const { return fError.String(); }
+
+	const char* Pattern() const { return fPattern.String(); }
+	int32 PatternLength() const { return fLength; }
+	uint32 Flags() const { return fFlags; }
+	bool IsRegex() const { return fHasRegex; }
+
+	// First match starting at or after from.
+	bool FindNext(const char* text, int32 length, int32 from,
+				SVGSearchMatch* match) const;
+	// Last match that ends at or before end.
+	bool FindPrevious(const char* text, int32 length, int32 end,
+				SVGSearchMatch* match) const;
+	// Appends all matches beginning in [from, to) and returns how many were
+	// added. Plain matches may overlap, regular expression matches do not.
+	int32 FindAll(const char* text, int32 length, int32 from, int32 to,
+				std::vector<SVGSearchMatch>& matches) const;
+
+	// Appends the replacement for the match FindNext() found last. In a
+	// regular expression replacement \0 to \9 stand for its groups, and \n,
+	// \t and \\ for a newline, a tab and a backslash.
+	void AppendReplacement(const char* text, const char* replacement,
+				std::string& output) const;
+
+private:
+	int32 _Next(const uint8* text, int32 length, int32 from, int32 to) const;
+	bool _NextRegex(const char* text, int32 length, int32 from,
+				SVGSearchMatch* match) const;
+	bool _ExecRegex(const char* text, int32 length, int32 from) const;
+	bool _Matches(const uint8* text) const;
+	bool _IsWholeWord(const uint8* text, int32 length, int32 offset,
+				int32 matchLength) const;
+	void _FreeRegex();
+
+	SVGTextSearch(const SVGTextSearch&);
+	SVGTextSearch& operator=(const SVGTextSearch&);
+
+	BString fPattern;
+	BString fFolded;
+	int32 fLength;
+	uint32 fFlags;
+	status_t fStatus;
+	BString fError;
+	uint8 fFold[256];
+	int32 fShift[256];
+	int32 fBackShift[256];
+
+	regex_t fRegex;
+	bool fHasRegex;
+	mutable regmatch_t fGroups[10];
+};
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <Autolock.h>
+
+#include <stdlib.h>
+
+#include "SVGTextSnapshot.h"
+
+SVGTextSnapshot::SVGTextSnapshot(const SVGPieceList& pieces, uint32 revision)
+	: fPieces(pieces),
+	fLength(SVGTextBuffer::PiecesLength(pieces)),
+	fRevision(revision),
+	fLock("svg_text_snapshot"),
+	fText(NULL)
+{
+}
+
+SVGTextSnapshot::~SVGTextSnapshot()
+{
+	free(fText);
+}
+
+const char*
+SVGTextSnapshot::Text() const
+{
+	BAutolock lock(fLock);
+
+	if (fText == NULL) {
+		fText = (char*)malloc(fLength + 1);
+		if (fText == NULL)
+			return NULL;
+
+		SVGTextBuffer::CopyPieces(fPieces, fText);
+		fText[fLength] = '\0';
+
+		// the pieces are not needed anymore, let go of their blocks
+		fPieces.clear();
+	}
+
+	return fText;
+}
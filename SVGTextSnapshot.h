@@ -0,0 +1,39 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_TEXT_SNAPSHOT_H
+#define SVG_TEXT_SNAPSHOT_H
+
+#include <Locker.h>
+#include <Referenceable.h>
+#include <SupportDefs.h>
+
+#include "SVGTextBuffer.h"
+
+// Immutable view of the editor text at one edit revision. The editor makes
+// at most one per revision and hands the same snapshot to every request
+// until the text changes again; whoever reads it on another thread holds a
+// reference for as long as it does. Creating one only copies the piece
+// list, the contiguous text is put together by the first Text() call.
+class SVGTextSnapshot : public BReferenceable {
+public:
+	SVGTextSnapshot(const SVGPieceList& pieces, uint32 revision);
+	virtual ~SVGTextSnapshot();
+
+	// NULL if the text could not be allocated.
+	const char* Text() const;
+	int32 Length() const { return fLength; }
+	uint32 Revision() const { return fRevision; }
+
+private:
+	mutable SVGPieceList fPieces;
+	int32 fLength;
+	uint32 fRevision;
+
+	mutable BLocker fLock;
+	mutable char* fText;
+};
+
+#endif
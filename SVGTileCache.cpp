@@ -0,0 +1,156 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <Bitmap.h>
+
+#include <string.h>
+
+#include "SVGTileCache.h"
+
+static const size_t kEntryOverhead = sizeof(TileKey) * 2 + sizeof(BBitmap) + 64;
+
+static inline size_t
+_TileSize(BBitmap* tile)
+{
+	return tile->BitsLength() + kEntryOverhead;
+}
+
+bool
+TileKey::operator==(const TileKey& other) const
+{
+	return scaleBits == other.scaleBits && x == other.x && y == other.y;
+}
+
+size_t
+TileKeyHash::operator()(const TileKey& key) const
+{
+	uint64 hash = ((uint64)(uint32)key.x << 32) | (uint32)key.y;
+	hash ^= (uint64)key.scaleBits * 0x9e3779b97f4a7c15ULL;
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	return (size_t)hash;
+}
+
+SVGTileCache::SVGTileCache(size_t budget)
+	: fBudget(budget),
+	fSize(0),
+	fFrame(0),
+	fInFrame(false)
+{
+}
+
+SVGTileCache::~SVGTileCache()
+{
+	Clear();
+}
+
+// Zooming in and out again by the same step rarely gets back to exactly the
+// same float. Rounding the scale to 17 significant bits gives those the
+// same tiles, while real zoom levels stay far apart.
+float
+SVGTileCache::QuantizeScale(float scale)
+{
+	uint32 bits;
+	memcpy(&bits, &scale, sizeof(bits));
+	bits = (bits + 0x40) & ~(uint32)0x7f;
+	memcpy(&scale, &bits, sizeof(scale));
+	return scale;
+}
+
+TileKey
+SVGTileCache::MakeKey(float scale, int32 x, int32 y)
+{
+	TileKey key;
+	scale = QuantizeScale(scale);
+	memcpy(&key.scaleBits, &scale, sizeof(key.scaleBits));
+	key.x = x;
+	key.y = y;
+	return key;
+}
+
+void
+SVGTileCache::BeginFrame()
+{
+	fFrame++;
+	fInFrame = true;
+}
+
+void
+SVGTileCache::EndFrame()
+{
+	fInFrame = false;
+	_Evict();
+}
+
+BBitmap*
+SVGTileCache::Lookup(const TileKey& key)
+{
+	EntryMap::iterator it = fEntries.find(key);
+	if (it == fEntries.end())
+		return NULL;
+
+	fOrder.splice(fOrder.begin(), fOrder, it->second.position);
+	it->second.frame = fFrame;
+	return it->second.bitmap;
+}
+
+void
+SVGTileCache::Store(const TileKey& key, BBitmap* tile)
+{
+	if (tile == NULL)
+		return;
+
+	EntryMap::iterator it = fEntries.find(key);
+	if (it != fEntries.end()) {
+		fSize -= _TileSize(it->second.bitmap);
+		delete it->second.bitmap;
+		it->second.bitmap = tile;
+		it->second.frame = fFrame;
+		fOrder.splice(fOrder.begin(), fOrder, it->second.position);
+	} else {
+		fOrder.push_front(key);
+		Entry& entry = fEntries[key];
+		entry.bitmap = tile;
+		entry.position = fOrder.begin();
+		entry.frame = fFrame;
+	}
+
+	fSize += _TileSize(tile);
+	_Evict();
+}
+
+void
+SVGTileCache::Clear()
+{
+	for (EntryMap::iterator it = fEntries.begin(); it != fEntries.end(); it++)
+		delete it->second.bitmap;
+
+	fEntries.clear();
+	fOrder.clear();
+	fSize = 0;
+}
+
+// Neither the tiles of the current frame nor the one used last are
+// evicted, the view is about to draw them.
+void
+SVGTileCache::_Evict()
+{
+	std::list<TileKey>::iterator position = fOrder.end();
+	while (fSize > fBudget && position != fOrder.begin()) {
+		position--;
+		if (position == fOrder.begin())
+			break;
+
+		EntryMap::iterator it = fEntries.find(*position);
+		if (fInFrame && it->second.frame == fFrame)
+			continue;
+
+		fSize -= _TileSize(it->second.bitmap);
+		delete it->second.bitmap;
+		fEntries.erase(it);
+		position = fOrder.erase(position);
+	}
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_TILE_CACHE_H
+#define SVG_TILE_CACHE_H
+
+#include <SupportDefs.h>
+
+#include <list>
+#include <unordered_map>
+
+class BBitmap;
+
+struct TileKey {
+	uint32				scaleBits;
+	int32				x;
+	int32				y;
+
+	bool operator==(const TileKey& other) const;
+};
+
+struct TileKeyHash {
+	size_t operator()(const TileKey& key) const;
+};
+
+// Rasterized tiles of the document, keyed by the zoom level and the
+// position of the tile on the canvas at that zoom. Tile (x, y) covers
+// canvas pixels [x * kTileSize, (x + 1) * kTileSize) in both directions,
+// so panning reuses every tile and only needs the newly exposed ones.
+// Tiles are evicted in LRU order once their total size exceeds the budget,
+// except for those used by the frame being drawn.
+class SVGTileCache {
+public:
+	static const int32 kTileSize = 256;
+
+	SVGTileCache(size_t budget = 64 * 1024 * 1024);
+	~SVGTileCache();
+
+	// The zoom level a scale falls on.
+	static float QuantizeScale(float scale);
+	static TileKey MakeKey(float scale, int32 x, int32 y);
+
+	// Tiles looked up or stored between these stay in the cache until the
+	// frame ends, even if that takes it over the budget for a while.
+	void BeginFrame();
+	void EndFrame();
+
+	// The bitmap stays owned by the cache.
+	BBitmap* Lookup(const TileKey& key);
+	// Takes ownership of the bitmap.
+	void Store(const TileKey& key, BBitmap* tile);
+
+	void Clear();
+
+	size_t Size() const { return fSize; }
+	int32 CountTiles() const { return fEntries.size(); }
+
+private:
+	struct Entry {
+		BBitmap*					bitmap;
+		std::list<TileKey>::iterator	position;
+		uint32						frame;
+	};
+
+	typedef std::unordered_map<TileKey, Entry, TileKeyHash> EntryMap;
+
+	void _Evict();
+
+private:
+	EntryMap						fEntries;
+	std::list<TileKey>				fOrder;
+	size_t							fBudget;
+	size_t							fSize;
+	uint32							fFrame;
+	bool							fInFrame;
+};
+
+#endif
@@ -0,0 +1,410 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <Autolock.h>
+#include <Bitmap.h>
+#include <Message.h>
+#include <Region.h>
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#include "SVGConstants.h"
+#include "SVGTileRenderer.h"
+
+// How long a finished tile may wait for room in the target's port before
+// the thread checks whether it should quit.
+static const bigtime_t kDeliveryTimeout = 50000;
+
+// Pixels around the rendered rect whose shapes are drawn as well, for
+// antialiasing and the handles of highlighted control points.
+static const float kCullMargin = 16.0f;
+
+// Copies the top left part of source that target has room for.
+static void
+_CopyBits(const BBitmap* source, BBitmap* target)
+{
+	const uint8* from = (const uint8*)source->Bits();
+	uint8* to = (uint8*)target->Bits();
+	int32 rows = target->Bounds().IntegerHeight() + 1;
+	size_t rowLength = (target->Bounds().IntegerWidth() + 1) * 4;
+
+	for (int32 row = 0; row < rows; row++) {
+		memcpy(to, from, rowLength);
+		from += source->BytesPerRow();
+		to += target->BytesPerRow();
+	}
+}
+
+SVGTileSettings::SVGTileSettings()
+	: image(NULL),
+	scale(1.0f),
+	displayMode(0),
+	boundingBoxStyle(0),
+	transparency(false),
+	highlight(TILE_HIGHLIGHT_NONE),
+	highlightShape(-1),
+	highlightPath(-1),
+	bezierHandles(false),
+	shapeIndex(NULL)
+{
+	memset(&viewColor, 0, sizeof(viewColor));
+}
+
+bool
+SVGTileSettings::SameContent(const SVGTileSettings& other) const
+{
+	return image == other.image
+		&& displayMode == other.displayMode
+		&& boundingBoxStyle == other.boundingBoxStyle
+		&& transparency == other.transparency
+		&& viewColor == other.viewColor;
+}
+
+bool
+SVGTileSettings::SameHighlight(const SVGTileSettings& other) const
+{
+	return highlight == other.highlight
+		&& highlightShape == other.highlightShape
+		&& highlightPath == other.highlightPath
+		&& bezierHandles == other.bezierHandles;
+}
+
+
+SVGTileScene::SVGTileScene(const SVGTileSettings& tileSettings,
+	SVGDocument* tileDocument, int32 tileGeneration)
+	: settings(tileSettings),
+	document(tileDocument),
+	generation(tileGeneration)
+{
+}
+
+
+SVGTileRenderer::SVGTileRenderer()
+	: BSVGView("tile_renderer")
+{
+	memset(&fCulledImage, 0, sizeof(fCulledImage));
+}
+
+SVGTileRenderer::~SVGTileRenderer()
+{
+	fSVGImage = NULL;
+}
+
+void
+SVGTileRenderer::Render(const SVGTileSettings& settings, float offsetX,
+	float offsetY, BRect rect)
+{
+	int32 highlightShape = settings.highlightShape;
+
+	// The image has to be there before the highlight is applied, which
+	// refers to its shapes.
+	fSVGImage = _CullImage(settings, offsetX, offsetY, rect, &highlightShape);
+	fScale = settings.scale;
+	fOffsetX = offsetX;
+	fOffsetY = offsetY;
+	fAutoScale = false;
+
+	SetViewColor(settings.viewColor);
+	SetDisplayMode((svg_display_mode)settings.displayMode);
+	SetShowTransparency(settings.transparency);
+	SetBoundingBoxStyle((svg_boundingbox_style)settings.boundingBoxStyle);
+
+	ClearHighlight();
+	switch (settings.highlight) {
+		case TILE_HIGHLIGHT_SHAPE:
+			SetHighlightedShape(highlightShape);
+			break;
+		case TILE_HIGHLIGHT_PATH:
+			SetHighlightedPath(highlightShape, settings.highlightPath);
+			break;
+		case TILE_HIGHLIGHT_CONTROL_POINTS:
+			SetHighlightControlPoints(highlightShape, settings.highlightPath,
+				settings.bezierHandles);
+			break;
+	}
+
+	BRegion clipping(rect);
+	ConstrainClippingRegion(&clipping);
+	Draw(rect);
+	ConstrainClippingRegion(NULL);
+	Sync();
+
+	fSVGImage = NULL;
+}
+
+// Returns the image with only the shapes that can paint into rect, and
+// moves the highlighted shape to its place in it. The highlighted shape is
+// always kept, whatever the highlight draws around it.
+NSVGimage*
+SVGTileRenderer::_CullImage(const SVGTileSettings& settings, float offsetX,
+	float offsetY, BRect rect, int32* highlightShape)
+{
+	const SVGShapeIndex* index = settings.shapeIndex;
+	if (index == NULL || settings.scale <= 0)
+		return settings.image;
+
+	float margin = kCullMargin / settings.scale;
+	BRect area((rect.left - offsetX) / settings.scale - margin,
+		(rect.top - offsetY) / settings.scale - margin,
+		(rect.right + 1 - offsetX) / settings.scale + margin,
+		(rect.bottom + 1 - offsetY) / settings.scale + margin);
+
+	fVisibleShapes.clear();
+	index->FindShapes(area, fVisibleShapes);
+
+	if (settings.highlight != TILE_HIGHLIGHT_NONE && *highlightShape >= 0
+		&& *highlightShape < index->CountShapes()) {
+		std::vector<int32>::iterator it = std::lower_bound(fVisibleShapes.begin(),
+			fVisibleShapes.end(), *highlightShape);
+		if (it == fVisibleShapes.end() || *it != *highlightShape)
+			it = fVisibleShapes.insert(it, *highlightShape);
+		*highlightShape = it - fVisibleShapes.begin();
+	}
+
+	if ((int32)fVisibleShapes.size() == index->CountShapes())
+		return settings.image;
+
+	fCulledShapes.resize(fVisibleShapes.size());
+	for (size_t i = 0; i < fVisibleShapes.size(); i++) {
+		fCulledShapes[i] = *index->ShapeAt(fVisibleShapes[i]);
+		fCulledShapes[i].next = i + 1 < fCulledShapes.size() ? &fCulledShapes[i + 1] : NULL;
+	}
+
+	fCulledImage = *settings.image;
+	fCulledImage.shapes = fCulledShapes.empty() ? NULL : &fCulledShapes[0];
+	return &fCulledImage;
+}
+
+
+SVGTileRenderPool::SVGTileRenderPool(BMessenger target, int32 threadCount)
+	: fTarget(target),
+	fLock("tile_render_pool"),
+	fJobSemaphore(create_sem(0, "tile_render_jobs")),
+	fQuit(false)
+{
+	if (threadCount <= 0) {
+		system_info info;
+		get_system_info(&info);
+		threadCount = info.cpu_count > 0 ? info.cpu_count : 1;
+	}
+
+	for (int32 i = 0; i < threadCount; i++) {
+		thread_id thread = spawn_thread(_RenderThread, "tile_renderer",
+			B_NORMAL_PRIORITY, this);
+		if (thread < 0)
+			break;
+
+		fThreads.push_back(thread);
+		resume_thread(thread);
+	}
+}
+
+SVGTileRenderPool::~SVGTileRenderPool()
+{
+	fQuit = true;
+	delete_sem(fJobSemaphore);
+
+	for (size_t i = 0; i < fThreads.size(); i++) {
+		status_t result;
+		wait_for_thread(fThreads[i], &result);
+	}
+}
+
+void
+SVGTileRenderPool::SetScene(SVGTileScene* scene, int32 layer)
+{
+	BAutolock lock(fLock);
+	fScenes[layer].SetTo(scene);
+	fPending[layer].clear();
+
+	std::deque<Job>::iterator it = fQueue.begin();
+	while (it != fQueue.end()) {
+		if (it->layer == layer)
+			it = fQueue.erase(it);
+		else
+			it++;
+	}
+}
+
+void
+SVGTileRenderPool::Request(int32 x, int32 y, int32 layer)
+{
+	BAutolock lock(fLock);
+	SVGTileScene* scene = fScenes[layer].Get();
+	if (scene == NULL || fThreads.empty())
+		return;
+
+	TileKey key = SVGTileCache::MakeKey(scene->settings.scale, x, y);
+	if (!fPending[layer].insert(key).second)
+		return;
+
+	Job job;
+	job.scene = scene;
+	job.layer = layer;
+	job.x = x;
+	job.y = y;
+	job.draft = false;
+	job.factor = 1;
+	fQueue.push_back(job);
+
+	release_sem(fJobSemaphore);
+}
+
+void
+SVGTileRenderPool::RequestDraft(BRect rect, int32 factor)
+{
+	BAutolock lock(fLock);
+	if (fScenes[TILE_LAYER_CANVAS].Get() == NULL || fThreads.empty() || factor < 1)
+		return;
+
+	bool replaced = false;
+	for (std::deque<Job>::iterator it = fQueue.begin(); it != fQueue.end(); it++) {
+		if (it->draft) {
+			fQueue.erase(it);
+			replaced = true;
+			break;
+		}
+	}
+
+	Job job;
+	job.scene = fScenes[TILE_LAYER_CANVAS];
+	job.layer = TILE_LAYER_CANVAS;
+	job.x = 0;
+	job.y = 0;
+	job.draft = true;
+	job.rect = rect;
+	job.factor = factor;
+	fQueue.push_front(job);
+
+	if (!replaced)
+		release_sem(fJobSemaphore);
+}
+
+void
+SVGTileRenderPool::CancelQueued()
+{
+	BAutolock lock(fLock);
+	fQueue.clear();
+	for (int32 layer = 0; layer < TILE_LAYER_COUNT; layer++)
+		fPending[layer].clear();
+}
+
+status_t
+SVGTileRenderPool::_RenderThread(void* data)
+{
+	((SVGTileRenderPool*)data)->_Render();
+	return B_OK;
+}
+
+void
+SVGTileRenderPool::_Render()
+{
+	BRect bounds(0, 0, kDraftSize - 1, kDraftSize - 1);
+	BBitmap bitmap(bounds, B_BITMAP_ACCEPTS_VIEWS, B_RGB32);
+	if (bitmap.InitCheck() != B_OK)
+		return;
+
+	// deleted along with the bitmap
+	SVGTileRenderer* renderer = new SVGTileRenderer();
+	renderer->ResizeTo(bounds.Width(), bounds.Height());
+	if (!bitmap.Lock())
+		return;
+	bitmap.AddChild(renderer);
+	bitmap.Unlock();
+
+	while (!fQuit && acquire_sem(fJobSemaphore) == B_OK) {
+		Job job;
+		{
+			BAutolock lock(fLock);
+			if (fQueue.empty())
+				continue;
+			job = fQueue.front();
+			fQueue.pop_front();
+
+			// the scene changed while the job was waiting
+			if (job.scene.Get() != fScenes[job.layer].Get())
+				continue;
+		}
+
+		BBitmap* tile = _RenderJob(job, bitmap, renderer);
+
+		const SVGTileSettings& settings = job.scene->settings;
+		if (!job.draft) {
+			BAutolock lock(fLock);
+			if (job.scene.Get() == fScenes[job.layer].Get()) {
+				fPending[job.layer].erase(SVGTileCache::MakeKey(settings.scale,
+					job.x, job.y));
+			}
+		}
+
+		if (tile == NULL)
+			continue;
+
+		BMessage message(MSG_TILE_RENDERED);
+		message.AddPointer("tile", tile);
+		message.AddInt32("layer", job.layer);
+		message.AddFloat("scale", settings.scale);
+		message.AddInt32("generation", job.scene->generation);
+		if (job.draft) {
+			message.AddBool("draft", true);
+			message.AddRect("rect", job.rect);
+		} else {
+			message.AddInt32("x", job.x);
+			message.AddInt32("y", job.y);
+		}
+
+		if (!_Deliver(message))
+			delete tile;
+	}
+}
+
+BBitmap*
+SVGTileRenderPool::_RenderJob(const Job& job, BBitmap& bitmap,
+	SVGTileRenderer* renderer)
+{
+	const int32 tileSize = SVGTileCache::kTileSize;
+
+	SVGTileSettings settings = job.scene->settings;
+	BRect rect(0, 0, tileSize - 1, tileSize - 1);
+	float offsetX = -job.x * tileSize;
+	float offsetY = -job.y * tileSize;
+
+	if (job.draft) {
+		settings.scale /= job.factor;
+		offsetX = -job.rect.left / job.factor;
+		offsetY = -job.rect.top / job.factor;
+		rect.right = min_c(ceilf((job.rect.Width() + 1) / job.factor), kDraftSize) - 1;
+		rect.bottom = min_c(ceilf((job.rect.Height() + 1) / job.factor), kDraftSize) - 1;
+	}
+
+	if (!bitmap.Lock())
+		return NULL;
+	renderer->Render(settings, offsetX, offsetY, rect);
+	bitmap.Unlock();
+
+	BBitmap* tile = new BBitmap(rect, B_RGB32);
+	if (tile->InitCheck() != B_OK) {
+		delete tile;
+		return NULL;
+	}
+
+	_CopyBits(&bitmap, tile);
+	return tile;
+}
+
+bool
+SVGTileRenderPool::_Deliver(BMessage& message)
+{
+	while (!fQuit) {
+		status_t status = fTarget.SendMessage(&message, (BHandler*)NULL,
+			kDeliveryTimeout);
+		if (status != B_TIMED_OUT && status != B_WOULD_BLOCK)
+			return status == B_OK;
+	}
+
+	return false;
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef SVG_TILE_RENDERER_H
+#define SVG_TILE_RENDERER_H
+
+#include <Locker.h>
+#include <Messenger.h>
+#include <OS.h>
+#include <Referenceable.h>
+
+#include <deque>
+#include <unordered_set>
+#include <vector>
+
+#include "BSVGView.h"
+#include "SVGDocument.h"
+#include "SVGTileCache.h"
+
+enum tile_highlight {
+	TILE_HIGHLIGHT_NONE,
+	TILE_HIGHLIGHT_SHAPE,
+	TILE_HIGHLIGHT_PATH,
+	TILE_HIGHLIGHT_CONTROL_POINTS
+};
+
+// The plain canvas, and copies of the tiles under the highlight with
+// BSVGView's highlight drawn in, which the view shows in their place.
+enum tile_layer {
+	TILE_LAYER_CANVAS,
+	TILE_LAYER_HIGHLIGHT,
+	TILE_LAYER_COUNT
+};
+
+class BBitmap;
+
+// Everything the look of a tile depends on besides its position.
+struct SVGTileSettings {
+	NSVGimage*			image;
+	float				scale;
+	uint32				displayMode;
+	uint32				boundingBoxStyle;
+	bool				transparency;
+	rgb_color			viewColor;
+	uint32				highlight;
+	int32				highlightShape;
+	int32				highlightPath;
+	bool				bezierHandles;
+	// Of the image, to leave out the shapes outside the rendered rect
+	const SVGShapeIndex* shapeIndex;
+
+	SVGTileSettings();
+
+	// Equal apart from the scale and the highlight, so tiles of other zoom
+	// levels still apply and the canvas survives a new selection.
+	bool SameContent(const SVGTileSettings& other) const;
+	bool SameHighlight(const SVGTileSettings& other) const;
+};
+
+// Settings shared with the render threads. A scene is never changed once
+// created; tiles rendered from it carry its generation, which only
+// changes along with the content.
+struct SVGTileScene : public BReferenceable {
+	SVGTileSettings				settings;
+	BReference<SVGDocument>		document;
+	int32						generation;
+
+	SVGTileScene(const SVGTileSettings& tileSettings, SVGDocument* tileDocument,
+		int32 tileGeneration);
+};
+
+// Offscreen BSVGView that draws a part of the canvas into the bitmap it is
+// attached to, which has to be locked. The image is only borrowed for a
+// single Render() call.
+class SVGTileRenderer : public BSVGView {
+public:
+	SVGTileRenderer();
+	virtual ~SVGTileRenderer();
+
+	void Render(const SVGTileSettings& settings, float offsetX, float offsetY,
+			BRect rect);
+
+private:
+	NSVGimage* _CullImage(const SVGTileSettings& settings, float offsetX,
+			float offsetY, BRect rect, int32* highlightShape);
+
+private:
+	// Copies of the shapes that reach into the rect, linked in drawing
+	// order; their paths still belong to the image.
+	NSVGimage					fCulledImage;
+	std::vector<NSVGshape>		fCulledShapes;
+	std::vector<int32>			fVisibleShapes;
+};
+
+// Threads, one per CPU, that rasterize requested tiles of the current
+// scene of each layer, each with its own renderer and bitmap. Every
+// finished tile goes to the target as MSG_TILE_RENDERED with the "tile"
+// bitmap, which the receiver takes over, its "layer", "x", "y", "scale"
+// and the scene "generation". A draft of the canvas comes the same way
+// with "draft" set and the canvas "rect" it covers instead of a position.
+// Setting a new scene drops the tiles of its layer still waiting to be
+// rendered.
+class SVGTileRenderPool {
+public:
+	// The largest draft, in pixels on either side.
+	static const int32 kDraftSize = 2 * SVGTileCache::kTileSize;
+
+	SVGTileRenderPool(BMessenger target, int32 threadCount = 0);
+	~SVGTileRenderPool();
+
+	void SetScene(SVGTileScene* scene, int32 layer = TILE_LAYER_CANVAS);
+	// Requests of a tile that is already queued or rendering are ignored.
+	void Request(int32 x, int32 y, int32 layer = TILE_LAYER_CANVAS);
+	// Renders a canvas rect at 1 / factor of the scale in a single pass,
+	// ahead of any tile. Replaces a draft that has not been started yet.
+	void RequestDraft(BRect rect, int32 factor);
+	// Drops the tiles and the draft that are still waiting.
+	void CancelQueued();
+
+	int32 CountThreads() const { return fThreads.size(); }
+
+private:
+	struct Job {
+		BReference<SVGTileScene>	scene;
+		int32						layer;
+		int32						x;
+		int32						y;
+		bool						draft;
+		BRect						rect;
+		int32						factor;
+	};
+
+	static status_t _RenderThread(void* data);
+	void _Render();
+	BBitmap* _RenderJob(const Job& job, BBitmap& bitmap, SVGTileRenderer* renderer);
+	bool _Deliver(BMessage& message);
+
+private:
+	BMessenger						fTarget;
+	BLocker							fLock;
+	sem_id							fJobSemaphore;
+	std::deque<Job>					fQueue;
+	std::unordered_set<TileKey, TileKeyHash> fPending[TILE_LAYER_COUNT];
+	BReference<SVGTileScene>		fScenes[TILE_LAYER_COUNT];
+	std::vector<thread_id>			fThreads;
+	volatile bool					fQuit;
+};
+
+#endif
@@ -14,6 +14,7 @@
 #include <Catalog.h>
 
 #include <fs_attr.h>
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -28,15 +29,74 @@ const float SVGView::kScaleStep = 1.2f;
 #undef B_TRANSLATION_CONTEXT
 #define B_TRANSLATION_CONTEXT "SVGView"
 
+// Full quality tiles are rendered once zooming and panning stopped for
+// this long.
+static const bigtime_t kRenderIdleDelay = 150000;
+
+// Drafts have at most 1 / kDraftFactor of the pixels on either side.
+static const int32 kDraftFactor = 4;
+
+// Tiles of the last full render drawn into a single missing tile at most,
+// so zooming far out does not blit half the cache.
+static const int32 kMaxPreviewTiles = 16;
+
+// How far the mouse may move between press and release of a click,
+// and how close a click has to be to a shape to select it, in pixels.
+static const float kClickSlop = 3.0f;
+static const float kHitTolerance = 2.0f;
+
+// How far BSVGView's highlight may reach past the points of the
+// highlighted path, with its outline and the marks on control points,
+// in pixels.
+static const float kHighlightMargin = 8.0f;
+
+static inline int32
+_TileIndex(float position)
+{
+	return (int32)floorf(position / SVGTileCache::kTileSize);
+}
+
+static inline BPoint
+_ViewPoint(const float* point, BPoint origin, float scale)
+{
+	return BPoint(origin.x + point[0] * scale, origin.y + point[1] * scale);
+}
+
+static inline bool
+_SameZoomLevel(float scale, float otherScale)
+{
+	return SVGTileCache::QuantizeScale(scale) == SVGTileCache::QuantizeScale(otherScale);
+}
+
 SVGView::SVGView(const char* name)
 	: BSVGView(name),
 	fIsDragging(false),
 	fIsRightDragging(false),
+	fIsClick(false),
 	fTarget(NULL),
 	fPlaceholderIcon(NULL),
 	fVectorizationBitmap(NULL),
-	fShowVectorizationBitmap(false)
+	fShowVectorizationBitmap(false),
+	fTilePool(NULL),
+	fRenderBitmap(NULL),
+	fTileRenderer(NULL),
+	fInteractive(false),
+	fIdleRunner(NULL),
+	fLastInput(0),
+	fPreviewScale(0),
+	fDraft(NULL),
+	fDraftScale(0),
+	fDraftGeneration(-1),
+	fRequestedDraftScale(0),
+	fRequestedDraftGeneration(-1),
+	fHighlight(TILE_HIGHLIGHT_NONE),
+	fHighlightShape(-1),
+	fHighlightPath(-1),
+	fHighlightBezierHandles(false)
 {
+	for (int32 layer = 0; layer < TILE_LAYER_COUNT; layer++)
+		fTileGenerations[layer] = 0;
+
 	SetExplicitMinSize(BSize(256, 192));
 	SetFlags(Flags() | B_FULL_UPDATE_ON_RESIZE);
 	fPlaceholderIcon = SVGApplication::GetIcon(NULL, 128);
@@ -44,7 +104,13 @@ SVGView::SVGView(const char* name)
 
 SVGView::~SVGView()
 {
+	delete fIdleRunner;
+	delete fTilePool;
+	delete fDraft;
+	_DetachDocument();
 	delete fVectorizationBitmap;
+	// also deletes the renderer attached to it
+	delete fRenderBitmap;
 }
 
 void
@@ -53,7 +119,14 @@ SVGView::Draw(BRect updateRect)
 	if (fShowVectorizationBitmap && fVectorizationBitmap) {
 		_DrawVectorizationBitmap();
 	} else if (IsLoaded()) {
-		BSVGView::Draw(updateRect);
+		for (int32 layer = 0; layer < TILE_LAYER_COUNT; layer++)
+			fTileCaches[layer].BeginFrame();
+
+		if (!_DrawTiles(updateRect))
+			BSVGView::Draw(updateRect);
+
+		for (int32 layer = 0; layer < TILE_LAYER_COUNT; layer++)
+			fTileCaches[layer].EndFrame();
 	} else {
 		_DrawPlaceholder();
 	}
@@ -62,6 +135,495 @@ SVGView::Draw(BRect updateRect)
 		_DrawOverlayText(B_TRANSLATE("Hold the right mouse button to view the original raster image"));
 }
 
+// Draws the canvas from cached tiles. The canvas is the view shifted by
+// the offset rounded to whole pixels, so that panning moves the tiles
+// without changing them. Tiles the highlight reaches into come from the
+// highlight layer, or from the canvas until they are rendered. Missing
+// tiles of a document are left to the render threads and show a preview
+// until they arrive; an image without a document is only owned by this
+// view and is rendered here, in one pass over the bounding box of the
+// missing tiles.
+bool
+SVGView::_DrawTiles(BRect updateRect)
+{
+	_CheckTileState();
+
+	const int32 tileSize = SVGTileCache::kTileSize;
+	int32 originX = (int32)roundf(fOffsetX);
+	int32 originY = (int32)roundf(fOffsetY);
+
+	int32 firstX = _TileIndex(updateRect.left - originX);
+	int32 firstY = _TileIndex(updateRect.top - originY);
+	int32 lastX = _TileIndex(updateRect.right - originX);
+	int32 lastY = _TileIndex(updateRect.bottom - originY);
+
+	int32 highlightLeft = lastX + 1, highlightTop = lastY + 1;
+	int32 highlightRight = firstX - 1, highlightBottom = firstY - 1;
+	BRect highlightFrame = _HighlightFrame();
+	if (fTileScenes[TILE_LAYER_HIGHLIGHT].Get() != NULL && highlightFrame.IsValid()) {
+		highlightLeft = max_c(firstX, _TileIndex(highlightFrame.left - originX));
+		highlightTop = max_c(firstY, _TileIndex(highlightFrame.top - originY));
+		highlightRight = min_c(lastX, _TileIndex(highlightFrame.right - originX));
+		highlightBottom = min_c(lastY, _TileIndex(highlightFrame.bottom - originY));
+	}
+
+	bool threaded = fDocument.Get() != NULL;
+	if (threaded && fTilePool == NULL) {
+		fTilePool = new SVGTileRenderPool(BMessenger(this));
+		for (int32 layer = 0; layer < TILE_LAYER_COUNT; layer++)
+			fTilePool->SetScene(fTileScenes[layer].Get(), layer);
+	}
+
+	if (!threaded) {
+		if (!_RenderMissingTiles(TILE_LAYER_CANVAS, firstX, firstY, lastX, lastY))
+			return false;
+		// without them the canvas tiles are drawn instead
+		_RenderMissingTiles(TILE_LAYER_HIGHLIGHT, highlightLeft, highlightTop,
+			highlightRight, highlightBottom);
+	}
+
+	SetDrawingMode(B_OP_COPY);
+	SetHighColor(ui_color(B_PANEL_BACKGROUND_COLOR));
+	bool complete = true;
+	for (int32 y = firstY; y <= lastY; y++) {
+		for (int32 x = firstX; x <= lastX; x++) {
+			BPoint position(originX + x * tileSize, originY + y * tileSize);
+			TileKey key = SVGTileCache::MakeKey(fScale, x, y);
+
+			BBitmap* tile = NULL;
+			if (x >= highlightLeft && x <= highlightRight
+				&& y >= highlightTop && y <= highlightBottom) {
+				tile = fTileCaches[TILE_LAYER_HIGHLIGHT].Lookup(key);
+				if (tile == NULL && threaded && !fInteractive)
+					fTilePool->Request(x, y, TILE_LAYER_HIGHLIGHT);
+			}
+			if (tile == NULL)
+				tile = fTileCaches[TILE_LAYER_CANVAS].Lookup(key);
+
+			if (tile != NULL) {
+				DrawBitmap(tile, position);
+			} else if (threaded) {
+				if (!fInteractive)
+					fTilePool->Request(x, y);
+				_DrawTilePreview(x, y, BRect(position.x, position.y,
+					position.x + tileSize - 1, position.y + tileSize - 1));
+				complete = false;
+			} else
+				return false;
+		}
+	}
+
+	if (complete)
+		fPreviewScale = fScale;
+	else if (threaded)
+		_RequestDraft();
+
+	return true;
+}
+
+// Stands in for a tile that is not rendered yet: the draft, scaled if it
+// is from another zoom level, and over that the tiles of the last zoom
+// level that was drawn in full, scaled to the current one. A draft of the
+// current zoom level is closer to the final tile and comes last.
+void
+SVGView::_DrawTilePreview(int32 x, int32 y, BRect tileRect)
+{
+	const int32 tileSize = SVGTileCache::kTileSize;
+	float originX = roundf(fOffsetX);
+	float originY = roundf(fOffsetY);
+
+	FillRect(tileRect);
+
+	SVGTileScene* scene = fTileScenes[TILE_LAYER_CANVAS].Get();
+	bool hasDraft = fDraft != NULL && scene != NULL
+		&& fDraftGeneration == scene->generation;
+	BRect draftTarget;
+	if (hasDraft) {
+		float factor = fScale / fDraftScale;
+		draftTarget.Set(originX + fDraftRect.left * factor,
+			originY + fDraftRect.top * factor,
+			originX + (fDraftRect.right + 1) * factor - 1,
+			originY + (fDraftRect.bottom + 1) * factor - 1);
+		if (fDraftScale != fScale)
+			_DrawScaledBitmap(fDraft, draftTarget, tileRect);
+	}
+
+	if (fPreviewScale > 0 && fPreviewScale != fScale) {
+		float factor = fScale / fPreviewScale;
+		float previewSize = tileSize * factor;
+		int32 firstX = (int32)floorf(x * tileSize / previewSize);
+		int32 firstY = (int32)floorf(y * tileSize / previewSize);
+		int32 lastX = (int32)floorf(((x + 1) * tileSize - 1) / previewSize);
+		int32 lastY = (int32)floorf(((y + 1) * tileSize - 1) / previewSize);
+
+		if ((lastX - firstX + 1) * (lastY - firstY + 1) <= kMaxPreviewTiles) {
+			for (int32 previewY = firstY; previewY <= lastY; previewY++) {
+				for (int32 previewX = firstX; previewX <= lastX; previewX++) {
+					BBitmap* tile = fTileCaches[TILE_LAYER_CANVAS].Lookup(
+						SVGTileCache::MakeKey(fPreviewScale, previewX, previewY));
+					if (tile == NULL)
+						continue;
+
+					BRect target(originX + previewX * previewSize,
+						originY + previewY * previewSize,
+						originX + (previewX + 1) * previewSize - 1,
+						originY + (previewY + 1) * previewSize - 1);
+					_DrawScaledBitmap(tile, target, tileRect);
+				}
+			}
+		}
+	}
+
+	if (hasDraft && fDraftScale == fScale)
+		_DrawScaledBitmap(fDraft, draftTarget, tileRect);
+}
+
+// Draws the part of bitmap that falls into clip, with the whole bitmap
+// stretched over target.
+void
+SVGView::_DrawScaledBitmap(BBitmap* bitmap, BRect target, BRect clip)
+{
+	BRect destination = target & clip;
+	if (!destination.IsValid())
+		return;
+
+	BRect bounds = bitmap->Bounds();
+	float scaleX = (bounds.Width() + 1) / (target.Width() + 1);
+	float scaleY = (bounds.Height() + 1) / (target.Height() + 1);
+
+	BRect source((destination.left - target.left) * scaleX,
+		(destination.top - target.top) * scaleY,
+		(destination.right + 1 - target.left) * scaleX - 1,
+		(destination.bottom + 1 - target.top) * scaleY - 1);
+	DrawBitmap(bitmap, source, destination, B_FILTER_BITMAP_BILINEAR);
+}
+
+// Asks for a draft of the whole view unless one that covers it is there or
+// on its way. Drafts are rendered ahead of the tiles in a single pass at a
+// fraction of the resolution, which is quick even for large documents.
+void
+SVGView::_RequestDraft()
+{
+	SVGTileScene* scene = fTileScenes[TILE_LAYER_CANVAS].Get();
+	if (fTilePool == NULL || scene == NULL)
+		return;
+
+	BRect bounds = Bounds();
+	float originX = roundf(fOffsetX);
+	float originY = roundf(fOffsetY);
+	BRect canvas(floorf(bounds.left - originX), floorf(bounds.top - originY),
+		ceilf(bounds.right - originX), ceilf(bounds.bottom - originY));
+
+	int32 generation = scene->generation;
+	if (fDraft != NULL && fDraftScale == fScale && fDraftGeneration == generation
+		&& fDraftRect.Contains(canvas)) {
+		return;
+	}
+	if (fRequestedDraftScale == fScale && fRequestedDraftGeneration == generation
+		&& fRequestedDraftRect.Contains(canvas)) {
+		return;
+	}
+
+	const int32 draftSize = SVGTileRenderPool::kDraftSize;
+	int32 factor = kDraftFactor;
+	while (canvas.Width() + 1 > draftSize * factor
+		|| canvas.Height() + 1 > draftSize * factor) {
+		factor++;
+	}
+
+	fTilePool->RequestDraft(canvas, factor);
+	fRequestedDraftRect = canvas;
+	fRequestedDraftScale = fScale;
+	fRequestedDraftGeneration = generation;
+}
+
+void
+SVGView::_ApplyRenderedTile(BMessage* message)
+{
+	BBitmap* tile = NULL;
+	if (message->FindPointer("tile", (void**)&tile) != B_OK || tile == NULL)
+		return;
+
+	int32 layer = message->GetInt32("layer", TILE_LAYER_CANVAS);
+	int32 generation = message->GetInt32("generation", -1);
+	if (layer < 0 || layer >= TILE_LAYER_COUNT || fTileScenes[layer].Get() == NULL
+		|| generation != fTileScenes[layer]->generation) {
+		delete tile;
+		return;
+	}
+
+	if (message->GetBool("draft", false)) {
+		_ApplyDraft(message, tile);
+		return;
+	}
+
+	// tiles of another zoom level are kept for when it comes back
+	float scale = message->GetFloat("scale", 0);
+	int32 x = message->GetInt32("x", 0);
+	int32 y = message->GetInt32("y", 0);
+	fTileCaches[layer].Store(SVGTileCache::MakeKey(scale, x, y), tile);
+
+	if (_SameZoomLevel(scale, fScale)) {
+		const int32 tileSize = SVGTileCache::kTileSize;
+		float left = roundf(fOffsetX) + x * tileSize;
+		float top = roundf(fOffsetY) + y * tileSize;
+		Invalidate(BRect(left, top, left + tileSize - 1, top + tileSize - 1));
+	}
+}
+
+// Only the latest draft is kept; it replaces the previous one even when it
+// is of another zoom level, as it is always the closer one to the view.
+void
+SVGView::_ApplyDraft(BMessage* message, BBitmap* draft)
+{
+	delete fDraft;
+	fDraft = draft;
+	fDraftRect = message->GetRect("rect", BRect());
+	fDraftScale = message->GetFloat("scale", 0);
+	fDraftGeneration = message->GetInt32("generation", -1);
+
+	if (fDraftScale == fScale)
+		Invalidate();
+}
+
+// Renders the tiles of a layer that are missing from the given range, in
+// one pass over their bounding box.
+bool
+SVGView::_RenderMissingTiles(int32 layer, int32 firstX, int32 firstY,
+	int32 lastX, int32 lastY)
+{
+	int32 missingLeft = lastX + 1, missingTop = lastY + 1;
+	int32 missingRight = firstX - 1, missingBottom = firstY - 1;
+	for (int32 y = firstY; y <= lastY; y++) {
+		for (int32 x = firstX; x <= lastX; x++) {
+			if (fTileCaches[layer].Lookup(SVGTileCache::MakeKey(fScale, x, y)) != NULL)
+				continue;
+			missingLeft = min_c(missingLeft, x);
+			missingRight = max_c(missingRight, x);
+			missingTop = min_c(missingTop, y);
+			missingBottom = max_c(missingBottom, y);
+		}
+	}
+
+	if (missingLeft > missingRight)
+		return true;
+
+	return _RenderTiles(layer, missingLeft, missingTop,
+		missingRight - missingLeft + 1, missingBottom - missingTop + 1);
+}
+
+bool
+SVGView::_RenderTiles(int32 layer, int32 left, int32 top, int32 columns,
+	int32 rows)
+{
+	const int32 tileSize = SVGTileCache::kTileSize;
+	int32 width = columns * tileSize;
+	int32 height = rows * tileSize;
+
+	if (!_PrepareRenderer(width, height) || !fRenderBitmap->Lock())
+		return false;
+
+	fTileRenderer->Render(fTileScenes[layer]->settings, -left * tileSize, -top * tileSize,
+		BRect(0, 0, width - 1, height - 1));
+	fRenderBitmap->Unlock();
+
+	const uint8* bits = (const uint8*)fRenderBitmap->Bits();
+	int32 bytesPerRow = fRenderBitmap->BytesPerRow();
+	size_t tileRowLength = tileSize * 4;
+
+	for (int32 row = 0; row < rows; row++) {
+		for (int32 column = 0; column < columns; column++) {
+			BBitmap* tile = new BBitmap(BRect(0, 0, tileSize - 1, tileSize - 1), B_RGB32);
+			if (tile->InitCheck() != B_OK) {
+				delete tile;
+				return false;
+			}
+
+			const uint8* source = bits + row * tileSize * bytesPerRow
+				+ column * tileRowLength;
+			uint8* target = (uint8*)tile->Bits();
+			for (int32 line = 0; line < tileSize; line++) {
+				memcpy(target, source, tileRowLength);
+				source += bytesPerRow;
+				target += tile->BytesPerRow();
+			}
+
+			fTileCaches[layer].Store(SVGTileCache::MakeKey(fScale, left + column,
+				top + row), tile);
+		}
+	}
+
+	return true;
+}
+
+// The renderer bitmap only grows; it ends up as large as the view plus a
+// tile on each side, which is the most a single Draw() can be missing.
+bool
+SVGView::_PrepareRenderer(int32 width, int32 height)
+{
+	if (fRenderBitmap != NULL) {
+		BRect bounds = fRenderBitmap->Bounds();
+		if (bounds.IntegerWidth() + 1 >= width && bounds.IntegerHeight() + 1 >= height)
+			return true;
+
+		width = max_c(width, bounds.IntegerWidth() + 1);
+		height = max_c(height, bounds.IntegerHeight() + 1);
+	}
+
+	BRect frame(0, 0, width - 1, height - 1);
+	BBitmap* bitmap = new BBitmap(frame, B_BITMAP_ACCEPTS_VIEWS, B_RGB32);
+	if (bitmap->InitCheck() != B_OK) {
+		delete bitmap;
+		return false;
+	}
+
+	if (fTileRenderer == NULL)
+		fTileRenderer = new SVGTileRenderer();
+	else if (fRenderBitmap->Lock()) {
+		fRenderBitmap->RemoveChild(fTileRenderer);
+		fRenderBitmap->Unlock();
+	}
+
+	delete fRenderBitmap;
+	fRenderBitmap = bitmap;
+
+	fTileRenderer->ResizeTo(frame.Width(), frame.Height());
+	if (fRenderBitmap->Lock()) {
+		fRenderBitmap->AddChild(fTileRenderer);
+		fRenderBitmap->Unlock();
+	}
+
+	return true;
+}
+
+// Display options can be changed through BSVGView directly, so the tiles
+// are checked against them before each use. The highlight layer only has
+// a scene while something is highlighted.
+void
+SVGView::_CheckTileState()
+{
+	SVGTileSettings settings;
+	settings.image = fSVGImage;
+	settings.scale = fScale;
+	settings.displayMode = (uint32)DisplayMode();
+	settings.boundingBoxStyle = (uint32)BoundingBoxStyle();
+	settings.transparency = ShowTransparency();
+	settings.viewColor = ViewColor();
+	if (fDocument.Get() != NULL && fDocument->Image() == fSVGImage)
+		settings.shapeIndex = fDocument->ShapeIndex();
+
+	if (_UpdateScene(TILE_LAYER_CANVAS, settings))
+		_ClearPreviews();
+
+	if (fHighlight == TILE_HIGHLIGHT_NONE) {
+		if (fTileScenes[TILE_LAYER_HIGHLIGHT].Get() != NULL) {
+			fTileCaches[TILE_LAYER_HIGHLIGHT].Clear();
+			fTileScenes[TILE_LAYER_HIGHLIGHT].Unset();
+			if (fTilePool != NULL)
+				fTilePool->SetScene(NULL, TILE_LAYER_HIGHLIGHT);
+		}
+		return;
+	}
+
+	settings.highlight = fHighlight;
+	settings.highlightShape = fHighlightShape;
+	settings.highlightPath = fHighlightPath;
+	settings.bezierHandles = fHighlightBezierHandles;
+	_UpdateScene(TILE_LAYER_HIGHLIGHT, settings);
+}
+
+// Zooming only needs a new scene for the render threads; any other change
+// also drops the tiles of the layer, which this returns.
+bool
+SVGView::_UpdateScene(int32 layer, const SVGTileSettings& settings)
+{
+	SVGTileScene* current = fTileScenes[layer].Get();
+	bool sameContent = current != NULL && current->settings.SameContent(settings)
+		&& current->settings.SameHighlight(settings);
+	if (sameContent && _SameZoomLevel(current->settings.scale, settings.scale))
+		return false;
+
+	int32 generation = fTileGenerations[layer];
+	if (!sameContent) {
+		fTileCaches[layer].Clear();
+		generation = ++fTileGenerations[layer];
+	}
+
+	fTileScenes[layer].SetTo(new SVGTileScene(settings, fDocument.Get(), generation),
+		true);
+	if (fTilePool != NULL)
+		fTilePool->SetScene(fTileScenes[layer].Get(), layer);
+
+	return !sameContent;
+}
+
+// For changes the tile state cannot see, like a new image that happens to
+// reuse the address of the old one.
+void
+SVGView::_InvalidateTiles()
+{
+	for (int32 layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+		fTileCaches[layer].Clear();
+		fTileScenes[layer].Unset();
+	}
+	_ClearPreviews();
+}
+
+void
+SVGView::_ClearPreviews()
+{
+	delete fDraft;
+	fDraft = NULL;
+	fDraftGeneration = -1;
+	fRequestedDraftGeneration = -1;
+	fPreviewScale = 0;
+}
+
+// Called for every step of zooming and panning. Tiles still waiting are
+// for a view that is already gone, so they are dropped, and full quality
+// rendering waits until the input stops. A single runner lasts for the
+// whole interaction; each step only notes its time.
+void
+SVGView::_BeginInteraction()
+{
+	fInteractive = true;
+	fLastInput = system_time();
+	if (fTilePool != NULL) {
+		fTilePool->CancelQueued();
+		fRequestedDraftGeneration = -1;
+	}
+
+	if (fIdleRunner == NULL) {
+		BMessage message(MSG_RENDER_IDLE);
+		fIdleRunner = new BMessageRunner(BMessenger(this), &message, kRenderIdleDelay);
+	}
+}
+
+// Ends the interaction once there was no input for the idle delay, or
+// has the runner come back when it would be over.
+void
+SVGView::_CheckInteraction()
+{
+	if (!fInteractive)
+		return;
+
+	bigtime_t idle = system_time() - fLastInput;
+	if (idle < kRenderIdleDelay && fIdleRunner != NULL)
+		fIdleRunner->SetInterval(kRenderIdleDelay - idle);
+	else
+		_EndInteraction();
+}
+
+void
+SVGView::_EndInteraction()
+{
+	delete fIdleRunner;
+	fIdleRunner = NULL;
+
+	fInteractive = false;
+	Invalidate();
+}
+
 void
 SVGView::_DrawPlaceholder()
 {
@@ -218,6 +780,8 @@ SVGView::MouseDown(BPoint where)
 	if (buttons & B_PRIMARY_MOUSE_BUTTON) {
 		fIsDragging = true;
 		fIsRightDragging = false;
+		fIsClick = true;
+		fClickPosition = where;
 		fLastMousePosition = where;
 		SetMouseEventMask(B_POINTER_EVENTS, B_LOCK_WINDOW_FOCUS);
 	} else if (buttons & B_SECONDARY_MOUSE_BUTTON) {
@@ -236,13 +800,23 @@ SVGView::MouseDown(BPoint where)
 void
 SVGView::MouseUp(BPoint where)
 {
+	bool click = fIsDragging && fIsClick;
+
 	if (fIsDragging)
 		fIsDragging = false;
 	if (fIsRightDragging)
 		fIsRightDragging = false;
+	fIsClick = false;
 
-	fShowVectorizationBitmap = false;
-	Invalidate();
+	// Dragging has drawn the view already, and a click only changes the
+	// highlight, which repaints the part it covers by itself.
+	if (fShowVectorizationBitmap) {
+		fShowVectorizationBitmap = false;
+		Invalidate();
+	}
+
+	if (click)
+		_SelectShapeAt(where);
 }
 
 void
@@ -253,12 +827,48 @@ SVGView::MouseMoved(BPoint where, uint32 code, const BMessage* dragMessage)
 		fOffsetX += delta.x;
 		fOffsetY += delta.y;
 
+		if (fIsClick && (fabsf(where.x - fClickPosition.x) > kClickSlop
+				|| fabsf(where.y - fClickPosition.y) > kClickSlop)) {
+			fIsClick = false;
+		}
+
 		fLastMousePosition = where;
+		_BeginInteraction();
 		_UpdateStatus();
 		Invalidate();
 	}
 }
 
+// Highlights the topmost shape under a click and selects its source, the
+// way picking it in the structure view does. A click next to every shape
+// leaves the selection alone.
+void
+SVGView::_SelectShapeAt(BPoint where)
+{
+	SVGDocument* document = fDocument.Get();
+	if (document == NULL || document->Image() != fSVGImage || fScale <= 0)
+		return;
+
+	const SVGShapeIndex* index = document->ShapeIndex();
+	if (index == NULL)
+		return;
+
+	BPoint point((where.x - fOffsetX) / fScale, (where.y - fOffsetY) / fScale);
+	int32 shapeIndex = index->HitTest(point, kHitTolerance / fScale);
+	if (shapeIndex < 0)
+		return;
+
+	SetHighlightedShape(shapeIndex);
+
+	if (fTarget) {
+		NSVGshape* shape = index->ShapeAt(shapeIndex);
+		BMessage message(MSG_SET_SELECTION);
+		message.AddInt32("from", shape->start_pos);
+		message.AddInt32("to", shape->end_pos);
+		BMessenger(fTarget).SendMessage(&message);
+	}
+}
+
 void
 SVGView::MessageReceived(BMessage* message)
 {
@@ -292,6 +902,12 @@ SVGView::MessageReceived(BMessage* message)
 			ClearHighlight();
 			break;
 		}
+		case MSG_TILE_RENDERED:
+			_ApplyRenderedTile(message);
+			break;
+		case MSG_RENDER_IDLE:
+			_CheckInteraction();
+			break;
 		case B_MOUSE_WHEEL_CHANGED: {
 			if (!fSVGImage && !fVectorizationBitmap)
 				break;
@@ -376,9 +992,62 @@ SVGView::LoadFromFile(const char* filename, const char* units, float dpi)
 	if (!IsSVGFile(filename))
 		return B_ERROR;
 
+	_DetachDocument();
+	_InvalidateTiles();
 	return BSVGView::LoadFromFile(filename, units, dpi);
 }
 
+status_t
+SVGView::LoadFromMemory(const char* data, const char* units, float dpi)
+{
+	_DetachDocument();
+	_InvalidateTiles();
+	return BSVGView::LoadFromMemory(data, units, dpi);
+}
+
+status_t
+SVGView::SetDocument(SVGDocument* document)
+{
+	if (document == NULL || document->InitCheck() != B_OK)
+		return B_BAD_VALUE;
+
+	if (document == fDocument.Get())
+		return B_OK;
+
+	ClearHighlight();
+
+	if (fDocument.Get() != NULL)
+		_DetachDocument();
+	else if (fSVGImage)
+		nsvgDelete(fSVGImage);
+
+	// The image stays owned by the document; BSVGView only borrows it and
+	// _DetachDocument() takes it back before BSVGView could free it.
+	fDocument.SetTo(document);
+	fSVGImage = document->Image();
+	_InvalidateTiles();
+
+	if (fAutoScale)
+		_CalculateAutoScale();
+
+	_UpdateStatus();
+	Invalidate();
+
+	return B_OK;
+}
+
+void
+SVGView::_DetachDocument()
+{
+	if (fDocument.Get() == NULL)
+		return;
+
+	if (fSVGImage == fDocument->Image())
+		fSVGImage = NULL;
+
+	fDocument.Unset();
+}
+
 void
 SVGView::ZoomIn(BPoint center)
 {
@@ -446,6 +1115,116 @@ SVGView::ResetView()
 	}
 }
 
+void
+SVGView::StopRendering()
+{
+	delete fTilePool;
+	fTilePool = NULL;
+}
+
+void
+SVGView::SetHighlightedShape(int32 shapeIndex)
+{
+	BSVGView::SetHighlightedShape(shapeIndex);
+	_SetHighlight(TILE_HIGHLIGHT_SHAPE, shapeIndex, -1, false);
+}
+
+void
+SVGView::SetHighlightedPath(int32 shapeIndex, int32 pathIndex)
+{
+	BSVGView::SetHighlightedPath(shapeIndex, pathIndex);
+	_SetHighlight(TILE_HIGHLIGHT_PATH, shapeIndex, pathIndex, false);
+}
+
+void
+SVGView::SetHighlightControlPoints(int32 shapeIndex, int32 pathIndex,
+	bool showBezierHandles)
+{
+	BSVGView::SetHighlightControlPoints(shapeIndex, pathIndex, showBezierHandles);
+	_SetHighlight(TILE_HIGHLIGHT_CONTROL_POINTS, shapeIndex, pathIndex,
+		showBezierHandles);
+}
+
+void
+SVGView::ClearHighlight()
+{
+	BSVGView::ClearHighlight();
+	_SetHighlight(TILE_HIGHLIGHT_NONE, -1, -1, false);
+}
+
+// The canvas tiles stay; the next Draw() gives the highlight layer a new
+// scene and only the tiles under the old and the new highlight are drawn
+// again.
+void
+SVGView::_SetHighlight(tile_highlight highlight, int32 shapeIndex,
+	int32 pathIndex, bool bezierHandles)
+{
+	_InvalidateHighlight();
+	fHighlight = highlight;
+	fHighlightShape = shapeIndex;
+	fHighlightPath = pathIndex;
+	fHighlightBezierHandles = bezierHandles;
+	_InvalidateHighlight();
+}
+
+NSVGshape*
+SVGView::_HighlightedShape() const
+{
+	if (fHighlight == TILE_HIGHLIGHT_NONE || fSVGImage == NULL || fHighlightShape < 0)
+		return NULL;
+
+	if (fDocument.Get() != NULL && fDocument->Image() == fSVGImage
+		&& fDocument->ShapeIndex() != NULL) {
+		return fDocument->ShapeIndex()->ShapeAt(fHighlightShape);
+	}
+
+	NSVGshape* shape = fSVGImage->shapes;
+	for (int32 i = 0; shape != NULL && i < fHighlightShape; i++)
+		shape = shape->next;
+
+	return shape;
+}
+
+// The part of the view the highlight draws into. The control points of a
+// curve enclose it, so their bounds cover the outline and the handles.
+// The tiles it reaches into come from the highlight layer.
+BRect
+SVGView::_HighlightFrame() const
+{
+	NSVGshape* shape = _HighlightedShape();
+	if (shape == NULL)
+		return BRect();
+
+	float bounds[4] = { HUGE_VALF, HUGE_VALF, -HUGE_VALF, -HUGE_VALF };
+	int32 pathIndex = 0;
+	for (NSVGpath* path = shape->paths; path != NULL; path = path->next, pathIndex++) {
+		if (fHighlight != TILE_HIGHLIGHT_SHAPE && pathIndex != fHighlightPath)
+			continue;
+
+		for (int32 i = 0; i < path->npts; i++) {
+			bounds[0] = min_c(bounds[0], path->pts[i * 2]);
+			bounds[1] = min_c(bounds[1], path->pts[i * 2 + 1]);
+			bounds[2] = max_c(bounds[2], path->pts[i * 2]);
+			bounds[3] = max_c(bounds[3], path->pts[i * 2 + 1]);
+		}
+	}
+
+	if (bounds[0] > bounds[2])
+		return BRect();
+
+	BPoint origin(roundf(fOffsetX), roundf(fOffsetY));
+	BRect frame(_ViewPoint(bounds, origin, fScale), _ViewPoint(bounds + 2, origin, fScale));
+	return frame.InsetByCopy(-kHighlightMargin, -kHighlightMargin);
+}
+
+void
+SVGView::_InvalidateHighlight()
+{
+	BRect frame = _HighlightFrame();
+	if (frame.IsValid())
+		Invalidate(frame);
+}
+
 void
 SVGView::SetVectorizationBitmap(BBitmap* bitmap)
 {
@@ -508,6 +1287,7 @@ SVGView::_ZoomAtPoint(float newScale, BPoint zoomCenter)
 	fOffsetY = zoomCenter.y - (zoomCenter.y - fOffsetY) * scaleFactor;
 
 	fScale = newScale;
+	_BeginInteraction();
 	_UpdateStatus();
 	Invalidate();
 }
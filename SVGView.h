@@ -8,8 +8,13 @@
 
 #include <Invoker.h>
 #include <Bitmap.h>
+#include <MessageRunner.h>
+#include <Referenceable.h>
 
 #include "BSVGView.h"
+#include "SVGDocument.h"
+#include "SVGTileCache.h"
+#include "SVGTileRenderer.h"
 
 class SVGView : public BSVGView {
 public:
@@ -24,6 +29,10 @@ public:
 	
 	bool IsSVGFile(const char* filePath);
 	status_t LoadFromFile(const char* filename, const char* units = "px", float dpi = 96.0f);
+	status_t LoadFromMemory(const char* data, const char* units = "px", float dpi = 96.0f);
+
+	status_t SetDocument(SVGDocument* document);
+	SVGDocument* Document() const { return fDocument.Get(); }
 
 	void ZoomIn(BPoint center = BPoint(-1, -1));
 	void ZoomOut(BPoint center = BPoint(-1, -1));
@@ -32,6 +41,19 @@ public:
 
 	void ResetView();
 
+	// Stops the render threads. Tiles they sent before stay in the
+	// window's queue, and whoever drains it has to free their bitmaps.
+	void StopRendering();
+
+	// Set the BSVGView highlight, and have the tiles under it rendered again
+	// with it on the highlight layer. BSVGView has no hook for this, so a
+	// call through a BSVGView pointer only reaches BSVGView::Draw().
+	void SetHighlightedShape(int32 shapeIndex);
+	void SetHighlightedPath(int32 shapeIndex, int32 pathIndex);
+	void SetHighlightControlPoints(int32 shapeIndex, int32 pathIndex,
+			bool showBezierHandles);
+	void ClearHighlight();
+
 	void SetTarget(BHandler* target) { fTarget = target; }
 
 	void SetVectorizationBitmap(BBitmap* bitmap);
@@ -49,17 +71,75 @@ private:
 						vertical_alignment vertical = B_ALIGN_TOP, float margin = 10.0,
 						float padding = 8.0, float cornerRadius = 6.0);
 	BRect _GetVectorizationBitmapRect() const;
+	void _DetachDocument();
+	void _SelectShapeAt(BPoint where);
+
+	bool _DrawTiles(BRect updateRect);
+	void _DrawTilePreview(int32 x, int32 y, BRect tileRect);
+	void _DrawScaledBitmap(BBitmap* bitmap, BRect target, BRect clip);
+	void _RequestDraft();
+	void _ApplyRenderedTile(BMessage* message);
+	void _ApplyDraft(BMessage* message, BBitmap* draft);
+	bool _RenderMissingTiles(int32 layer, int32 firstX, int32 firstY,
+			int32 lastX, int32 lastY);
+	bool _RenderTiles(int32 layer, int32 left, int32 top, int32 columns,
+			int32 rows);
+	bool _PrepareRenderer(int32 width, int32 height);
+	void _CheckTileState();
+	bool _UpdateScene(int32 layer, const SVGTileSettings& settings);
+	void _InvalidateTiles();
+	void _ClearPreviews();
+	void _BeginInteraction();
+	void _CheckInteraction();
+	void _EndInteraction();
+
+	void _SetHighlight(tile_highlight highlight, int32 shapeIndex,
+			int32 pathIndex, bool bezierHandles);
+	NSVGshape* _HighlightedShape() const;
+	BRect _HighlightFrame() const;
+	void _InvalidateHighlight();
 
 private:
 	bool		fIsDragging;
 	bool		fIsRightDragging;
+	bool		fIsClick;
+	BPoint		fClickPosition;
 	BPoint		fLastMousePosition;
 	BHandler*	fTarget;
 	BBitmap*	fPlaceholderIcon;
 
+	BReference<SVGDocument> fDocument;
+
 	BBitmap*	fVectorizationBitmap;
 	bool		fShowVectorizationBitmap;
 
+	// Rasterized tiles of each layer, and what they are rendered from
+	SVGTileCache		fTileCaches[TILE_LAYER_COUNT];
+	BReference<SVGTileScene> fTileScenes[TILE_LAYER_COUNT];
+	int32				fTileGenerations[TILE_LAYER_COUNT];
+	SVGTileRenderPool*	fTilePool;
+	BBitmap*			fRenderBitmap;
+	SVGTileRenderer*	fTileRenderer;
+
+	// While zooming or panning only drafts are rendered, and missing tiles
+	// are filled with the draft or scaled tiles of the last full render.
+	bool				fInteractive;
+	BMessageRunner*		fIdleRunner;
+	bigtime_t			fLastInput;
+	float				fPreviewScale;
+	BBitmap*			fDraft;
+	BRect				fDraftRect;
+	float				fDraftScale;
+	int32				fDraftGeneration;
+	BRect				fRequestedDraftRect;
+	float				fRequestedDraftScale;
+	int32				fRequestedDraftGeneration;
+
+	tile_highlight	fHighlight;
+	int32			fHighlightShape;
+	int32			fHighlightPath;
+	bool			fHighlightBezierHandles;
+
 	static const float kMinScale;
 	static const float kMaxScale;
 	static const float kScaleStep;
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+// Compares the two ways a highlight result can carry its ranges: three
+// int32 fields per range, as the worker used to send them, and one packed
+// B_RAW_TYPE array of HighlightRange, as it does now. Each pass builds the
+// message, flattens and unflattens it like posting to another looper
+// does, and reads every range back.
+
+#include <Message.h>
+#include <OS.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "SVGHighlightRange.h"
+
+struct Timing {
+	bigtime_t	build;
+	bigtime_t	flatten;
+	bigtime_t	unflatten;
+	bigtime_t	read;
+	ssize_t		size;
+
+	Timing() : build(0), flatten(0), unflatten(0), read(0), size(0) {}
+};
+
+static void
+_MakeRanges(std::vector<HighlightRange>& ranges, int32 count)
+{
+	ranges.reserve(count);
+	int32 position = 0;
+	for (int32 i = 0; i < count; i++) {
+		int32 length = 1 + i % 13;
+		ranges.push_back(HighlightRange(position, position + length,
+			(highlight_type)(i % (HIGHLIGHT_PREPROCESSOR + 1))));
+		position += length + 1;
+	}
+}
+
+static status_t
+_Transfer(BMessage& message, Timing& timing, BMessage& received)
+{
+	bigtime_t start = system_time();
+	ssize_t size = message.FlattenedSize();
+	char* buffer = (char*)malloc(size);
+	if (buffer == NULL || message.Flatten(buffer, size) != B_OK) {
+		free(buffer);
+		return B_NO_MEMORY;
+	}
+	timing.flatten += system_time() - start;
+	timing.size = size;
+
+	start = system_time();
+	status_t status = received.Unflatten(buffer);
+	timing.unflatten += system_time() - start;
+
+	free(buffer);
+	return status;
+}
+
+static int64
+_RunFields(const std::vector<HighlightRange>& ranges, Timing& timing)
+{
+	bigtime_t start = system_time();
+	BMessage message('hlrs');
+	for (size_t i = 0; i < ranges.size(); i++) {
+		message.AddInt32("start", ranges[i].start);
+		message.AddInt32("end", ranges[i].end);
+		message.AddInt32("type", (int32)ranges[i].type);
+	}
+	timing.build += system_time() - start;
+
+	BMessage received;
+	if (_Transfer(message, timing, received) != B_OK)
+		return -1;
+
+	start = system_time();
+	int64 checksum = 0;
+	int32 rangeStart, rangeEnd, type;
+	for (int32 i = 0; received.FindInt32("start", i, &rangeStart) == B_OK
+			&& received.FindInt32("end", i, &rangeEnd) == B_OK
+			&& received.FindInt32("type", i, &type) == B_OK; i++) {
+		checksum += rangeStart + rangeEnd + type;
+	}
+	timing.read += system_time() - start;
+
+	return checksum;
+}
+
+static int64
+_RunPacked(const std::vector<HighlightRange>& ranges, Timing& timing)
+{
+	bigtime_t start = system_time();
+	BMessage message('hlrs');
+	message.AddData("ranges", B_RAW_TYPE, &ranges[0],
+		ranges.size() * sizeof(HighlightRange));
+	timing.build += system_time() - start;
+
+	BMessage received;
+	if (_Transfer(message, timing, received) != B_OK)
+		return -1;
+
+	start = system_time();
+	int64 checksum = 0;
+	const void* data = NULL;
+	ssize_t dataSize = 0;
+	if (received.FindData("ranges", B_RAW_TYPE, &data, &dataSize) == B_OK) {
+		const HighlightRange* packed = (const HighlightRange*)data;
+		int32 count = dataSize / sizeof(HighlightRange);
+		for (int32 i = 0; i < count; i++)
+			checksum += packed[i].start + packed[i].end + packed[i].type;
+	}
+	timing.read += system_time() - start;
+
+	return checksum;
+}
+
+static void
+_Print(const char* name, const Timing& timing, int32 passes)
+{
+	printf("%-8s build %8.2f  flatten %8.2f  unflatten %8.2f  read %8.2f"
+		"  total %8.2f ms  %7.1f KiB\n", name,
+		timing.build / 1000.0 / passes, timing.flatten / 1000.0 / passes,
+		timing.unflatten / 1000.0 / passes, timing.read / 1000.0 / passes,
+		(timing.build + timing.flatten + timing.unflatten + timing.read)
+			/ 1000.0 / passes,
+		timing.size / 1024.0);
+}
+
+int
+main(int argc, char** argv)
+{
+	int32 count = argc > 1 ? atoi(argv[1]) : 200000;
+	int32 passes = argc > 2 ? atoi(argv[2]) : 5;
+	if (count <= 0 || passes <= 0) {
+		fprintf(stderr, "Usage: %s [ranges] [passes]\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<HighlightRange> ranges;
+	_MakeRanges(ranges, count);
+
+	Timing fields;
+	Timing packed;
+	for (int32 pass = 0; pass < passes; pass++) {
+		int64 fieldsChecksum = _RunFields(ranges, fields);
+		int64 packedChecksum = _RunPacked(ranges, packed);
+		if (fieldsChecksum < 0 || fieldsChecksum != packedChecksum) {
+			fprintf(stderr, "The two encodings disagree\n");
+			return 1;
+		}
+	}
+
+	printf("%" B_PRId32 " ranges, average of %" B_PRId32 " passes\n", count, passes);
+	_Print("fields", fields, passes);
+	_Print("packed", packed, passes);
+	return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+// Times the steps of a regular expression replace-all over a generated SVG
+// with one fill="#rrggbb" per path: collecting every match, and building
+// the rewritten text the way SVGSearchWorker does before the editor
+// applies it as a single undo step. It also compares stepping back to the
+// previous match by searching again from the start of the text, which is
+// all a forward-only regular expression can do, with looking it up in the
+// match list the editor keeps.
+
+#include <OS.h>
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "SVGTextSearch.h"
+
+static const char* kPattern = "fill=\"#([0-9a-f]{6})\"";
+static const char* kReplacement = "fill=\"#\\1\" fill-opacity=\"0.5\"";
+
+static void
+_MakeDocument(std::string& text, int32 paths)
+{
+	text = "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"0 0 1000 1000\">\n";
+
+	char line[128];
+	for (int32 i = 0; i < paths; i++) {
+		snprintf(line, sizeof(line), "<path d=\"M%d %dL%d %dZ\" fill=\"#%06x\"/>\n",
+			(int)(i % 997), (int)(i % 991), (int)(i % 983), (int)(i % 977),
+			(unsigned)((i * 2654435761u) & 0xffffff));
+		text += line;
+	}
+
+	text += "</svg>\n";
+}
+
+static bool
+_StartsBefore(const SVGSearchMatch& match, int32 offset)
+{
+	return match.start < offset;
+}
+
+int
+main(int argc, char** argv)
+{
+	int32 paths = argc > 1 ? atoi(argv[1]) : 100000;
+	int32 steps = argc > 2 ? atoi(argv[2]) : 20;
+	if (paths <= 0 || steps <= 0) {
+		fprintf(stderr, "Usage: %s [paths] [steps]\n", argv[0]);
+		return 1;
+	}
+
+	std::string document;
+	_MakeDocument(document, paths);
+	const char* text = document.c_str();
+	int32 length = document.size();
+
+	SVGTextSearch search(kPattern, SEARCH_REGEX);
+	if (search.InitCheck() != B_OK) {
+		fprintf(stderr, "%s\n", search.ErrorString());
+		return 1;
+	}
+
+	bigtime_t start = system_time();
+	std::vector<SVGSearchMatch> matches;
+	search.FindAll(text, length, 0, length + 1, matches);
+	bigtime_t findTime = system_time() - start;
+
+	start = system_time();
+	std::string output;
+	int32 end = matches.empty() ? 0 : matches.front().start;
+	SVGSearchMatch match;
+	int32 position = 0;
+	int32 replaced = 0;
+	while (search.FindNext(text, length, position, &match)) {
+		output.append(text + end, match.start - end);
+		search.AppendReplacement(text, kReplacement, output);
+		end = match.start + match.length;
+		position = end;
+		replaced++;
+	}
+	bigtime_t replaceTime = system_time() - start;
+
+	if (replaced != (int32)matches.size()) {
+		fprintf(stderr, "FindAll() and FindNext() disagree\n");
+		return 1;
+	}
+
+	// Steps back from the end of the text, one match at a time.
+	start = system_time();
+	int32 rescanFound = 0;
+	int32 selection = length;
+	for (int32 i = 0; i < steps; i++) {
+		if (!search.FindPrevious(text, length, selection, &match))
+			break;
+		selection = match.start;
+		rescanFound += match.start;
+	}
+	bigtime_t rescanTime = system_time() - start;
+
+	start = system_time();
+	int32 listFound = 0;
+	selection = length;
+	for (int32 i = 0; i < steps; i++) {
+		std::vector<SVGSearchMatch>::const_iterator it = std::lower_bound(
+			matches.begin(), matches.end(), selection, _StartsBefore);
+		if (it == matches.begin())
+			break;
+		selection = (it - 1)->start;
+		listFound += selection;
+	}
+	bigtime_t listTime = system_time() - start;
+
+	if (rescanFound != listFound) {
+		fprintf(stderr, "The two ways back disagree\n");
+		return 1;
+	}
+
+	printf("%.1f KiB, %" B_PRId32 " matches\n", length / 1024.0, replaced);
+	printf("find all       %10.2f ms\n", findTime / 1000.0);
+	printf("replace all    %10.2f ms  %.1f KiB rewritten\n", replaceTime / 1000.0,
+		output.size() / 1024.0);
+	printf("back, rescan   %10.2f us per step\n", (double)rescanTime / steps);
+	printf("back, list     %10.2f us per step\n", (double)listTime / steps);
+	return 0;
+}
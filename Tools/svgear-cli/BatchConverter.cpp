@@ -0,0 +1,371 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <Autolock.h>
+#include <Directory.h>
+#include <Entry.h>
+#include <OS.h>
+#include <Path.h>
+#include <Referenceable.h>
+
+#include <glob.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "BatchConverter.h"
+#include "SVGDocument.h"
+#include "SVGExporter.h"
+#include "WorkStealingPool.h"
+
+static const struct {
+	uint32		format;
+	const char*	extension;
+} kOutputExtensions[] = {
+	{ BATCH_FORMAT_HVIF, ".hvif" },
+	{ BATCH_FORMAT_RDEF, ".rdef" },
+	{ BATCH_FORMAT_CPP, ".h" },
+	{ BATCH_FORMAT_IOM, ".iom" },
+	{ BATCH_FORMAT_PNG, ".png" }
+};
+
+static const int32 kOutputExtensionCount
+	= sizeof(kOutputExtensions) / sizeof(kOutputExtensions[0]);
+
+static bool
+_IsSVGPath(const char* path)
+{
+	BString name(path);
+	name.ToLower();
+	return name.EndsWith(".svg");
+}
+
+BatchOptions::BatchOptions()
+	: formats(BATCH_FORMAT_HVIF),
+	pngSize(64),
+	jobs(0),
+	recursive(false),
+	force(false),
+	quiet(false)
+{
+}
+
+BatchConverter::BatchConverter(const BatchOptions& options)
+	: fOptions(options),
+	fOutputLock("batch_output")
+{
+}
+
+status_t
+BatchConverter::CollectInputs(const char* pathOrPattern, bool recursive,
+	std::vector<BString>& files, std::vector<BString>* subdirectories)
+{
+	struct stat st;
+	if (stat(pathOrPattern, &st) == 0) {
+		if (S_ISDIR(st.st_mode))
+			_CollectDirectory(pathOrPattern, recursive, files, subdirectories, "");
+		else {
+			files.push_back(pathOrPattern);
+			if (subdirectories != NULL)
+				subdirectories->push_back("");
+		}
+		return B_OK;
+	}
+
+	glob_t matches;
+	if (glob(pathOrPattern, 0, NULL, &matches) != 0)
+		return B_ENTRY_NOT_FOUND;
+
+	for (size_t i = 0; i < matches.gl_pathc; i++) {
+		if (stat(matches.gl_pathv[i], &st) != 0)
+			continue;
+
+		if (S_ISDIR(st.st_mode))
+			_CollectDirectory(matches.gl_pathv[i], recursive, files, subdirectories, "");
+		else if (_IsSVGPath(matches.gl_pathv[i])) {
+			files.push_back(matches.gl_pathv[i]);
+			if (subdirectories != NULL)
+				subdirectories->push_back("");
+		}
+	}
+
+	globfree(&matches);
+	return B_OK;
+}
+
+void
+BatchConverter::_CollectDirectory(const char* path, bool recursive,
+	std::vector<BString>& files, std::vector<BString>* subdirectories,
+	const BString& subdirectory)
+{
+	BDirectory directory(path);
+	if (directory.InitCheck() != B_OK)
+		return;
+
+	BEntry entry;
+	while (directory.GetNextEntry(&entry) == B_OK) {
+		BPath entryPath;
+		if (entry.GetPath(&entryPath) != B_OK)
+			continue;
+
+		if (entry.IsDirectory()) {
+			if (recursive) {
+				BString child = subdirectory;
+				if (!child.IsEmpty())
+					child << "/";
+				child << entryPath.Leaf();
+				_CollectDirectory(entryPath.Path(), recursive, files, subdirectories,
+					child);
+			}
+		} else if (_IsSVGPath(entryPath.Path())) {
+			files.push_back(entryPath.Path());
+			if (subdirectories != NULL)
+				subdirectories->push_back(subdirectory);
+		}
+	}
+}
+
+status_t
+BatchConverter::AddInput(const char* pathOrPattern)
+{
+	std::vector<BString> files;
+	std::vector<BString> subdirectories;
+	status_t status = CollectInputs(pathOrPattern, fOptions.recursive, files,
+		&subdirectories);
+	if (status != B_OK)
+		return status;
+
+	for (size_t i = 0; i < files.size(); i++)
+		_AddFile(files[i].String(), subdirectories[i]);
+
+	return B_OK;
+}
+
+// With an output directory, the files of a directory tree keep their place
+// below it there. Two inputs that would still write the same files, like
+// equally named ones picked from two directories, fail instead of racing.
+void
+BatchConverter::_AddFile(const char* path, const BString& subdirectory)
+{
+	BatchItem item;
+	item.input = path;
+	item.status = B_OK;
+	item.skipped = false;
+	item.time = 0;
+
+	BPath inputPath(path);
+	BString leaf = inputPath.Leaf();
+	if (_IsSVGPath(leaf.String()))
+		leaf.Truncate(leaf.Length() - 4);
+
+	if (fOptions.outputDirectory.IsEmpty()) {
+		BPath parent;
+		inputPath.GetParent(&parent);
+		item.outputBase = parent.Path();
+	} else {
+		item.outputBase = fOptions.outputDirectory;
+		if (!subdirectory.IsEmpty())
+			item.outputBase << "/" << subdirectory;
+	}
+
+	item.outputBase << "/" << leaf;
+
+	std::map<BString, BString>::iterator output = fOutputs.find(item.outputBase);
+	if (output != fOutputs.end()) {
+		// the same file given twice
+		if (output->second == item.input)
+			return;
+
+		item.status = B_FILE_EXISTS;
+		item.error.SetToFormat("same output as %s", output->second.String());
+	} else
+		fOutputs[item.outputBase] = item.input;
+
+	fItems.push_back(item);
+}
+
+BString
+BatchConverter::_OutputPath(const BatchItem& item, uint32 format) const
+{
+	BString path = item.outputBase;
+
+	for (int32 i = 0; i < kOutputExtensionCount; i++) {
+		if (kOutputExtensions[i].format == format) {
+			path << kOutputExtensions[i].extension;
+			break;
+		}
+	}
+
+	return path;
+}
+
+bool
+BatchConverter::_IsUpToDate(const BatchItem& item) const
+{
+	struct stat input;
+	if (stat(item.input.String(), &input) != 0)
+		return false;
+
+	for (int32 i = 0; i < kOutputExtensionCount; i++) {
+		if ((fOptions.formats & kOutputExtensions[i].format) == 0)
+			continue;
+
+		struct stat output;
+		BString path = _OutputPath(item, kOutputExtensions[i].format);
+		if (stat(path.String(), &output) != 0 || output.st_mtime < input.st_mtime)
+			return false;
+	}
+
+	return true;
+}
+
+int32
+BatchConverter::Run()
+{
+	int32 jobs = fOptions.jobs;
+	if (jobs <= 0) {
+		system_info info;
+		get_system_info(&info);
+		jobs = info.cpu_count;
+	}
+
+	if (jobs > CountItems())
+		jobs = CountItems();
+
+	bigtime_t start = system_time();
+
+	WorkStealingPool pool(jobs);
+	pool.Run(CountItems(), _ConvertItem, this);
+
+	bigtime_t elapsed = system_time() - start;
+
+	int32 converted = 0;
+	int32 skipped = 0;
+	int32 failed = 0;
+	bigtime_t busy = 0;
+
+	for (size_t i = 0; i < fItems.size(); i++) {
+		if (fItems[i].status != B_OK)
+			failed++;
+		else if (fItems[i].skipped)
+			skipped++;
+		else
+			converted++;
+		busy += fItems[i].time;
+	}
+
+	printf("%" B_PRId32 " converted, %" B_PRId32 " up to date, %" B_PRId32 " failed"
+		" in %.1f ms (%.1f ms of work on %" B_PRId32 " threads, %" B_PRId32 " steals)\n",
+		converted, skipped, failed, elapsed / 1000.0, busy / 1000.0,
+		pool.ThreadCount(), pool.CountSteals());
+
+	return failed;
+}
+
+void
+BatchConverter::_ConvertItem(int32 index, void* cookie)
+{
+	BatchConverter* converter = static_cast<BatchConverter*>(cookie);
+	BatchItem& item = converter->fItems[index];
+
+	if (item.status == B_OK)
+		converter->_Convert(item);
+	converter->_Report(item);
+}
+
+void
+BatchConverter::_Convert(BatchItem& item)
+{
+	bigtime_t start = system_time();
+
+	if (!fOptions.force && _IsUpToDate(item)) {
+		item.skipped = true;
+		item.time = system_time() - start;
+		return;
+	}
+
+	BString source;
+	item.status = SVGExporter::ReadSource(item.input.String(), source);
+	if (item.status != B_OK) {
+		item.error = strerror(item.status);
+		item.time = system_time() - start;
+		return;
+	}
+
+	BReference<SVGDocument> document(new SVGDocument(source), true);
+	if (document->InitCheck() != B_OK) {
+		item.status = B_BAD_DATA;
+		item.error = "could not parse SVG";
+		item.time = system_time() - start;
+		return;
+	}
+
+	if (!fOptions.outputDirectory.IsEmpty()) {
+		BPath outputPath(item.outputBase.String());
+		BPath parent;
+		if (outputPath.GetParent(&parent) == B_OK)
+			create_directory(parent.Path(), 0755);
+	}
+
+	std::vector<uint8_t> hvifData;
+	if ((fOptions.formats & (BATCH_FORMAT_HVIF | BATCH_FORMAT_RDEF | BATCH_FORMAT_CPP)) != 0
+		&& !document->GetHVIFData(hvifData)) {
+		item.status = B_ERROR;
+		item.error = "HVIF conversion failed";
+		item.time = system_time() - start;
+		return;
+	}
+
+	for (int32 i = 0; i < kOutputExtensionCount && item.status == B_OK; i++) {
+		uint32 format = kOutputExtensions[i].format;
+		if ((fOptions.formats & format) == 0)
+			continue;
+
+		BString path = _OutputPath(item, format);
+		switch (format) {
+			case BATCH_FORMAT_HVIF:
+				item.status = SVGExporter::ExportHVIF(path.String(), hvifData.data(),
+					hvifData.size());
+				break;
+			case BATCH_FORMAT_RDEF:
+				item.status = SVGExporter::ExportRDef(path.String(), hvifData.data(),
+					hvifData.size());
+				break;
+			case BATCH_FORMAT_CPP:
+				item.status = SVGExporter::ExportCPP(path.String(), hvifData.data(),
+					hvifData.size());
+				break;
+			case BATCH_FORMAT_IOM:
+				item.status = SVGExporter::ExportIOM(path.String(), document.Get());
+				break;
+			case BATCH_FORMAT_PNG:
+				item.status = SVGExporter::ExportPNG(path.String(), document.Get(),
+					fOptions.pngSize);
+				break;
+		}
+
+		if (item.status != B_OK)
+			item.error.SetToFormat("writing %s: %s", path.String(), strerror(item.status));
+	}
+
+	item.time = system_time() - start;
+}
+
+void
+BatchConverter::_Report(const BatchItem& item)
+{
+	if (fOptions.quiet && item.status == B_OK)
+		return;
+
+	BAutolock lock(fOutputLock);
+
+	if (item.status != B_OK) {
+		fprintf(stderr, "%9.2f ms  %s: %s\n", item.time / 1000.0,
+			item.input.String(), item.error.String());
+	} else if (item.skipped)
+		printf("   up to date  %s\n", item.input.String());
+	else
+		printf("%9.2f ms  %s\n", item.time / 1000.0, item.input.String());
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef BATCH_CONVERTER_H
+#define BATCH_CONVERTER_H
+
+#include <Locker.h>
+#include <String.h>
+#include <SupportDefs.h>
+
+#include <map>
+#include <vector>
+
+enum batch_format {
+	BATCH_FORMAT_HVIF	= 1 << 0,
+	BATCH_FORMAT_RDEF	= 1 << 1,
+	BATCH_FORMAT_CPP	= 1 << 2,
+	BATCH_FORMAT_IOM	= 1 << 3,
+	BATCH_FORMAT_PNG	= 1 << 4
+};
+
+struct BatchOptions {
+	BatchOptions();
+
+	uint32		formats;
+	BString		outputDirectory;
+	int32		pngSize;
+	int32		jobs;
+	bool		recursive;
+	bool		force;
+	bool		quiet;
+};
+
+struct BatchItem {
+	BString		input;
+	BString		outputBase;
+	status_t	status;
+	bool		skipped;
+	bigtime_t	time;
+	BString		error;
+};
+
+class BatchConverter {
+public:
+	BatchConverter(const BatchOptions& options);
+
+	// Files found in a directory also get the path of their directory
+	// below it in subdirectories, if given; it is empty for the others.
+	static status_t CollectInputs(const char* pathOrPattern, bool recursive,
+						std::vector<BString>& files,
+						std::vector<BString>* subdirectories = NULL);
+
+	status_t AddInput(const char* pathOrPattern);
+	int32 CountItems() const { return fItems.size(); }
+
+	// Converts all inputs and returns the number of failed files.
+	int32 Run();
+
+private:
+	static void _CollectDirectory(const char* path, bool recursive,
+						std::vector<BString>& files,
+						std::vector<BString>* subdirectories,
+						const BString& subdirectory);
+	void _AddFile(const char* path, const BString& subdirectory);
+	BString _OutputPath(const BatchItem& item, uint32 format) const;
+	bool _IsUpToDate(const BatchItem& item) const;
+
+	static void _ConvertItem(int32 index, void* cookie);
+	void _Convert(BatchItem& item);
+	void _Report(const BatchItem& item);
+
+private:
+	BatchOptions			fOptions;
+	std::vector<BatchItem>	fItems;
+	// Input of each output base, to catch two inputs writing the same files
+	std::map<BString, BString> fOutputs;
+	BLocker					fOutputLock;
+};
+
+#endif
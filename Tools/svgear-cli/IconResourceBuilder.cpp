@@ -0,0 +1,442 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <File.h>
+#include <OS.h>
+#include <Path.h>
+#include <Referenceable.h>
+#include <StorageDefs.h>
+
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "BatchConverter.h"
+#include "IconResourceBuilder.h"
+#include "SVGCodeGenerator.h"
+#include "SVGConstants.h"
+#include "SVGConversionCache.h"
+#include "SVGDocument.h"
+#include "SVGExporter.h"
+#include "WorkStealingPool.h"
+
+static const char* kManifestHeader = "# svgear-cli icon manifest 1";
+
+BuildOptions::BuildOptions()
+	: firstID(1),
+	jobs(0),
+	recursive(false),
+	force(false),
+	quiet(false)
+{
+}
+
+IconResourceBuilder::IconResourceBuilder(const BuildOptions& options)
+	: fOptions(options),
+	fNextID(options.firstID),
+	fManifestLoaded(false)
+{
+	if (fOptions.cacheDirectory.IsEmpty())
+		fOptions.cacheDirectory.SetToFormat("%s.cache", fOptions.output.String());
+}
+
+void
+IconResourceBuilder::AddInput(const char* pathOrPattern)
+{
+	fPatterns.push_back(pathOrPattern);
+}
+
+BString
+IconResourceBuilder::_ManifestPath() const
+{
+	BString path = fOptions.output;
+	path << ".manifest";
+	return path;
+}
+
+BString
+IconResourceBuilder::_CachePath(const Icon& icon, const char* extension) const
+{
+	BString path = fOptions.cacheDirectory;
+	path << "/" << icon.name << extension;
+	return path;
+}
+
+BString
+IconResourceBuilder::_UniqueName(const char* path)
+{
+	BString leaf = BPath(path).Leaf();
+	if (leaf.EndsWith(".svg") || leaf.EndsWith(".SVG"))
+		leaf.Truncate(leaf.Length() - 4);
+
+	BString base;
+	for (int32 i = 0; i < leaf.Length(); i++) {
+		char c = leaf[i];
+		base << (char)(isalnum((unsigned char)c) ? c : '_');
+	}
+
+	if (base.IsEmpty() || isdigit((unsigned char)base[0]))
+		base.Prepend("icon_");
+
+	BString name = base;
+	for (int32 suffix = 2; fNames.find(name) != fNames.end(); suffix++)
+		name.SetToFormat("%s_%" B_PRId32, base.String(), suffix);
+
+	fNames.insert(name);
+	return name;
+}
+
+status_t
+IconResourceBuilder::_LoadManifest()
+{
+	fManifestLoaded = true;
+
+	FILE* file = fopen(_ManifestPath().String(), "r");
+	if (file == NULL)
+		return B_ENTRY_NOT_FOUND;
+
+	char line[B_PATH_NAME_LENGTH + 256];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		if (line[0] == '#' || line[0] == '\n')
+			continue;
+
+		line[strcspn(line, "\n")] = '\0';
+
+		Icon icon;
+		char name[B_FILE_NAME_LENGTH];
+		int id;
+		long long modified, size;
+		int inputOffset = 0;
+
+		if (sscanf(line, "%d\t%255[^\t]\t%" SCNx64 "\t%lld\t%lld\t%n",
+				&id, name, &icon.hash, &modified, &size, &inputOffset) < 5
+			|| inputOffset == 0) {
+			continue;
+		}
+
+		icon.input = line + inputOffset;
+		icon.id = id;
+		icon.name = name;
+		icon.modified = (time_t)modified;
+		icon.size = (off_t)size;
+		icon.rebuild = false;
+		icon.converted = false;
+		icon.status = B_OK;
+		icon.time = 0;
+
+		if (fNames.find(icon.name) != fNames.end())
+			continue;
+
+		fNames.insert(icon.name);
+		fIcons[icon.input] = icon;
+
+		if (icon.id >= fNextID)
+			fNextID = icon.id + 1;
+	}
+
+	fclose(file);
+	return B_OK;
+}
+
+status_t
+IconResourceBuilder::_SaveManifest()
+{
+	BString content(kManifestHeader);
+	content << "\n";
+
+	for (std::map<BString, Icon>::const_iterator it = fIcons.begin();
+			it != fIcons.end(); ++it) {
+		const Icon& icon = it->second;
+		BString line;
+		line.SetToFormat("%" B_PRId32 "\t%s\t%016" PRIx64 "\t%lld\t%lld\t%s\n",
+			icon.id, icon.name.String(), icon.hash, (long long)icon.modified,
+			(long long)icon.size, icon.input.String());
+		content << line;
+	}
+
+	return SVGExporter::SaveData(_ManifestPath().String(), content.String(),
+		content.Length(), MIME_TXT_SIGNATURE);
+}
+
+bool
+IconResourceBuilder::_HasOutputs(const Icon& icon) const
+{
+	static const char* kExtensions[] = { ".hvif", ".rdef", ".h" };
+
+	for (size_t i = 0; i < sizeof(kExtensions) / sizeof(kExtensions[0]); i++) {
+		struct stat st;
+		if (stat(_CachePath(icon, kExtensions[i]).String(), &st) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+void
+IconResourceBuilder::_RemoveOutputs(const Icon& icon)
+{
+	unlink(_CachePath(icon, ".hvif").String());
+	unlink(_CachePath(icon, ".rdef").String());
+	unlink(_CachePath(icon, ".h").String());
+}
+
+int32
+IconResourceBuilder::Build(bool& changed)
+{
+	changed = false;
+	bigtime_t start = system_time();
+
+	if (!fManifestLoaded)
+		_LoadManifest();
+
+	mkdir(fOptions.cacheDirectory.String(), 0755);
+
+	std::vector<BString> files;
+	for (size_t i = 0; i < fPatterns.size(); i++)
+		BatchConverter::CollectInputs(fPatterns[i].String(), fOptions.recursive, files);
+
+	std::set<BString> present;
+	fQueue.clear();
+
+	for (size_t i = 0; i < files.size(); i++) {
+		const BString& path = files[i];
+		if (!present.insert(path).second)
+			continue;
+
+		struct stat st;
+		if (stat(path.String(), &st) != 0)
+			continue;
+
+		std::map<BString, Icon>::iterator it = fIcons.find(path);
+		if (it == fIcons.end()) {
+			Icon icon;
+			icon.input = path;
+			icon.name = _UniqueName(path.String());
+			icon.id = fNextID++;
+			icon.hash = 0;
+			icon.modified = 0;
+			icon.size = -1;
+			it = fIcons.insert(std::make_pair(path, icon)).first;
+		}
+
+		Icon& icon = it->second;
+		icon.converted = false;
+		icon.status = B_OK;
+		icon.time = 0;
+		icon.error.Truncate(0);
+		icon.rebuild = fOptions.force || !_HasOutputs(icon);
+
+		// Same size and modification time as last time: trust the manifest
+		// without even reading the file.
+		if (!icon.rebuild && icon.modified == st.st_mtime && icon.size == st.st_size)
+			continue;
+
+		icon.modified = st.st_mtime;
+		icon.size = st.st_size;
+		fQueue.push_back(&icon);
+	}
+
+	int32 removed = 0;
+	for (std::map<BString, Icon>::iterator it = fIcons.begin(); it != fIcons.end();) {
+		if (present.find(it->first) != present.end()) {
+			++it;
+			continue;
+		}
+
+		_RemoveOutputs(it->second);
+		fNames.erase(it->second.name);
+		fIcons.erase(it++);
+		removed++;
+	}
+
+	if (!fQueue.empty()) {
+		int32 jobs = fOptions.jobs;
+		if (jobs <= 0) {
+			system_info info;
+			get_system_info(&info);
+			jobs = info.cpu_count;
+		}
+		if (jobs > (int32)fQueue.size())
+			jobs = fQueue.size();
+
+		WorkStealingPool pool(jobs);
+		pool.Run(fQueue.size(), _BuildItem, this);
+	}
+
+	int32 converted = 0;
+	int32 failed = 0;
+	for (size_t i = 0; i < fQueue.size(); i++) {
+		Icon* icon = fQueue[i];
+		if (icon->status != B_OK) {
+			failed++;
+			fprintf(stderr, "%9.2f ms  %s: %s\n", icon->time / 1000.0,
+				icon->input.String(), icon->error.String());
+		} else if (icon->converted) {
+			converted++;
+			if (!fOptions.quiet) {
+				printf("%9.2f ms  %s -> %" B_PRId32 " \"%s\"\n", icon->time / 1000.0,
+					icon->input.String(), icon->id, icon->name.String());
+			}
+		}
+	}
+
+	struct stat st;
+	bool outputMissing = stat(fOptions.output.String(), &st) != 0;
+
+	changed = converted > 0 || removed > 0 || outputMissing;
+	if (changed) {
+		status_t status = _WriteCombined();
+		if (status != B_OK) {
+			fprintf(stderr, "svgear-cli: could not write %s: %s\n",
+				fOptions.output.String(), strerror(status));
+			failed++;
+		}
+	}
+
+	if (changed || !fQueue.empty())
+		_SaveManifest();
+
+	if (changed || failed > 0 || !fOptions.quiet) {
+		printf("%" B_PRId32 " rebuilt, %" B_PRId32 " unchanged, %" B_PRId32 " removed,"
+			" %" B_PRId32 " failed in %.1f ms\n", converted,
+			(int32)fIcons.size() - converted - failed, removed, failed,
+			(system_time() - start) / 1000.0);
+	}
+
+	return failed;
+}
+
+int32
+IconResourceBuilder::Watch(bigtime_t interval)
+{
+	bool changed;
+	int32 failed = Build(changed);
+
+	// --force only applies to the first build; after that, changes are
+	// found by timestamp and content hash again.
+	fOptions.force = false;
+	fOptions.quiet = true;
+	printf("Watching for changes, press Ctrl-C to stop.\n");
+
+	while (true) {
+		snooze(interval);
+		failed = Build(changed);
+		fflush(stdout);
+	}
+
+	return failed;
+}
+
+void
+IconResourceBuilder::_BuildItem(int32 index, void* cookie)
+{
+	IconResourceBuilder* builder = static_cast<IconResourceBuilder*>(cookie);
+	builder->_BuildIcon(*builder->fQueue[index]);
+}
+
+void
+IconResourceBuilder::_BuildIcon(Icon& icon)
+{
+	bigtime_t start = system_time();
+
+	BString source;
+	icon.status = SVGExporter::ReadSource(icon.input.String(), source);
+	if (icon.status != B_OK) {
+		icon.error = strerror(icon.status);
+		icon.modified = 0;
+		icon.time = system_time() - start;
+		return;
+	}
+
+	uint64 hash = SVGConversionCache::HashSource(source.String(), source.Length());
+	if (!icon.rebuild && hash == icon.hash) {
+		icon.time = system_time() - start;
+		return;
+	}
+
+	BReference<SVGDocument> document(new SVGDocument(source), true);
+	std::vector<uint8_t> hvifData;
+	if (!document->GetHVIFData(hvifData)) {
+		icon.status = B_ERROR;
+		icon.error = "HVIF conversion failed";
+		icon.hash = 0;
+		icon.modified = 0;
+		icon.time = system_time() - start;
+		return;
+	}
+
+	BString symbol("k");
+	bool upper = true;
+	for (int32 i = 0; i < icon.name.Length(); i++) {
+		char c = icon.name[i];
+		if (c == '_') {
+			upper = true;
+			continue;
+		}
+		symbol << (char)(upper ? toupper((unsigned char)c) : c);
+		upper = false;
+	}
+	symbol << "Icon";
+
+	BString rdef = SVGCodeGenerator::GenerateRDef(hvifData.data(), hvifData.size(),
+		icon.id, icon.name.String());
+	BString cpp = SVGCodeGenerator::GenerateCPP(hvifData.data(), hvifData.size(),
+		symbol.String());
+
+	icon.status = SVGExporter::SaveData(_CachePath(icon, ".hvif").String(),
+		hvifData.data(), hvifData.size(), MIME_HVIF_SIGNATURE);
+	if (icon.status == B_OK) {
+		icon.status = SVGExporter::SaveData(_CachePath(icon, ".rdef").String(),
+			rdef.String(), rdef.Length(), MIME_TXT_SIGNATURE);
+	}
+	if (icon.status == B_OK) {
+		icon.status = SVGExporter::SaveData(_CachePath(icon, ".h").String(),
+			cpp.String(), cpp.Length(), MIME_CPP_SIGNATURE);
+	}
+
+	if (icon.status != B_OK) {
+		icon.error = strerror(icon.status);
+		// Forget the hash so the next build tries again.
+		icon.hash = 0;
+		icon.modified = 0;
+	} else {
+		icon.hash = hash;
+		icon.converted = true;
+	}
+
+	icon.time = system_time() - start;
+}
+
+status_t
+IconResourceBuilder::_WriteCombined()
+{
+	std::map<int32, const Icon*> byID;
+	for (std::map<BString, Icon>::const_iterator it = fIcons.begin();
+			it != fIcons.end(); ++it) {
+		byID[it->second.id] = &it->second;
+	}
+
+	BString content;
+	for (std::map<int32, const Icon*>::const_iterator it = byID.begin();
+			it != byID.end(); ++it) {
+		BString fragment;
+		if (SVGExporter::ReadSource(_CachePath(*it->second, ".rdef").String(),
+				fragment) != B_OK) {
+			continue;
+		}
+
+		if (!content.IsEmpty())
+			content << "\n\n";
+		content << fragment;
+	}
+	content << "\n";
+
+	return SVGExporter::SaveData(fOptions.output.String(), content.String(),
+		content.Length(), MIME_TXT_SIGNATURE);
+}
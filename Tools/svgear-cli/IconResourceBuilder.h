@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef ICON_RESOURCE_BUILDER_H
+#define ICON_RESOURCE_BUILDER_H
+
+#include <String.h>
+#include <SupportDefs.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+struct BuildOptions {
+	BuildOptions();
+
+	BString		output;
+	BString		cacheDirectory;
+	int32		firstID;
+	int32		jobs;
+	bool		recursive;
+	bool		force;
+	bool		quiet;
+};
+
+// Builds one combined .rdef with a VICN resource per SVG file. A manifest
+// next to the output remembers the content hash, resource ID and name of
+// every icon, so a rebuild only converts the files that actually changed.
+// Per-icon HVIF, RDef and C++ outputs are kept in the cache directory.
+class IconResourceBuilder {
+public:
+	IconResourceBuilder(const BuildOptions& options);
+
+	void AddInput(const char* pathOrPattern);
+
+	// Runs one incremental build and returns the number of failed icons.
+	int32 Build(bool& changed);
+	// Rebuilds whenever an input changes; does not return on success. A
+	// forced build is only done once, at the start.
+	int32 Watch(bigtime_t interval = 500000);
+
+private:
+	struct Icon {
+		BString		input;
+		BString		name;
+		int32		id;
+		uint64		hash;
+		time_t		modified;
+		off_t		size;
+
+		bool		rebuild;
+		bool		converted;
+		status_t	status;
+		bigtime_t	time;
+		BString		error;
+	};
+
+	status_t _LoadManifest();
+	status_t _SaveManifest();
+	BString _ManifestPath() const;
+	BString _CachePath(const Icon& icon, const char* extension) const;
+	BString _UniqueName(const char* path);
+	bool _HasOutputs(const Icon& icon) const;
+	void _RemoveOutputs(const Icon& icon);
+	status_t _WriteCombined();
+
+	static void _BuildItem(int32 index, void* cookie);
+	void _BuildIcon(Icon& icon);
+
+private:
+	BuildOptions			fOptions;
+	std::vector<BString>	fPatterns;
+	std::map<BString, Icon>	fIcons;
+	std::set<BString>		fNames;
+	std::vector<Icon*>		fQueue;
+	int32					fNextID;
+	bool					fManifestLoaded;
+};
+
+#endif
@@ -0,0 +1,13 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+// The application gets the nanosvg implementation from BSVGView, the command
+// line tool does not link the view and builds it here.
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define NANOSVG_IMPLEMENTATION
+#include "nanosvg.h"
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <Autolock.h>
+
+#include "WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool(int32 threadCount)
+	: fThreadCount(threadCount > 0 ? threadCount : 1),
+	fFunction(NULL),
+	fCookie(NULL),
+	fSteals(0)
+{
+	for (int32 i = 0; i < fThreadCount; i++) {
+		Worker* worker = new Worker;
+		worker->pool = this;
+		worker->index = i;
+		worker->thread = -1;
+		fWorkers.push_back(worker);
+	}
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	for (size_t i = 0; i < fWorkers.size(); i++)
+		delete fWorkers[i];
+}
+
+void
+WorkStealingPool::Run(int32 taskCount, task_function function, void* cookie)
+{
+	if (taskCount <= 0 || function == NULL)
+		return;
+
+	fFunction = function;
+	fCookie = cookie;
+
+	int32 perWorker = taskCount / fThreadCount;
+	int32 remainder = taskCount % fThreadCount;
+	int32 next = 0;
+
+	for (int32 i = 0; i < fThreadCount; i++) {
+		int32 count = perWorker + (i < remainder ? 1 : 0);
+		for (int32 j = 0; j < count; j++)
+			fWorkers[i]->tasks.push_back(next++);
+	}
+
+	for (int32 i = 0; i < fThreadCount; i++) {
+		fWorkers[i]->thread = spawn_thread(_WorkerThread, "batch_worker",
+			B_NORMAL_PRIORITY, fWorkers[i]);
+		if (fWorkers[i]->thread >= 0)
+			resume_thread(fWorkers[i]->thread);
+	}
+
+	bool anyStarted = false;
+	for (int32 i = 0; i < fThreadCount; i++) {
+		if (fWorkers[i]->thread < 0)
+			continue;
+
+		status_t exitValue;
+		wait_for_thread(fWorkers[i]->thread, &exitValue);
+		fWorkers[i]->thread = -1;
+		anyStarted = true;
+	}
+
+	// Without any thread (out of resources) run everything right here.
+	if (!anyStarted)
+		_Work(fWorkers[0]);
+}
+
+int32
+WorkStealingPool::_WorkerThread(void* data)
+{
+	Worker* worker = static_cast<Worker*>(data);
+	worker->pool->_Work(worker);
+	return B_OK;
+}
+
+void
+WorkStealingPool::_Work(Worker* worker)
+{
+	int32 task;
+	while (_Pop(worker, task) || _Steal(worker, task))
+		fFunction(task, fCookie);
+}
+
+bool
+WorkStealingPool::_Pop(Worker* worker, int32& task)
+{
+	BAutolock lock(worker->lock);
+
+	if (worker->tasks.empty())
+		return false;
+
+	task = worker->tasks.front();
+	worker->tasks.pop_front();
+	return true;
+}
+
+bool
+WorkStealingPool::_Steal(Worker* thief, int32& task)
+{
+	for (int32 i = 1; i < fThreadCount; i++) {
+		Worker* victim = fWorkers[(thief->index + i) % fThreadCount];
+
+		BAutolock lock(victim->lock);
+		if (victim->tasks.empty())
+			continue;
+
+		task = victim->tasks.back();
+		victim->tasks.pop_back();
+		atomic_add(&fSteals, 1);
+		return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <Locker.h>
+#include <OS.h>
+#include <SupportDefs.h>
+
+#include <deque>
+#include <vector>
+
+// Runs a fixed set of indexed tasks on a number of threads. Every thread
+// starts with its own contiguous block of tasks and, once that runs dry,
+// steals single tasks from the far end of the other threads' blocks.
+class WorkStealingPool {
+public:
+	typedef void (*task_function)(int32 index, void* cookie);
+
+	WorkStealingPool(int32 threadCount);
+	~WorkStealingPool();
+
+	void Run(int32 taskCount, task_function function, void* cookie);
+
+	int32 ThreadCount() const { return fThreadCount; }
+	int32 CountSteals() const { return fSteals; }
+
+private:
+	struct Worker {
+		WorkStealingPool*	pool;
+		int32				index;
+		thread_id			thread;
+		BLocker				lock;
+		std::deque<int32>	tasks;
+	};
+
+	static int32 _WorkerThread(void* data);
+	void _Work(Worker* worker);
+	bool _Pop(Worker* worker, int32& task);
+	bool _Steal(Worker* thief, int32& task);
+
+private:
+	int32					fThreadCount;
+	std::vector<Worker*>	fWorkers;
+	task_function			fFunction;
+	void*					fCookie;
+	vint32					fSteals;
+};
+
+#endif
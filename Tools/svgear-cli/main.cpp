@@ -0,0 +1,200 @@
+/*
+ * Copyright 2026, Gerasim Troeglazov, 3dEyes@gmail.com. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include <String.h>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "BatchConverter.h"
+#include "IconResourceBuilder.h"
+#include "SVGConversionCache.h"
+
+static const char* kUsage =
+	"Usage: svgear-cli [options] <file|directory|pattern>...\n"
+	"Converts SVG files to Haiku vector icons and related formats.\n"
+	"\n"
+	"Options:\n"
+	"  -f, --format <list>   Comma separated output formats:\n"
+	"                        hvif, rdef, cpp, iom, png (default: hvif)\n"
+	"  -o, --output <dir>    Write outputs to <dir> instead of next to the input\n"
+	"  -s, --size <pixels>   PNG size, -1 for the original size (default: 64)\n"
+	"  -j, --jobs <count>    Number of worker threads (default: CPU count)\n"
+	"  -r, --recursive       Descend into subdirectories\n"
+	"      --force           Convert even if the outputs are up to date\n"
+	"  -q, --quiet           Only report failures and the summary\n"
+	"  -h, --help            Show this help\n"
+	"\n"
+	"Resource build mode:\n"
+	"  -b, --build <file>    Build one .rdef with a VICN resource per icon, only\n"
+	"                        converting icons that changed since the last build\n"
+	"  -w, --watch           Keep running and rebuild when inputs change\n"
+	"      --first-id <id>   Resource ID of the first new icon (default: 1)\n"
+	"      --cache <dir>     Per-icon outputs (default: <file>.cache)\n";
+
+static bool
+_ParseFormats(const char* list, uint32& formats)
+{
+	formats = 0;
+
+	BString value(list);
+	value.ToLower();
+
+	int32 start = 0;
+	while (start <= value.Length()) {
+		int32 end = value.FindFirst(',', start);
+		if (end < 0)
+			end = value.Length();
+
+		BString name;
+		value.CopyInto(name, start, end - start);
+		name.Trim();
+
+		if (name == "hvif")
+			formats |= BATCH_FORMAT_HVIF;
+		else if (name == "rdef")
+			formats |= BATCH_FORMAT_RDEF;
+		else if (name == "cpp" || name == "h")
+			formats |= BATCH_FORMAT_CPP;
+		else if (name == "iom")
+			formats |= BATCH_FORMAT_IOM;
+		else if (name == "png")
+			formats |= BATCH_FORMAT_PNG;
+		else if (!name.IsEmpty()) {
+			fprintf(stderr, "svgear-cli: unknown format '%s'\n", name.String());
+			return false;
+		}
+
+		start = end + 1;
+	}
+
+	return formats != 0;
+}
+
+int
+main(int argc, char** argv)
+{
+	enum {
+		OPTION_FORCE = 256,
+		OPTION_FIRST_ID,
+		OPTION_CACHE
+	};
+
+	static const struct option kLongOptions[] = {
+		{ "format", required_argument, NULL, 'f' },
+		{ "output", required_argument, NULL, 'o' },
+		{ "size", required_argument, NULL, 's' },
+		{ "jobs", required_argument, NULL, 'j' },
+		{ "recursive", no_argument, NULL, 'r' },
+		{ "force", no_argument, NULL, OPTION_FORCE },
+		{ "quiet", no_argument, NULL, 'q' },
+		{ "help", no_argument, NULL, 'h' },
+		{ "build", required_argument, NULL, 'b' },
+		{ "watch", no_argument, NULL, 'w' },
+		{ "first-id", required_argument, NULL, OPTION_FIRST_ID },
+		{ "cache", required_argument, NULL, OPTION_CACHE },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	BatchOptions options;
+	BuildOptions buildOptions;
+	bool watch = false;
+
+	int option;
+	while ((option = getopt_long(argc, argv, "f:o:s:j:rqhb:w", kLongOptions, NULL)) != -1) {
+		switch (option) {
+			case 'f':
+				if (!_ParseFormats(optarg, options.formats))
+					return EXIT_FAILURE;
+				break;
+			case 'o':
+				options.outputDirectory = optarg;
+				break;
+			case 's':
+				options.pngSize = atoi(optarg);
+				if (options.pngSize == 0 || options.pngSize < -1) {
+					fprintf(stderr, "svgear-cli: invalid PNG size '%s'\n", optarg);
+					return EXIT_FAILURE;
+				}
+				break;
+			case 'j':
+				options.jobs = atoi(optarg);
+				break;
+			case 'r':
+				options.recursive = true;
+				break;
+			case OPTION_FORCE:
+				options.force = true;
+				break;
+			case 'q':
+				options.quiet = true;
+				break;
+			case 'h':
+				printf("%s", kUsage);
+				return EXIT_SUCCESS;
+			case 'b':
+				buildOptions.output = optarg;
+				break;
+			case 'w':
+				watch = true;
+				break;
+			case OPTION_FIRST_ID:
+				buildOptions.firstID = atoi(optarg);
+				break;
+			case OPTION_CACHE:
+				buildOptions.cacheDirectory = optarg;
+				break;
+			default:
+				fprintf(stderr, "%s", kUsage);
+				return EXIT_FAILURE;
+		}
+	}
+
+	if (optind >= argc) {
+		fprintf(stderr, "%s", kUsage);
+		return EXIT_FAILURE;
+	}
+
+	// Every file is converted exactly once, caching results would only cost
+	// memory and copies.
+	SVGConversionCache::Default()->SetBudget(0);
+
+	if (!buildOptions.output.IsEmpty()) {
+		buildOptions.jobs = options.jobs;
+		buildOptions.recursive = options.recursive;
+		buildOptions.force = options.force;
+		buildOptions.quiet = options.quiet;
+
+		IconResourceBuilder builder(buildOptions);
+		for (int i = optind; i < argc; i++)
+			builder.AddInput(argv[i]);
+
+		if (watch)
+			return builder.Watch() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+		bool changed;
+		return builder.Build(changed) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (watch) {
+		fprintf(stderr, "svgear-cli: --watch needs --build\n");
+		return EXIT_FAILURE;
+	}
+
+	BatchConverter converter(options);
+	for (int i = optind; i < argc; i++) {
+		if (converter.AddInput(argv[i]) != B_OK)
+			fprintf(stderr, "svgear-cli: no match for '%s'\n", argv[i]);
+	}
+
+	if (converter.CountItems() == 0) {
+		fprintf(stderr, "svgear-cli: no SVG files to convert\n");
+		return EXIT_FAILURE;
+	}
+
+	return converter.Run() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}